@@ -0,0 +1,113 @@
+#!/bin/sh
+# Times loading and saving a large generated task list with the app's
+# --benchmark mode: the load speedup per parser thread, the file and
+# SQLite backends side by side, and the cost of encryption.
+#
+# Usage: ./benchmark.sh [BINARY] [TASKS] [RUNS]
+#
+# BINARY defaults to ./project_tracker, TASKS to 1000000 and RUNS to 5.
+# Each figure is the median of RUNS runs, in milliseconds. The SQLite and
+# encryption rows are skipped when the binary was built without them.
+
+set -eu
+
+binary=$(realpath "${1:-./project_tracker}")
+n_tasks=${2:-1000000}
+runs=${3:-5}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# Tasks like the ones people write: tags, projects, due dates, priorities,
+# a few long ones, and about a third of them done.
+awk -v n="$n_tasks" 'BEGIN {
+    srand(1);
+    for (i = 1; i <= n; i++) {
+        text = sprintf("Task %d +project%d #tag%d due:2026-%02d-%02d prio:%d", i, i % 50, i % 200,
+                       1 + i % 12, 1 + i % 28, i % 4);
+        if (i % 97 == 0) {
+            for (j = 0; j < 20; j++) {
+                text = text " with a longer description that wraps";
+            }
+        }
+        printf "%d;%s\n", rand() < 0.3, text;
+    }
+}' > "$work/tasks.txt"
+printf 'Generated %s tasks (%s bytes).\n\n' "$n_tasks" "$(wc -c < "$work/tasks.txt")"
+
+head -c 32 /dev/urandom > "$work/key"
+
+# Prints the median of the numbers on stdin.
+median() {
+    sort -n | awk '{ v[NR] = $1 } END { print v[int((NR + 1) / 2)] }'
+}
+
+# Runs one configuration RUNS times in its own store. Extra arguments are
+# environment assignments. The first run is not counted: it fills the
+# page cache, and imports or encrypts the list where the store needs it.
+measure() {
+    label=$1
+    keep_image=$2
+    shift 2
+    dir="$work/$label"
+    rm -rf "$dir"
+    mkdir "$dir"
+    cp "$work/tasks.txt" "$dir/"
+    if ! env PROJECT_TRACKER_DATA_DIR="$dir" "$@" "$binary" --benchmark > "$dir/warmup" 2>&1; then
+        printf '%-24s skipped: %s\n' "$label" "$(tail -n 1 "$dir/warmup")"
+        return
+    fi
+    if grep -q 'Unknown or unavailable' "$dir/warmup"; then
+        printf '%-24s skipped: backend not built in\n' "$label"
+        return
+    fi
+    : > "$dir/results"
+    i=0
+    while [ "$i" -lt "$runs" ]; do
+        if [ "$keep_image" = no ]; then
+            rm -f "$dir/tasks.image"
+        fi
+        env PROJECT_TRACKER_DATA_DIR="$dir" "$@" "$binary" --benchmark | grep '^backend=' >> "$dir/results"
+        i=$((i + 1))
+    done
+    load=$(sed 's/.*load_us=\([0-9]*\).*/\1/' "$dir/results" | median)
+    save=$(sed 's/.*save_us=\([0-9]*\).*/\1/' "$dir/results" | median)
+    awk -v label="$label" -v load="$load" -v save="$save" \
+        'BEGIN { printf "%-24s load %8.1f ms   save %8.1f ms\n", label, load / 1000, save / 1000 }'
+    echo "$load $save" > "$dir/median"
+}
+
+# Prints how much slower configuration $2 is than $1, in percent.
+overhead() {
+    if [ -f "$work/$1/median" ] && [ -f "$work/$2/median" ]; then
+        read -r base_load base_save < "$work/$1/median"
+        read -r load save < "$work/$2/median"
+        awk -v label="$2 vs $1" -v base_load="$base_load" -v base_save="$base_save" -v load="$load" \
+            -v save="$save" 'BEGIN {
+                printf "%-24s load %+7.1f %%      save %+7.1f %%\n", label,
+                       100 * (load - base_load) / base_load, 100 * (save - base_save) / base_save
+            }'
+    fi
+}
+
+echo "Load speedup by parser threads:"
+# Powers of two, and then every processor.
+for threads in $(awk -v max="$(nproc)" 'BEGIN { for (t = 1; t < max; t *= 2) print t; print max }'); do
+    measure "file-threads-$threads" no PROJECT_TRACKER_LOAD_THREADS="$threads"
+    if [ "$threads" -gt 1 ] && [ -f "$work/file-threads-1/median" ]; then
+        read -r base _ < "$work/file-threads-1/median"
+        read -r load _ < "$work/file-threads-$threads/median"
+        awk -v base="$base" -v load="$load" 'BEGIN { printf "%-24s speedup %.2fx\n", "", base / load }'
+    fi
+done
+
+echo
+echo "Backends:"
+measure file no
+measure file-warm-image yes
+measure sqlite no PROJECT_TRACKER_BACKEND=sqlite
+overhead file sqlite
+
+echo
+echo "Encryption (a plain list's save also writes tasks.image; an encrypted one does not):"
+measure file-encrypted no PROJECT_TRACKER_KEY_FILE="$work/key"
+overhead file file-encrypted
@@ -5,153 +5,11748 @@
  *
  * 1. Data Persistence: The application saves and loads task data (including
  * completion status) from a file, demonstrating competence in file I/O.
- 
+ * The files live in a directory per workspace under XDG_DATA_HOME.
+
  * 2. Custom Styling: A custom CSS stylesheet is applied to the UI, highlighting
  * an understanding of modern, professional user interface design.
- 
+
  * 3. Event-Driven Programming: The application uses signals and callbacks to
  * respond to user interactions, which is a fundamental concept in desktop
  * application development.
  *
+ * 4. Model/View Separation: Tasks live in a TaskStore. Every change is applied
+ * as a transaction that notifies the views once and appends one record to a
+ * journal, which is periodically compacted back into the task file. The
+ * store can be kept in an SQLite database instead; see TaskBackend.
+ *
  * To compile this code, you need to have the GTK development libraries installed.
  * On a Debian/Ubuntu-based system, you can install them with:
  * sudo apt-get install libgtk-3-dev
  *
  * To compile the program, use a command similar to this:
- * gcc -Wall -o project_tracker project_tracker.c `pkg-config --cflags --libs gtk+-3.0`
+ * gcc -Wall -o project_tracker project_tracker.c `pkg-config --cflags --libs gtk+-3.0` -lm
+ *
+ * To build in the SQLite backend as well, add:
+ * -DPROJECT_TRACKER_WITH_SQLITE `pkg-config --cflags --libs sqlite3`
+ *
+ * To be able to encrypt the task file, add:
+ * -DPROJECT_TRACKER_WITH_CRYPTO `pkg-config --cflags --libs libcrypto`
+ *
+ * To write the journal and snapshots through io_uring, add:
+ * -DPROJECT_TRACKER_WITH_URING `pkg-config --cflags --libs liburing`
+ *
+ * To validate non-ASCII text in the task file 16 bytes at a time, add
+ * -mssse3, or -march=native.
+ *
+ * After compiling, you can run the program with:
+ * ./project_tracker
+ */
+
+#include <gtk/gtk.h>
+#include <gtk/gtk-a11y.h>
+#include <cairo-pdf.h>
+#include <glib-unix.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#ifdef PROJECT_TRACKER_WITH_SQLITE
+#include <sqlite3.h>
+#endif
+#ifdef PROJECT_TRACKER_WITH_URING
+#include <liburing.h>
+#endif
+#ifdef PROJECT_TRACKER_WITH_CRYPTO
+#include <openssl/crypto.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#endif
+
+#define TASKS_FILE "tasks.txt"
+#define JOURNAL_FILE "tasks.journal"
+#define VIEWS_FILE "views.txt"
+#define STATUSES_FILE "statuses.txt"
+#define SQLITE_FILE "tasks.db"
+#define IMAGE_FILE "tasks.image"
+
+// Number of journal records after which the journal is folded into TASKS_FILE.
+#define JOURNAL_COMPACT_THRESHOLD 1000
+
+// --- Task Model ---
+
+/**
+ * @brief The statuses every store has. Custom statuses from STATUSES_FILE
+ * follow them; "Done" is always the last column of the board.
+ */
+typedef enum {
+    TASK_STATUS_TODO,
+    TASK_STATUS_IN_PROGRESS,
+    TASK_STATUS_DONE,
+    TASK_STATUS_N_BUILTIN,
+} TaskStatus;
+
+// A status index must fit in Task::status.
+#define TASK_STATUS_MAX (G_MAXUINT8 + 1)
+
+/**
+ * @brief A single task as held by the TaskStore.
+ */
+typedef struct {
+    guint id;                // Unique for the lifetime of the process; never reused.
+    gchar *text;
+    gboolean is_completed;   // Always the same as status == TASK_STATUS_DONE.
+    guint8 status;           // Index into the store's statuses.
+    guint8 reopen_status;    // Status a completed task goes back to when reopened.
+    guint32 due;             // Julian day of the text's "due:YYYY-MM-DD" token, 0 if none.
+    guint32 start;           // Julian day of the text's "start:YYYY-MM-DD" token, 0 if none.
+    guint8 priority;         // Value of the text's "prio:N" token, 0 if none.
+    guint32 revision;        // Bumped whenever the text changes.
+} Task;
+
+typedef struct _TaskStore TaskStore;
+typedef struct _TaskWriter TaskWriter;
+typedef struct _FileCipher FileCipher;
+
+/**
+ * @brief Where a store is kept on disk, chosen by PROJECT_TRACKER_BACKEND.
+ */
+typedef struct {
+    const gchar *name;
+    // Fills the empty store and starts persisting it.
+    void (*load)(TaskStore *store);
+    // Persists a committed transaction, given its range and the journal
+    // records in the store's txn_records.
+    void (*commit)(TaskStore *store, guint position, guint removed, guint added);
+    // Writes out the whole store, if the backend needs that; may be NULL.
+    void (*save)(TaskStore *store);
+    // Flushes everything still queued and stops persisting.
+    void (*close)(TaskStore *store);
+} TaskBackend;
+
+/**
+ * @brief Called once per committed transaction with the range that changed.
+ *
+ * The semantics match GListModel::items-changed: starting at @position,
+ * @removed old tasks were replaced by @added new ones.
+ */
+typedef void (*TaskStoreChangedFunc)(TaskStore *store, guint position, guint removed,
+                                     guint added, gpointer user_data);
+
+typedef struct {
+    TaskStoreChangedFunc func;
+    gpointer user_data;
+} TaskStoreListener;
+
+/**
+ * @brief The fields that counts and numeric filters read, copied out of the
+ * tasks into parallel arrays in store order, so a scan touches a few bytes
+ * per task instead of chasing every Task pointer.
+ */
+typedef struct {
+    guint length;            // Tasks covered; the store's length after every commit.
+    guint capacity;
+    guint64 *done;           // One bit per task, set if it is completed.
+    guint32 *due;            // Task::due.
+    guint8 *priority;        // Task::priority.
+    guint8 *status;          // Task::status.
+    guint n_done;            // Set bits in done.
+} TaskColumns;
+
+struct _TaskStore {
+    GPtrArray *tasks;        // The backing array of Task pointers, in display order.
+    GArray *listeners;       // TaskStoreListener entries, one per open view.
+    const TaskBackend *backend;
+    gpointer backend_data;   // State of backends other than the task file.
+    TaskWriter *writer;      // Background writer for the journal and snapshots.
+    gboolean read_only;      // Another process writes the store; nothing is saved.
+    int lock_fd;             // Holds LOCK_FILE's lock while this process writes.
+    FileCipher *cipher;      // Seals the task file and journal, or NULL to keep them plain.
+    guint journal_records;   // Records written since the last compaction.
+    guint next_id;           // Id given to the next task added to the store.
+    gboolean replaying;      // TRUE while the journal is being replayed on load.
+    GHashTable *tag_index;   // Lower-cased tag -> set of Task pointers carrying it.
+    GPtrArray *statuses;     // Status names, indexed by Task::status.
+    TaskColumns columns;     // Updated at every commit, ahead of the listeners.
+
+    // State of the currently open transaction.
+    guint txn_depth;
+    gboolean txn_changed;
+    guint txn_old_length;
+    guint txn_prefix;        // Leading tasks untouched by the transaction.
+    guint txn_suffix;        // Trailing tasks untouched by the transaction.
+    GString *txn_records;
+};
+
+// --- Function Prototypes for better organization ---
+TaskStore *task_store_new(void);
+void task_store_begin(TaskStore *store);
+void task_store_commit(TaskStore *store);
+void task_store_append(TaskStore *store, const gchar *text, gboolean is_completed);
+void task_store_append_tasks(TaskStore *store, GPtrArray *tasks);
+void task_store_set_completed(TaskStore *store, guint position, gboolean is_completed);
+void task_store_set_text(TaskStore *store, guint position, const gchar *text);
+void task_store_set_status(TaskStore *store, guint position, guint status);
+void task_store_remove(TaskStore *store, guint *positions, guint n_positions);
+void task_store_complete_all(TaskStore *store);
+void task_store_invert_all(TaskStore *store);
+void task_store_delete_completed(TaskStore *store);
+TaskWriter *task_writer_new(const gchar *journal_path, const gchar *header, FileCipher *cipher);
+void task_writer_append(TaskWriter *writer, const gchar *data, gsize length);
+void task_writer_snapshot(TaskWriter *writer, const gchar *path, GString *contents);
+gboolean task_writer_free(TaskWriter *writer);
+GtkWidget *create_list_item(const gchar *text, gboolean is_completed);
+void save_tasks_to_file(TaskStore *store);
+void load_tasks_from_file(TaskStore *store);
+static void on_add_button_clicked(GtkWidget *widget, gpointer user_data);
+static void on_remove_button_clicked(GtkWidget *widget, gpointer user_data);
+static void on_check_button_toggled(GtkWidget *widget, gpointer user_data);
+static void on_window_destroy(GtkWidget *widget, gpointer user_data);
+static void activate(GtkApplication *app, gpointer user_data);
+
+/**
+ * @brief Frees a task and its text.
+ *
+ * @param data A pointer to the Task.
+ */
+static void task_free(gpointer data) {
+    Task *task = data;
+    g_free(task->text);
+    g_free(task);
+}
+
+// --- Task Fields ---
+
+/**
+ * @brief Parses the "YYYY-MM-DD" value of a date token.
+ *
+ * @param value The text after the colon.
+ * @return The julian day, or 0 if the value is not a valid date followed
+ * by the end of the word.
+ */
+static guint32 task_parse_date(const gchar *value) {
+    guint year, month, day;
+    gint consumed = 0;
+    GDate date;
+
+    if (sscanf(value, "%4u-%2u-%2u%n", &year, &month, &day, &consumed) != 3 ||
+        (value[consumed] != '\0' && !g_ascii_isspace(value[consumed])) ||
+        !g_date_valid_dmy(day, month, year)) {
+        return 0;
+    }
+    g_date_clear(&date, 1);
+    g_date_set_dmy(&date, day, month, year);
+    return g_date_get_julian(&date);
+}
+
+/**
+ * @brief Reads the structured fields a task carries in its text.
+ *
+ * A "due:YYYY-MM-DD" token sets the due date, a "start:YYYY-MM-DD" token
+ * the start date and a "prio:N" token the priority. Like tags, tokens must
+ * start a word. Safe to call from worker threads.
+ *
+ * @param task The task whose text was just set.
+ */
+static void task_parse_fields(Task *task) {
+    task->due = 0;
+    task->start = 0;
+    task->priority = 0;
+
+    for (const gchar *p = task->text; (p = strchr(p, ':')) != NULL; p++) {
+        const gchar *word = p;
+        while (word > task->text && !g_ascii_isspace(word[-1])) {
+            word--;
+        }
+        if (p - word == 3 && strncmp(word, "due", 3) == 0) {
+            task->due = task_parse_date(p + 1);
+        } else if (p - word == 5 && strncmp(word, "start", 5) == 0) {
+            task->start = task_parse_date(p + 1);
+        } else if (p - word == 4 && strncmp(word, "prio", 4) == 0 && g_ascii_isdigit(p[1])) {
+            task->priority = MIN(strtoul(p + 1, NULL, 10), G_MAXUINT8);
+        }
+    }
+}
+
+// --- Tag Index ---
+
+/**
+ * @brief Collects the "#tag" tokens of a task text.
+ *
+ * @param text The task text.
+ * @return A set (GHashTable) of lower-cased tag names without the '#'.
+ */
+static GHashTable *extract_tags(const gchar *text) {
+    GHashTable *tags = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+    for (const gchar *p = text; (p = strchr(p, '#')) != NULL; ) {
+        const gchar *start = ++p;
+        while (g_ascii_isalnum(*p) || *p == '-' || *p == '_') {
+            p++;
+        }
+        // A tag must start a word, so "C#" or "issue#12" are not tags.
+        if (p > start && (start - 1 == text || g_ascii_isspace(start[-2]))) {
+            g_hash_table_add(tags, g_ascii_strdown(start, p - start));
+        }
+    }
+    return tags;
+}
+
+/**
+ * @brief Adds or removes one task under each tag in @tags.
+ */
+static void tag_index_update(GHashTable *tag_index, GHashTable *tags, Task *task, gboolean add) {
+    GHashTableIter iter;
+    gpointer tag;
+
+    g_hash_table_iter_init(&iter, tags);
+    while (g_hash_table_iter_next(&iter, &tag, NULL)) {
+        GHashTable *tasks = g_hash_table_lookup(tag_index, tag);
+        if (add) {
+            if (!tasks) {
+                tasks = g_hash_table_new(g_direct_hash, g_direct_equal);
+                g_hash_table_insert(tag_index, g_strdup(tag), tasks);
+            }
+            g_hash_table_add(tasks, task);
+        } else if (tasks) {
+            g_hash_table_remove(tasks, task);
+            if (g_hash_table_size(tasks) == 0) {
+                g_hash_table_remove(tag_index, tag);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Indexes or unindexes all tags of a task.
+ */
+static void tag_index_task(GHashTable *tag_index, Task *task, gboolean add) {
+    GHashTable *tags = extract_tags(task->text);
+    tag_index_update(tag_index, tags, task, add);
+    g_hash_table_unref(tags);
+}
+
+/**
+ * @brief Updates the index for a text edit, touching only the tags that were
+ * added or removed by the edit.
+ */
+static void tag_index_retext(GHashTable *tag_index, Task *task, const gchar *old_text, const gchar *new_text) {
+    GHashTable *old_tags = extract_tags(old_text);
+    GHashTable *new_tags = extract_tags(new_text);
+    GHashTableIter iter;
+    gpointer tag;
+
+    // Drop the tags both texts share; what remains is the difference.
+    g_hash_table_iter_init(&iter, old_tags);
+    while (g_hash_table_iter_next(&iter, &tag, NULL)) {
+        if (g_hash_table_remove(new_tags, tag)) {
+            g_hash_table_iter_remove(&iter);
+        }
+    }
+    tag_index_update(tag_index, old_tags, task, FALSE);
+    tag_index_update(tag_index, new_tags, task, TRUE);
+
+    g_hash_table_unref(old_tags);
+    g_hash_table_unref(new_tags);
+}
+
+// --- Task Columns ---
+
+// Tasks per word of TaskColumns::done.
+#define COLUMN_WORD_BITS 64
+
+/**
+ * @brief Returns the mask of the bits of the word holding task @index
+ * that cover tasks before @index.
+ */
+static inline guint64 column_bits_below(guint index) {
+    guint shift = index % COLUMN_WORD_BITS;
+    return shift == 0 ? 0 : G_MAXUINT64 >> (COLUMN_WORD_BITS - shift);
+}
+
+/**
+ * @brief Counts the completed tasks in [@from, @to) with one popcount per
+ * 64 tasks.
+ */
+static guint task_columns_count_done(const TaskColumns *columns, guint from, guint to) {
+    guint first = from / COLUMN_WORD_BITS;
+    guint last = to / COLUMN_WORD_BITS;
+    guint count = 0;
+
+    if (from >= to) {
+        return 0;
+    }
+    if (first == last) {
+        guint64 word = columns->done[first] & ~column_bits_below(from) & column_bits_below(to);
+        return __builtin_popcountll(word);
+    }
+    count = __builtin_popcountll(columns->done[first] & ~column_bits_below(from));
+    for (guint i = first + 1; i < last; i++) {
+        count += __builtin_popcountll(columns->done[i]);
+    }
+    if (to % COLUMN_WORD_BITS != 0) {
+        count += __builtin_popcountll(columns->done[last] & column_bits_below(to));
+    }
+    return count;
+}
+
+/**
+ * @brief Grows the columns to hold at least @length tasks.
+ */
+static void task_columns_reserve(TaskColumns *columns, guint length) {
+    if (length <= columns->capacity) {
+        return;
+    }
+    guint capacity = MAX(length, MAX(columns->capacity * 2, COLUMN_WORD_BITS));
+    capacity = (capacity + COLUMN_WORD_BITS - 1) / COLUMN_WORD_BITS * COLUMN_WORD_BITS;
+    guint old_words = columns->capacity / COLUMN_WORD_BITS;
+
+    columns->done = g_renew(guint64, columns->done, capacity / COLUMN_WORD_BITS);
+    memset(columns->done + old_words, 0, (capacity / COLUMN_WORD_BITS - old_words) * sizeof(guint64));
+    columns->due = g_renew(guint32, columns->due, capacity);
+    columns->priority = g_renew(guint8, columns->priority, capacity);
+    columns->status = g_renew(guint8, columns->status, capacity);
+    // Scans read whole words of tasks, so the slack must be initialized.
+    memset(columns->due + columns->capacity, 0, (capacity - columns->capacity) * sizeof(guint32));
+    memset(columns->priority + columns->capacity, 0, capacity - columns->capacity);
+    memset(columns->status + columns->capacity, 0, capacity - columns->capacity);
+    columns->capacity = capacity;
+}
+
+/**
+ * @brief Copies the fields of the tasks in [@from, @to) into the columns.
+ */
+static void task_columns_fill(TaskColumns *columns, GPtrArray *tasks, guint from, guint to) {
+    for (guint i = from; i < to; i++) {
+        const Task *task = g_ptr_array_index(tasks, i);
+        guint64 bit = G_GUINT64_CONSTANT(1) << (i % COLUMN_WORD_BITS);
+
+        if (task->is_completed) {
+            columns->done[i / COLUMN_WORD_BITS] |= bit;
+        } else {
+            columns->done[i / COLUMN_WORD_BITS] &= ~bit;
+        }
+        columns->due[i] = task->due;
+        columns->priority[i] = task->priority;
+        columns->status[i] = task->status;
+    }
+}
+
+/**
+ * @brief Brings the columns up to date with a committed transaction.
+ *
+ * An edit in place only rewrites its range, so toggling one task costs the
+ * same at any store size. A change in length shifts everything after the
+ * range, which the backing array has just done as well. The loaders fill
+ * the array without a transaction; if the columns no longer match the
+ * length the transaction started from, they are rebuilt.
+ *
+ * @param columns The store's columns.
+ * @param tasks The store's backing array, already changed.
+ * @param old_length The length of the store before the transaction.
+ */
+static void task_columns_update(TaskColumns *columns, GPtrArray *tasks, guint position, guint removed,
+                                guint added, guint old_length) {
+    guint old_end, new_end;
+
+    if (columns->length != old_length) {
+        position = old_end = 0;
+        new_end = tasks->len;
+        columns->n_done = 0;
+    } else if (removed == added) {
+        old_end = position + removed;
+        new_end = position + added;
+    } else {
+        // Past the range, an insertion or removal moves every task.
+        old_end = old_length;
+        new_end = tasks->len;
+    }
+
+    columns->n_done -= task_columns_count_done(columns, position, old_end);
+    task_columns_reserve(columns, tasks->len);
+    task_columns_fill(columns, tasks, position, new_end);
+    columns->n_done += task_columns_count_done(columns, position, new_end);
+    columns->length = tasks->len;
+}
+
+/**
+ * @brief Rebuilds the columns after the store was filled directly.
+ */
+static void task_columns_rebuild(TaskColumns *columns, GPtrArray *tasks) {
+    columns->length = G_MAXUINT;
+    task_columns_update(columns, tasks, 0, 0, 0, 0);
+}
+
+// --- Task Store ---
+
+/**
+ * @brief Creates an empty task store.
+ *
+ * @return A newly allocated TaskStore.
+ */
+TaskStore *task_store_new(void) {
+    TaskStore *store = g_new0(TaskStore, 1);
+    store->tasks = g_ptr_array_new_with_free_func(task_free);
+    store->listeners = g_array_new(FALSE, FALSE, sizeof(TaskStoreListener));
+    store->txn_records = g_string_new(NULL);
+    store->tag_index = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                             (GDestroyNotify)g_hash_table_unref);
+    store->statuses = g_ptr_array_new_with_free_func(g_free);
+    g_ptr_array_add(store->statuses, g_strdup("To Do"));
+    g_ptr_array_add(store->statuses, g_strdup("In Progress"));
+    g_ptr_array_add(store->statuses, g_strdup("Done"));
+    store->lock_fd = -1;
+    return store;
+}
+
+/**
+ * @brief Returns the status a task gets when only its completion is known.
+ */
+static guint8 task_status_for_completion(gboolean is_completed) {
+    return is_completed ? TASK_STATUS_DONE : TASK_STATUS_TODO;
+}
+
+/**
+ * @brief Completes or reopens a task. Completing remembers the status the
+ * task was in, so reopening puts it back there rather than in "To Do".
+ */
+static void task_set_completed(Task *task, gboolean is_completed) {
+    if (task->is_completed == is_completed) {
+        return;
+    }
+    if (is_completed) {
+        task->reopen_status = task->status;
+        task->status = TASK_STATUS_DONE;
+    } else {
+        task->status = task->reopen_status;
+        task->reopen_status = TASK_STATUS_TODO;
+    }
+    task->is_completed = is_completed;
+}
+
+/**
+ * @brief Finds a status by name, ignoring case.
+ *
+ * @return The status index, or -1 if there is no such status.
+ */
+static gint task_store_find_status(TaskStore *store, const gchar *name) {
+    gchar *folded = g_utf8_casefold(name, -1);
+    gint found = -1;
+
+    for (guint i = 0; i < store->statuses->len && found < 0; i++) {
+        gchar *candidate = g_utf8_casefold(g_ptr_array_index(store->statuses, i), -1);
+        if (strcmp(candidate, folded) == 0) {
+            found = i;
+        }
+        g_free(candidate);
+    }
+    g_free(folded);
+    return found;
+}
+
+/**
+ * @brief Registers a view to be notified after every committed transaction.
+ *
+ * @param store The task store.
+ * @param func The function to call with the changed range.
+ * @param user_data Data passed to @func.
+ */
+static void task_store_add_listener(TaskStore *store, TaskStoreChangedFunc func, gpointer user_data) {
+    TaskStoreListener listener = { func, user_data };
+    g_array_append_val(store->listeners, listener);
+}
+
+/**
+ * @brief Like task_store_add_listener(), but the listener runs before all
+ * others. Used for derived data that views read from, so it is up to date
+ * by the time they are notified.
+ */
+static void task_store_prepend_listener(TaskStore *store, TaskStoreChangedFunc func, gpointer user_data) {
+    TaskStoreListener listener = { func, user_data };
+    g_array_prepend_val(store->listeners, listener);
+}
+
+/**
+ * @brief Removes a listener previously added with task_store_add_listener().
+ *
+ * @param store The task store.
+ * @param user_data The data the listener was registered with.
+ */
+static void task_store_remove_listener(TaskStore *store, gpointer user_data) {
+    for (guint i = 0; i < store->listeners->len; i++) {
+        if (g_array_index(store->listeners, TaskStoreListener, i).user_data == user_data) {
+            g_array_remove_index(store->listeners, i);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Returns the task at the given position.
+ */
+static Task *task_store_get(TaskStore *store, guint position) {
+    return g_ptr_array_index(store->tasks, position);
+}
+
+/**
+ * @brief Finds the current position of a task.
+ *
+ * @param store The task store.
+ * @param id The task id.
+ * @param position Return location for the position, or, if the task is
+ * gone, for the position of the first task after it.
+ * @return TRUE if the task is still in the store.
+ */
+static gboolean task_store_find(TaskStore *store, guint id, guint *position) {
+    // Tasks are only ever appended and ids only grow, so the array is
+    // sorted by id.
+    guint low = 0, high = store->tasks->len;
+
+    while (low < high) {
+        guint middle = low + (high - low) / 2;
+        if (task_store_get(store, middle)->id < id) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    *position = low;
+    return low < store->tasks->len && task_store_get(store, low)->id == id;
+}
+
+/**
+ * @brief A copy of a task's text and id, for handing to a worker thread.
+ */
+typedef struct {
+    gchar *text;
+    guint id;
+} TaskText;
+
+static void task_text_clear(gpointer data) {
+    g_free(((TaskText *)data)->text);
+}
+
+/**
+ * @brief Copies the text and id of every task. Worker threads get these
+ * copies, since the store keeps changing while they run.
+ *
+ * @param store The task store.
+ * @return A GArray of TaskText, in store order.
+ */
+static GArray *task_store_snapshot_texts(TaskStore *store) {
+    GArray *texts = g_array_sized_new(FALSE, FALSE, sizeof(TaskText), store->tasks->len);
+
+    g_array_set_clear_func(texts, task_text_clear);
+    for (guint i = 0; i < store->tasks->len; i++) {
+        Task *task = task_store_get(store, i);
+        TaskText copy = { g_strdup(task->text), task->id };
+        g_array_append_val(texts, copy);
+    }
+    return texts;
+}
+
+/**
+ * @brief Opens a transaction. Transactions may be nested; only the outermost
+ * commit notifies the views and writes the journal.
+ *
+ * @param store The task store.
+ */
+void task_store_begin(TaskStore *store) {
+    if (store->txn_depth++ > 0) {
+        return;
+    }
+    store->txn_changed = FALSE;
+    store->txn_old_length = store->tasks->len;
+    store->txn_prefix = G_MAXUINT;
+    store->txn_suffix = G_MAXUINT;
+    g_string_truncate(store->txn_records, 0);
+}
+
+/**
+ * @brief Records that the range starting at @position changed inside the
+ * current transaction. Must be called after the backing array was modified.
+ *
+ * Untouched prefixes and suffixes are intersected, so any sequence of edits
+ * collapses into a single range notification at commit time.
+ */
+static void task_store_touch(TaskStore *store, guint position, guint added) {
+    store->txn_changed = TRUE;
+    store->txn_prefix = MIN(store->txn_prefix, position);
+    store->txn_suffix = MIN(store->txn_suffix, store->tasks->len - (position + added));
+}
+
+/**
+ * @brief Appends a journal record to the current transaction.
+ */
+static void task_store_log(TaskStore *store, const gchar *format, ...) G_GNUC_PRINTF(2, 3);
+static void task_store_log(TaskStore *store, const gchar *format, ...) {
+    va_list args;
+
+    if (store->replaying) {
+        return;
+    }
+    va_start(args, format);
+    g_string_append_vprintf(store->txn_records, format, args);
+    va_end(args);
+    g_string_append_c(store->txn_records, '\n');
+}
+
+/**
+ * @brief Commits the current transaction.
+ *
+ * The store's columns are updated first, then the views receive one range
+ * notification, and the backend persists the transaction: the task file's
+ * journal receives all of its records in a single write, and is compacted
+ * into the task file once it has grown large enough.
+ *
+ * @param store The task store.
+ */
+void task_store_commit(TaskStore *store) {
+    if (--store->txn_depth > 0 || !store->txn_changed) {
+        return;
+    }
+
+    guint position = store->txn_prefix;
+    guint removed = store->txn_old_length - position - store->txn_suffix;
+    guint added = store->tasks->len - position - store->txn_suffix;
+
+    // The journal is replayed before anything reads the columns; they are
+    // rebuilt once the store is loaded.
+    if (store->replaying) {
+        store->columns.length = G_MAXUINT;
+    } else {
+        task_columns_update(&store->columns, store->tasks, position, removed, added, store->txn_old_length);
+    }
+    for (guint i = 0; i < store->listeners->len; i++) {
+        TaskStoreListener *listener = &g_array_index(store->listeners, TaskStoreListener, i);
+        listener->func(store, position, removed, added, listener->user_data);
+    }
+
+    if (store->replaying || store->read_only || store->txn_records->len == 0 || !store->backend) {
+        return;
+    }
+    store->backend->commit(store, position, removed, added);
+}
+
+/**
+ * @brief Inserts a task without logging or notifying. Used by the loader and
+ * by the mutation functions below.
+ */
+/**
+ * @brief Turns the line breaks in a task text into spaces, in place. A
+ * task is one line in TASKS_FILE, the journal and the change feed, so a
+ * break inside its text would start a record of its own.
+ *
+ * @return @text.
+ */
+static gchar *task_text_flatten(gchar *text) {
+    return g_strdelimit(text, "\r\n", ' ');
+}
+
+static void task_store_insert_raw(TaskStore *store, guint position, const gchar *text, gboolean is_completed) {
+    Task *task = g_new0(Task, 1);
+    task->id = ++store->next_id;
+    task->text = task_text_flatten(g_strdup(text));
+    task->is_completed = is_completed;
+    task->status = task_status_for_completion(is_completed);
+    task_parse_fields(task);
+    g_ptr_array_insert(store->tasks, position, task);
+    tag_index_task(store->tag_index, task, TRUE);
+}
+
+/**
+ * @brief Appends a new task to the end of the list.
+ *
+ * @param store The task store.
+ * @param text The task text. Line breaks in it become spaces.
+ * @param is_completed The initial completion status.
+ */
+void task_store_append(TaskStore *store, const gchar *text, gboolean is_completed) {
+    task_store_begin(store);
+    task_store_insert_raw(store, store->tasks->len, text, is_completed);
+    task_store_touch(store, store->tasks->len - 1, 1);
+    task_store_log(store, "A\t%d\t%s", is_completed, task_store_get(store, store->tasks->len - 1)->text);
+    task_store_commit(store);
+}
+
+/**
+ * @brief Appends a batch of tasks in one transaction.
+ *
+ * The store takes ownership of the tasks; @tasks itself is left empty.
+ *
+ * @param store The task store.
+ * @param tasks A GPtrArray of newly allocated Task pointers. Line breaks
+ * in their texts become spaces.
+ */
+void task_store_append_tasks(TaskStore *store, GPtrArray *tasks) {
+    guint position = store->tasks->len;
+
+    if (tasks->len == 0) {
+        return;
+    }
+
+    task_store_begin(store);
+    for (guint i = 0; i < tasks->len; i++) {
+        Task *task = g_ptr_array_index(tasks, i);
+        task->id = ++store->next_id;
+        task_text_flatten(task->text);
+        // Records only carry the completion, so new tasks start in its default status.
+        task->status = task_status_for_completion(task->is_completed);
+        task_parse_fields(task);
+        g_ptr_array_add(store->tasks, task);
+        tag_index_task(store->tag_index, task, TRUE);
+        task_store_log(store, "A\t%d\t%s", task->is_completed, task->text);
+    }
+    task_store_touch(store, position, tasks->len);
+    task_store_commit(store);
+
+    g_ptr_array_set_free_func(tasks, NULL);
+    g_ptr_array_set_size(tasks, 0);
+}
+
+/**
+ * @brief Sets the completion status of a single task.
+ *
+ * @param store The task store.
+ * @param position The index of the task.
+ * @param is_completed The new completion status.
+ */
+void task_store_set_completed(TaskStore *store, guint position, gboolean is_completed) {
+    Task *task = task_store_get(store, position);
+    if (task->is_completed == is_completed) {
+        return;
+    }
+
+    task_store_begin(store);
+    task_set_completed(task, is_completed);
+    task_store_touch(store, position, 1);
+    task_store_log(store, "T\t%u\t%d", position, is_completed);
+    task_store_commit(store);
+}
+
+/**
+ * @brief Moves a single task to another status, as when a card is dragged
+ * to another board column. Moving to or from "Done" also sets the
+ * completion.
+ *
+ * @param store The task store.
+ * @param position The index of the task.
+ * @param status An index into the store's statuses.
+ */
+void task_store_set_status(TaskStore *store, guint position, guint status) {
+    Task *task = task_store_get(store, position);
+    if (task->status == status || status >= store->statuses->len) {
+        return;
+    }
+
+    task_store_begin(store);
+    // A card dragged to "Done" is reopened to where it was dragged from.
+    task->reopen_status = status == TASK_STATUS_DONE ? task->status : TASK_STATUS_TODO;
+    task->status = status;
+    task->is_completed = status == TASK_STATUS_DONE;
+    task_store_touch(store, position, 1);
+    task_store_log(store, "M\t%u\t%u", position, status);
+    task_store_commit(store);
+}
+
+/**
+ * @brief Replaces the text of a single task, journaling only that record.
+ *
+ * @param store The task store.
+ * @param position The index of the task.
+ * @param text The new task text. Line breaks in it become spaces.
+ */
+void task_store_set_text(TaskStore *store, guint position, const gchar *text) {
+    Task *task = task_store_get(store, position);
+    gchar *flat = task_text_flatten(g_strdup(text));
+
+    if (g_strcmp0(task->text, flat) == 0) {
+        g_free(flat);
+        return;
+    }
+
+    task_store_begin(store);
+    tag_index_retext(store->tag_index, task, task->text, flat);
+    g_free(task->text);
+    task->text = flat;
+    task->revision++;
+    task_parse_fields(task);
+    task_store_touch(store, position, 1);
+    task_store_log(store, "E\t%u\t%s", position, flat);
+    task_store_commit(store);
+}
+
+/**
+ * @brief Compares two guint values in descending order.
+ */
+static gint compare_positions_descending(gconstpointer a, gconstpointer b) {
+    guint pa = *(const guint *)a;
+    guint pb = *(const guint *)b;
+    return (pa < pb) - (pa > pb);
+}
+
+/**
+ * @brief Removes several tasks in one transaction.
+ *
+ * @param store The task store.
+ * @param positions The indices to remove. The array is sorted in place.
+ * @param n_positions The number of entries in @positions.
+ */
+void task_store_remove(TaskStore *store, guint *positions, guint n_positions) {
+    if (n_positions == 0) {
+        return;
+    }
+
+    // Removing from the back keeps the remaining indices valid.
+    qsort(positions, n_positions, sizeof(guint), compare_positions_descending);
+
+    GString *record = g_string_new("R");
+    task_store_begin(store);
+    for (guint i = 0; i < n_positions; i++) {
+        tag_index_task(store->tag_index, task_store_get(store, positions[i]), FALSE);
+        g_ptr_array_remove_index(store->tasks, positions[i]);
+        task_store_touch(store, positions[i], 0);
+        g_string_append_printf(record, "\t%u", positions[i]);
+    }
+    task_store_log(store, "%s", record->str);
+    task_store_commit(store);
+    g_string_free(record, TRUE);
+}
+
+/**
+ * @brief Marks every task as completed in a single pass.
+ *
+ * @param store The task store.
+ */
+void task_store_complete_all(TaskStore *store) {
+    guint first = G_MAXUINT, last = 0;
+
+    task_store_begin(store);
+    for (guint i = 0; i < store->tasks->len; i++) {
+        Task *task = task_store_get(store, i);
+        if (!task->is_completed) {
+            task_set_completed(task, TRUE);
+            first = MIN(first, i);
+            last = i;
+        }
+    }
+    // A transaction that touched nothing commits nothing.
+    if (first != G_MAXUINT) {
+        task_store_touch(store, first, last - first + 1);
+        task_store_log(store, "C");
+    }
+    task_store_commit(store);
+}
+
+/**
+ * @brief Flips the completion status of every task in a single pass.
+ *
+ * @param store The task store.
+ */
+void task_store_invert_all(TaskStore *store) {
+    task_store_begin(store);
+    for (guint i = 0; i < store->tasks->len; i++) {
+        Task *task = task_store_get(store, i);
+        task_set_completed(task, !task->is_completed);
+    }
+    if (store->tasks->len > 0) {
+        task_store_touch(store, 0, store->tasks->len);
+        task_store_log(store, "I");
+    }
+    task_store_commit(store);
+}
+
+/**
+ * @brief Removes every completed task, compacting the backing array in a
+ * single pass.
+ *
+ * @param store The task store.
+ */
+void task_store_delete_completed(TaskStore *store) {
+    guint length = store->tasks->len;
+    guint first = G_MAXUINT;
+    guint kept = 0;
+
+    task_store_begin(store);
+    for (guint i = 0; i < length; i++) {
+        Task *task = task_store_get(store, i);
+        if (task->is_completed) {
+            first = MIN(first, i);
+            tag_index_task(store->tag_index, task, FALSE);
+            task_free(task);
+        } else {
+            store->tasks->pdata[kept++] = task;
+        }
+    }
+    if (first != G_MAXUINT) {
+        // The removed tasks were freed above, so only shrink the array.
+        g_ptr_array_set_free_func(store->tasks, NULL);
+        g_ptr_array_set_size(store->tasks, kept);
+        g_ptr_array_set_free_func(store->tasks, task_free);
+        task_store_touch(store, first, kept - first);
+        task_store_log(store, "D");
+    }
+    task_store_commit(store);
+}
+
+/**
+ * @brief Applies one journal record to the store.
+ *
+ * @param store The task store.
+ * @param line A record as written by task_store_log(), without the newline.
+ */
+static void task_store_replay_record(TaskStore *store, gchar *line) {
+    gchar **fields = g_strsplit(line, "\t", (line[0] == 'A' || line[0] == 'E') ? 3 : -1);
+    guint n_fields = g_strv_length(fields);
+    guint length = store->tasks->len;
+
+    switch (line[0]) {
+    case 'A':
+        if (n_fields == 3) {
+            task_store_append(store, fields[2], atoi(fields[1]) == 1);
+        }
+        break;
+    case 'T':
+        if (n_fields == 3 && strtoul(fields[1], NULL, 10) < length) {
+            task_store_set_completed(store, strtoul(fields[1], NULL, 10), atoi(fields[2]) == 1);
+        }
+        break;
+    case 'E':
+        if (n_fields == 3 && strtoul(fields[1], NULL, 10) < length) {
+            task_store_set_text(store, strtoul(fields[1], NULL, 10), fields[2]);
+        }
+        break;
+    case 'M':
+        if (n_fields == 3 && strtoul(fields[1], NULL, 10) < length) {
+            task_store_set_status(store, strtoul(fields[1], NULL, 10), strtoul(fields[2], NULL, 10));
+        }
+        break;
+    case 'R': {
+        GArray *positions = g_array_new(FALSE, FALSE, sizeof(guint));
+        for (guint i = 1; i < n_fields; i++) {
+            guint position = strtoul(fields[i], NULL, 10);
+            if (position < length) {
+                g_array_append_val(positions, position);
+            }
+        }
+        task_store_remove(store, (guint *)positions->data, positions->len);
+        g_array_free(positions, TRUE);
+        break;
+    }
+    case 'C':
+        task_store_complete_all(store);
+        break;
+    case 'I':
+        task_store_invert_all(store);
+        break;
+    case 'D':
+        task_store_delete_completed(store);
+        break;
+    default:
+        g_warning("Ignoring unknown journal record '%s'.", line);
+        break;
+    }
+    g_strfreev(fields);
+}
+
+/**
+ * @brief What a listener last saw of a task, to tell the tasks a commit
+ * changed from those it only touched along with them.
+ */
+typedef struct {
+    guint id;
+    guint32 revision;
+    guint8 status;
+} TaskStamp;
+
+typedef enum {
+    TASK_CHANGE_ADDED,
+    TASK_CHANGE_REMOVED,
+    TASK_CHANGE_TEXT,        // The text changed, and maybe the status too.
+    TASK_CHANGE_STATUS,
+} TaskChange;
+
+/**
+ * @brief Called by task_stamps_update() for each task a commit changed.
+ *
+ * @param task The task as it is now, or NULL if it was removed.
+ */
+typedef void (*TaskChangeFunc)(TaskChange change, guint id, const Task *task, gpointer user_data);
+
+static void task_stamp_set(TaskStamp *stamp, const Task *task) {
+    stamp->id = task->id;
+    stamp->revision = task->revision;
+    stamp->status = task->status;
+}
+
+/**
+ * @brief Fills @stamps with one TaskStamp per task, in store order.
+ */
+static void task_stamps_init(GArray *stamps, TaskStore *store) {
+    g_array_set_size(stamps, store->tasks->len);
+    for (guint i = 0; i < store->tasks->len; i++) {
+        task_stamp_set(&g_array_index(stamps, TaskStamp, i), task_store_get(store, i));
+    }
+}
+
+/**
+ * @brief Brings @stamps up to date with a commit, calling @func for each
+ * task that was added, removed or changed.
+ *
+ * Tasks are ordered by id in both the old and new range, so one walk over
+ * the two pairs them up.
+ *
+ * @param func The function to call, or NULL to only update the stamps.
+ */
+static void task_stamps_update(GArray *stamps, TaskStore *store, guint position, guint removed, guint added,
+                               TaskChangeFunc func, gpointer user_data) {
+    TaskStamp *old = (TaskStamp *)stamps->data + position;
+    GArray *stamped = g_array_sized_new(FALSE, FALSE, sizeof(TaskStamp), added);
+    guint i = 0, j = 0;
+
+    while (i < removed || j < added) {
+        Task *task = j < added ? task_store_get(store, position + j) : NULL;
+        TaskStamp stamp;
+
+        if (!task || (i < removed && old[i].id < task->id)) {
+            if (func) {
+                func(TASK_CHANGE_REMOVED, old[i].id, NULL, user_data);
+            }
+            i++;
+            continue;
+        }
+        task_stamp_set(&stamp, task);
+        g_array_append_val(stamped, stamp);
+        if (i < removed && old[i].id == task->id) {
+            if (func && old[i].revision != stamp.revision) {
+                func(TASK_CHANGE_TEXT, task->id, task, user_data);
+            } else if (func && old[i].status != stamp.status) {
+                func(TASK_CHANGE_STATUS, task->id, task, user_data);
+            }
+            i++;
+        } else if (func) {
+            func(TASK_CHANGE_ADDED, task->id, task, user_data);
+        }
+        j++;
+    }
+
+    g_array_remove_range(stamps, position, removed);
+    g_array_insert_vals(stamps, position, stamped->data, stamped->len);
+    g_array_free(stamped, TRUE);
+}
+
+// --- Task Queries ---
+
+/*
+ * Filters are written in a small query language, for example
+ *
+ *     !done and (tag:infra or text~"deploy") and due<7d and prio>=2
+ *
+ * Predicates are "done", "status:NAME" (case-insensitive, quoted if the
+ * name has spaces), "tag:NAME" (or "#NAME"), "text~STRING" (a
+ * case-insensitive substring; a bare word or quoted string means the
+ * same), "due" and "prio", which may be compared with <, <=, >, >=, = and
+ * !=. Dates are YYYY-MM-DD, "today", "tomorrow", "yesterday" or a number
+ * of days or weeks from today such as "7d" or "2w". Tasks without a due
+ * date never match a due comparison; a missing priority counts as 0.
+ * Predicates combine with "and" (also "&&" or just juxtaposition), "or"
+ * ("||"), "not" ("!") and parentheses.
+ *
+ * A query is parsed once into a tree and compiled into a flat program for
+ * a single-register machine: each predicate sets the register, "not"
+ * inverts it, and "and"/"or" are conditional jumps, so evaluation short
+ * circuits. Operands of "and" and "or" are reordered so the cheapest
+ * predicates run first; tag predicates are answered from the tag index.
+ */
+
+typedef enum {
+    QUERY_OP_DONE,
+    QUERY_OP_TAG,                // arg: index into the query's strings.
+    QUERY_OP_TEXT,               // arg: index into the query's strings.
+    QUERY_OP_DUE,                // arg: julian day, or days from today if relative.
+    QUERY_OP_PRIO,               // arg: priority.
+    QUERY_OP_STATUS,             // arg: index into the query's strings.
+    QUERY_OP_NOT,
+    QUERY_OP_JUMP_IF_FALSE,      // arg: target instruction.
+    QUERY_OP_JUMP_IF_TRUE,       // arg: target instruction.
+} QueryOpcode;
+
+typedef enum {
+    QUERY_CMP_ANY,               // The field is set at all.
+    QUERY_CMP_LT,
+    QUERY_CMP_LE,
+    QUERY_CMP_GT,
+    QUERY_CMP_GE,
+    QUERY_CMP_EQ,
+    QUERY_CMP_NE,
+} QueryCompare;
+
+/**
+ * @brief One instruction of a compiled query.
+ */
+typedef struct {
+    guint8 op;                   // A QueryOpcode.
+    guint8 cmp;                  // A QueryCompare, for QUERY_OP_DUE and QUERY_OP_PRIO.
+    guint8 relative;             // TRUE if a due date is relative to today.
+    gint32 arg;
+} QueryInstr;
+
+/**
+ * @brief A compiled query.
+ */
+typedef struct {
+    gchar *source;
+    GArray *code;                // QueryInstr entries.
+    GPtrArray *strings;          // Tag names (lower-cased), search texts (case-folded) and status names.
+    GArray *required_tags;       // String indices of tags every match must carry.
+    gboolean relative;           // TRUE if the result depends on today's date.
+} Query;
+
+/**
+ * @brief Per-evaluation state, resolved once before matching any task.
+ */
+typedef struct {
+    gint32 today;                // Julian day of the local date.
+    GHashTable **tag_sets;       // Per string: the tag index set, or NULL.
+    gint *statuses;              // Per string: the status index, or -1.
+} QueryContext;
+
+#define QUERY_ERROR (query_error_quark())
+
+typedef enum {
+    QUERY_ERROR_SYNTAX,
+} QueryError;
+
+G_DEFINE_QUARK(project-tracker-query-error-quark, query_error)
+
+typedef enum {
+    QUERY_NODE_AND,
+    QUERY_NODE_OR,
+    QUERY_NODE_NOT,
+    QUERY_NODE_PREDICATE,
+} QueryNodeKind;
+
+/**
+ * @brief A node of the parse tree. "and" and "or" nodes are n-ary.
+ */
+typedef struct {
+    QueryNodeKind kind;
+    QueryInstr predicate;        // For QUERY_NODE_PREDICATE.
+    GPtrArray *children;         // For the other kinds.
+} QueryNode;
+
+typedef enum {
+    QUERY_TOKEN_END,
+    QUERY_TOKEN_LPAREN,
+    QUERY_TOKEN_RPAREN,
+    QUERY_TOKEN_NOT,
+    QUERY_TOKEN_AND,
+    QUERY_TOKEN_OR,
+    QUERY_TOKEN_WORD,
+    QUERY_TOKEN_STRING,
+    QUERY_TOKEN_OPERATOR,        // ':', '~' or a comparison.
+} QueryTokenType;
+
+typedef struct {
+    const gchar *p;              // Next character to read.
+    QueryTokenType type;         // The current token.
+    gchar *text;                 // Its text, for words, strings and operators.
+    Query *query;                // Receives the strings of the predicates.
+} QueryParser;
+
+static void query_node_free(gpointer data) {
+    QueryNode *node = data;
+    if (node->children) {
+        g_ptr_array_unref(node->children);
+    }
+    g_free(node);
+}
+
+static QueryNode *query_node_new(QueryNodeKind kind) {
+    QueryNode *node = g_new0(QueryNode, 1);
+    node->kind = kind;
+    if (kind != QUERY_NODE_PREDICATE) {
+        node->children = g_ptr_array_new_with_free_func(query_node_free);
+    }
+    return node;
+}
+
+/**
+ * @brief Reads the next token into the parser.
+ */
+static gboolean query_parser_next(QueryParser *parser, GError **error) {
+    const gchar *p = parser->p;
+
+    g_clear_pointer(&parser->text, g_free);
+    while (g_ascii_isspace(*p)) {
+        p++;
+    }
+
+    if (*p == '\0') {
+        parser->type = QUERY_TOKEN_END;
+    } else if (*p == '(' || *p == ')') {
+        parser->type = *p++ == '(' ? QUERY_TOKEN_LPAREN : QUERY_TOKEN_RPAREN;
+    } else if (strncmp(p, "&&", 2) == 0 || strncmp(p, "||", 2) == 0) {
+        parser->type = *p == '&' ? QUERY_TOKEN_AND : QUERY_TOKEN_OR;
+        p += 2;
+    } else if (*p == '!' && p[1] != '=') {
+        parser->type = QUERY_TOKEN_NOT;
+        p++;
+    } else if (strchr(":~<>=!", *p)) {
+        gsize length = (p[1] == '=' && strchr("<>!", *p)) ? 2 : 1;
+        parser->type = QUERY_TOKEN_OPERATOR;
+        parser->text = g_strndup(p, length);
+        p += length;
+    } else if (*p == '"') {
+        GString *string = g_string_new(NULL);
+        for (p++; *p && *p != '"'; p++) {
+            if (*p == '\\' && p[1]) {
+                p++;
+            }
+            g_string_append_c(string, *p);
+        }
+        if (*p != '"') {
+            g_string_free(string, TRUE);
+            g_set_error(error, QUERY_ERROR, QUERY_ERROR_SYNTAX, "Missing closing quote");
+            return FALSE;
+        }
+        p++;
+        parser->type = QUERY_TOKEN_STRING;
+        parser->text = g_string_free(string, FALSE);
+    } else {
+        const gchar *start = p;
+        while (*p && !g_ascii_isspace(*p) && !strchr("()\":~<>=!&|", *p)) {
+            p++;
+        }
+        if (p == start) {
+            g_set_error(error, QUERY_ERROR, QUERY_ERROR_SYNTAX, "Unexpected '%c'", *p);
+            return FALSE;
+        }
+        parser->text = g_strndup(start, p - start);
+        if (g_ascii_strcasecmp(parser->text, "and") == 0) {
+            parser->type = QUERY_TOKEN_AND;
+        } else if (g_ascii_strcasecmp(parser->text, "or") == 0) {
+            parser->type = QUERY_TOKEN_OR;
+        } else if (g_ascii_strcasecmp(parser->text, "not") == 0) {
+            parser->type = QUERY_TOKEN_NOT;
+        } else {
+            parser->type = QUERY_TOKEN_WORD;
+        }
+    }
+
+    parser->p = p;
+    return TRUE;
+}
+
+/**
+ * @brief Adds a string to the query and returns its index.
+ */
+static gint32 query_add_string(Query *query, gchar *string) {
+    g_ptr_array_add(query->strings, string);
+    return query->strings->len - 1;
+}
+
+/**
+ * @brief Parses a due date value into a predicate.
+ */
+static gboolean query_parse_date(const gchar *text, QueryInstr *instr, GError **error) {
+    guint year, month, day;
+    gint consumed = 0;
+    gchar *end;
+
+    if (g_ascii_strcasecmp(text, "today") == 0) {
+        instr->relative = TRUE;
+        instr->arg = 0;
+    } else if (g_ascii_strcasecmp(text, "tomorrow") == 0) {
+        instr->relative = TRUE;
+        instr->arg = 1;
+    } else if (g_ascii_strcasecmp(text, "yesterday") == 0) {
+        instr->relative = TRUE;
+        instr->arg = -1;
+    } else if (sscanf(text, "%4u-%2u-%2u%n", &year, &month, &day, &consumed) == 3 &&
+               text[consumed] == '\0' && g_date_valid_dmy(day, month, year)) {
+        GDate date;
+        g_date_clear(&date, 1);
+        g_date_set_dmy(&date, day, month, year);
+        instr->arg = g_date_get_julian(&date);
+    } else {
+        glong count = strtol(text, &end, 10);
+        if (end == text || (g_ascii_tolower(*end) != 'd' && g_ascii_tolower(*end) != 'w') ||
+            end[1] != '\0' || ABS(count) > 100000) {
+            g_set_error(error, QUERY_ERROR, QUERY_ERROR_SYNTAX, "'%s' is not a date", text);
+            return FALSE;
+        }
+        instr->relative = TRUE;
+        instr->arg = g_ascii_tolower(*end) == 'w' ? count * 7 : count;
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Builds a text search predicate.
+ */
+static QueryNode *query_text_node(QueryParser *parser, const gchar *text) {
+    QueryNode *node = query_node_new(QUERY_NODE_PREDICATE);
+    node->predicate.op = QUERY_OP_TEXT;
+    node->predicate.arg = query_add_string(parser->query, g_utf8_casefold(text, -1));
+    return node;
+}
+
+static QueryNode *query_parse_or(QueryParser *parser, GError **error);
+
+/**
+ * @brief Parses a predicate. The current token is a word or a string.
+ */
+static QueryNode *query_parse_predicate(QueryParser *parser, GError **error) {
+    gchar *field = g_steal_pointer(&parser->text);
+    QueryTokenType type = parser->type;
+    QueryNode *node = NULL;
+
+    if (!query_parser_next(parser, error)) {
+        g_free(field);
+        return NULL;
+    }
+
+    if (type == QUERY_TOKEN_STRING) {
+        node = query_text_node(parser, field);
+    } else if (parser->type != QUERY_TOKEN_OPERATOR) {
+        // A word on its own.
+        node = query_node_new(QUERY_NODE_PREDICATE);
+        if (g_ascii_strcasecmp(field, "done") == 0) {
+            node->predicate.op = QUERY_OP_DONE;
+        } else if (g_ascii_strcasecmp(field, "due") == 0) {
+            node->predicate.op = QUERY_OP_DUE;
+            node->predicate.cmp = QUERY_CMP_ANY;
+        } else if (g_ascii_strcasecmp(field, "prio") == 0) {
+            node->predicate.op = QUERY_OP_PRIO;
+            node->predicate.cmp = QUERY_CMP_GT;
+        } else if (field[0] == '#' && field[1]) {
+            node->predicate.op = QUERY_OP_TAG;
+            node->predicate.arg = query_add_string(parser->query, g_ascii_strdown(field + 1, -1));
+        } else {
+            query_node_free(node);
+            node = query_text_node(parser, field);
+        }
+    } else {
+        static const gchar *const comparisons[] = { NULL, "<", "<=", ">", ">=", "=", "!=" };
+        gchar *operator = g_steal_pointer(&parser->text);
+        QueryCompare cmp = QUERY_CMP_ANY;
+
+        for (guint i = 1; i < G_N_ELEMENTS(comparisons); i++) {
+            if (strcmp(operator, comparisons[i]) == 0) {
+                cmp = i;
+            }
+        }
+        if (!query_parser_next(parser, error)) {
+            g_free(operator);
+            g_free(field);
+            return NULL;
+        }
+        if (parser->type != QUERY_TOKEN_WORD && parser->type != QUERY_TOKEN_STRING) {
+            g_set_error(error, QUERY_ERROR, QUERY_ERROR_SYNTAX, "Missing value after '%s%s'", field, operator);
+        } else if (g_ascii_strcasecmp(field, "tag") == 0 && (operator[0] == ':' || cmp == QUERY_CMP_EQ)) {
+            const gchar *name = parser->text[0] == '#' ? parser->text + 1 : parser->text;
+            node = query_node_new(QUERY_NODE_PREDICATE);
+            node->predicate.op = QUERY_OP_TAG;
+            node->predicate.arg = query_add_string(parser->query, g_ascii_strdown(name, -1));
+        } else if (g_ascii_strcasecmp(field, "status") == 0 && (operator[0] == ':' || cmp == QUERY_CMP_EQ)) {
+            node = query_node_new(QUERY_NODE_PREDICATE);
+            node->predicate.op = QUERY_OP_STATUS;
+            node->predicate.arg = query_add_string(parser->query, g_strdup(parser->text));
+        } else if (g_ascii_strcasecmp(field, "text") == 0 && (operator[0] == ':' || operator[0] == '~')) {
+            node = query_text_node(parser, parser->text);
+        } else if (g_ascii_strcasecmp(field, "due") == 0 && operator[0] != '~') {
+            node = query_node_new(QUERY_NODE_PREDICATE);
+            node->predicate.op = QUERY_OP_DUE;
+            node->predicate.cmp = operator[0] == ':' ? QUERY_CMP_EQ : cmp;
+            if (!query_parse_date(parser->text, &node->predicate, error)) {
+                g_clear_pointer(&node, query_node_free);
+            }
+        } else if (g_ascii_strcasecmp(field, "prio") == 0 && operator[0] != '~') {
+            gchar *end;
+            gulong value = strtoul(parser->text, &end, 10);
+            if (*end != '\0' || !g_ascii_isdigit(parser->text[0]) || value > G_MAXUINT8) {
+                g_set_error(error, QUERY_ERROR, QUERY_ERROR_SYNTAX, "'%s' is not a priority", parser->text);
+            } else {
+                node = query_node_new(QUERY_NODE_PREDICATE);
+                node->predicate.op = QUERY_OP_PRIO;
+                node->predicate.cmp = operator[0] == ':' ? QUERY_CMP_EQ : cmp;
+                node->predicate.arg = value;
+            }
+        } else {
+            g_set_error(error, QUERY_ERROR, QUERY_ERROR_SYNTAX, "Unknown filter '%s%s'", field, operator);
+        }
+        g_free(operator);
+        if (node && !query_parser_next(parser, error)) {
+            g_clear_pointer(&node, query_node_free);
+        }
+    }
+
+    g_free(field);
+    return node;
+}
+
+/**
+ * @brief Parses a predicate, a negation or a parenthesized expression.
+ */
+static QueryNode *query_parse_unary(QueryParser *parser, GError **error) {
+    QueryNode *node;
+
+    switch (parser->type) {
+    case QUERY_TOKEN_NOT:
+        if (!query_parser_next(parser, error) || !(node = query_parse_unary(parser, error))) {
+            return NULL;
+        }
+        if (node->kind == QUERY_NODE_NOT) {
+            // Fold double negations.
+            QueryNode *inner = g_ptr_array_index(node->children, 0);
+            g_ptr_array_set_free_func(node->children, NULL);
+            query_node_free(node);
+            return inner;
+        }
+        QueryNode *not_node = query_node_new(QUERY_NODE_NOT);
+        g_ptr_array_add(not_node->children, node);
+        return not_node;
+    case QUERY_TOKEN_LPAREN:
+        if (!query_parser_next(parser, error) || !(node = query_parse_or(parser, error))) {
+            return NULL;
+        }
+        if (parser->type != QUERY_TOKEN_RPAREN) {
+            g_set_error(error, QUERY_ERROR, QUERY_ERROR_SYNTAX, "Missing ')'");
+            query_node_free(node);
+            return NULL;
+        }
+        if (!query_parser_next(parser, error)) {
+            query_node_free(node);
+            return NULL;
+        }
+        return node;
+    case QUERY_TOKEN_WORD:
+    case QUERY_TOKEN_STRING:
+        return query_parse_predicate(parser, error);
+    case QUERY_TOKEN_END:
+        g_set_error(error, QUERY_ERROR, QUERY_ERROR_SYNTAX, "Unexpected end of filter");
+        return NULL;
+    default:
+        g_set_error(error, QUERY_ERROR, QUERY_ERROR_SYNTAX, "Unexpected '%s'",
+                    parser->text ? parser->text : parser->type == QUERY_TOKEN_RPAREN ? ")" : "and/or");
+        return NULL;
+    }
+}
+
+/**
+ * @brief Parses a sequence of operands joined by one binary operator.
+ *
+ * @param kind QUERY_NODE_AND or QUERY_NODE_OR.
+ */
+static QueryNode *query_parse_chain(QueryParser *parser, QueryNodeKind kind, GError **error) {
+    QueryNode *node = NULL;
+    QueryNode *operand = kind == QUERY_NODE_OR ? query_parse_chain(parser, QUERY_NODE_AND, error)
+                                               : query_parse_unary(parser, error);
+
+    while (operand) {
+        if (!node) {
+            node = operand;
+        } else {
+            if (node->kind != kind) {
+                QueryNode *chain = query_node_new(kind);
+                g_ptr_array_add(chain->children, node);
+                node = chain;
+            }
+            // Flatten "(a and b) and c" into one chain.
+            if (operand->kind == kind) {
+                for (guint i = 0; i < operand->children->len; i++) {
+                    g_ptr_array_add(node->children, g_ptr_array_index(operand->children, i));
+                }
+                g_ptr_array_set_free_func(operand->children, NULL);
+                query_node_free(operand);
+            } else {
+                g_ptr_array_add(node->children, operand);
+            }
+        }
+
+        gboolean more;
+        if (kind == QUERY_NODE_OR) {
+            more = parser->type == QUERY_TOKEN_OR;
+        } else {
+            // Juxtaposed predicates are joined with "and".
+            more = parser->type == QUERY_TOKEN_AND || parser->type == QUERY_TOKEN_NOT ||
+                   parser->type == QUERY_TOKEN_LPAREN || parser->type == QUERY_TOKEN_WORD ||
+                   parser->type == QUERY_TOKEN_STRING;
+        }
+        if (!more) {
+            return node;
+        }
+        if (parser->type == QUERY_TOKEN_AND || parser->type == QUERY_TOKEN_OR) {
+            if (!query_parser_next(parser, error)) {
+                break;
+            }
+        }
+        operand = kind == QUERY_NODE_OR ? query_parse_chain(parser, QUERY_NODE_AND, error)
+                                        : query_parse_unary(parser, error);
+    }
+
+    if (node) {
+        query_node_free(node);
+    }
+    return NULL;
+}
+
+static QueryNode *query_parse_or(QueryParser *parser, GError **error) {
+    return query_parse_chain(parser, QUERY_NODE_OR, error);
+}
+
+/**
+ * @brief Estimates the cost of evaluating a node for one task.
+ */
+static guint query_node_cost(const QueryNode *node) {
+    guint cost = 0;
+
+    if (node->kind == QUERY_NODE_PREDICATE) {
+        switch (node->predicate.op) {
+        case QUERY_OP_TAG:
+            return 4;
+        case QUERY_OP_TEXT:
+            return 32;
+        default:
+            return 1;
+        }
+    }
+    for (guint i = 0; i < node->children->len; i++) {
+        cost += query_node_cost(g_ptr_array_index(node->children, i));
+    }
+    return cost;
+}
+
+static gint query_node_compare_cost(gconstpointer a, gconstpointer b) {
+    guint cost_a = query_node_cost(*(QueryNode *const *)a);
+    guint cost_b = query_node_cost(*(QueryNode *const *)b);
+    return (cost_a > cost_b) - (cost_a < cost_b);
+}
+
+/**
+ * @brief Emits the program for a node.
+ */
+static void query_compile_node(Query *query, QueryNode *node) {
+    QueryInstr instr = { 0 };
+
+    switch (node->kind) {
+    case QUERY_NODE_PREDICATE:
+        g_array_append_val(query->code, node->predicate);
+        break;
+    case QUERY_NODE_NOT:
+        query_compile_node(query, g_ptr_array_index(node->children, 0));
+        instr.op = QUERY_OP_NOT;
+        g_array_append_val(query->code, instr);
+        break;
+    case QUERY_NODE_AND:
+    case QUERY_NODE_OR: {
+        // Predicates have no side effects, so the cheapest can go first.
+        g_ptr_array_sort(node->children, query_node_compare_cost);
+
+        GArray *jumps = g_array_new(FALSE, FALSE, sizeof(guint));
+        for (guint i = 0; i < node->children->len; i++) {
+            query_compile_node(query, g_ptr_array_index(node->children, i));
+            if (i + 1 < node->children->len) {
+                instr.op = node->kind == QUERY_NODE_AND ? QUERY_OP_JUMP_IF_FALSE : QUERY_OP_JUMP_IF_TRUE;
+                g_array_append_val(jumps, query->code->len);
+                g_array_append_val(query->code, instr);
+            }
+        }
+        // Every early exit lands after the last operand, with the register set.
+        for (guint i = 0; i < jumps->len; i++) {
+            g_array_index(query->code, QueryInstr, g_array_index(jumps, guint, i)).arg = query->code->len;
+        }
+        g_array_free(jumps, TRUE);
+        break;
+    }
+    }
+}
+
+/**
+ * @brief Frees a compiled query.
+ */
+static void query_free(Query *query) {
+    g_free(query->source);
+    g_array_free(query->code, TRUE);
+    g_ptr_array_unref(query->strings);
+    g_array_free(query->required_tags, TRUE);
+    g_free(query);
+}
+
+/**
+ * @brief Parses and compiles a query.
+ *
+ * @param source The query text. An empty query matches every task.
+ * @param error Return location for a QUERY_ERROR.
+ * @return A newly allocated Query, or NULL with @error set.
+ */
+static Query *query_compile(const gchar *source, GError **error) {
+    Query *query = g_new0(Query, 1);
+    QueryParser parser = { source, QUERY_TOKEN_END, NULL, query };
+    QueryNode *root = NULL;
+
+    query->source = g_strdup(source);
+    query->code = g_array_new(FALSE, FALSE, sizeof(QueryInstr));
+    query->strings = g_ptr_array_new_with_free_func(g_free);
+    query->required_tags = g_array_new(FALSE, FALSE, sizeof(gint32));
+
+    if (!query_parser_next(&parser, error)) {
+        query_free(query);
+        return NULL;
+    }
+    if (parser.type != QUERY_TOKEN_END) {
+        root = query_parse_or(&parser, error);
+        if (root && parser.type != QUERY_TOKEN_END) {
+            g_set_error(error, QUERY_ERROR, QUERY_ERROR_SYNTAX, "Unexpected '%s'",
+                        parser.text ? parser.text : ")");
+            g_clear_pointer(&root, query_node_free);
+        }
+        g_free(parser.text);
+        if (!root) {
+            query_free(query);
+            return NULL;
+        }
+    }
+
+    if (root) {
+        // Tags in the top-level conjunction must be present on every match,
+        // so a tag nobody carries empties the result without a scan.
+        guint n_terms = root->kind == QUERY_NODE_AND ? root->children->len : 1;
+        for (guint i = 0; i < n_terms; i++) {
+            QueryNode *term = root->kind == QUERY_NODE_AND ? g_ptr_array_index(root->children, i) : root;
+            if (term->kind == QUERY_NODE_PREDICATE && term->predicate.op == QUERY_OP_TAG) {
+                g_array_append_val(query->required_tags, term->predicate.arg);
+            }
+        }
+        query_compile_node(query, root);
+        query_node_free(root);
+    }
+    for (guint i = 0; i < query->code->len; i++) {
+        query->relative |= g_array_index(query->code, QueryInstr, i).relative;
+    }
+    return query;
+}
+
+/**
+ * @brief Returns the julian day of the local date.
+ */
+static gint32 query_today(void) {
+    GDate date;
+
+    g_date_clear(&date, 1);
+    g_date_set_time_t(&date, time(NULL));
+    return g_date_get_julian(&date);
+}
+
+/**
+ * @brief Resolves the parts of a query that depend on the store and the date.
+ */
+static void query_context_init(QueryContext *context, const Query *query, TaskStore *store) {
+    context->today = query_today();
+    context->tag_sets = g_new0(GHashTable *, query->strings->len + 1);
+    context->statuses = g_new0(gint, query->strings->len + 1);
+    for (guint i = 0; i < query->code->len; i++) {
+        const QueryInstr *instr = &g_array_index(query->code, QueryInstr, i);
+        if (instr->op == QUERY_OP_TAG) {
+            context->tag_sets[instr->arg] = g_hash_table_lookup(store->tag_index,
+                                                                g_ptr_array_index(query->strings, instr->arg));
+        } else if (instr->op == QUERY_OP_STATUS) {
+            context->statuses[instr->arg] = task_store_find_status(store, g_ptr_array_index(query->strings, instr->arg));
+        }
+    }
+}
+
+static void query_context_clear(QueryContext *context) {
+    g_free(context->tag_sets);
+    g_free(context->statuses);
+}
+
+/**
+ * @brief Case-insensitive substring search.
+ *
+ * When both texts are ASCII, folding is just ASCII case, so only the
+ * positions holding either case of the needle's first byte are compared.
+ * Otherwise the text is folded once, since folding can change its length
+ * ("Straße" folds to "strasse").
+ *
+ * @param haystack The task text.
+ * @param needle A case-folded search text.
+ */
+static gboolean query_text_contains(const gchar *haystack, const gchar *needle) {
+    gsize needle_length = strlen(needle);
+    gboolean found;
+
+    if (needle_length == 0) {
+        return TRUE;
+    }
+    if (g_str_is_ascii(needle) && g_str_is_ascii(haystack)) {
+        const gchar first[3] = { g_ascii_tolower(needle[0]), g_ascii_toupper(needle[0]), '\0' };
+        for (const gchar *p = haystack; (p = strpbrk(p, first)) != NULL; p++) {
+            if (g_ascii_strncasecmp(p, needle, needle_length) == 0) {
+                return TRUE;
+            }
+        }
+        return FALSE;
+    }
+
+    gchar *folded = g_utf8_casefold(haystack, -1);
+    found = strstr(folded, needle) != NULL;
+    g_free(folded);
+    return found;
+}
+
+static inline gboolean query_compare(gint32 value, QueryCompare cmp, gint32 operand) {
+    switch (cmp) {
+    case QUERY_CMP_LT:
+        return value < operand;
+    case QUERY_CMP_LE:
+        return value <= operand;
+    case QUERY_CMP_GT:
+        return value > operand;
+    case QUERY_CMP_GE:
+        return value >= operand;
+    case QUERY_CMP_EQ:
+        return value == operand;
+    case QUERY_CMP_NE:
+        return value != operand;
+    default:
+        return TRUE;
+    }
+}
+
+/**
+ * @brief Runs a compiled query against one task.
+ *
+ * @param query The query.
+ * @param context The context from query_context_init().
+ * @param task The task to test.
+ * @return TRUE if the task matches.
+ */
+static inline gboolean query_match(const Query *query, const QueryContext *context, const Task *task) {
+    const QueryInstr *code = (const QueryInstr *)query->code->data;
+    guint n_code = query->code->len;
+    gboolean result = TRUE;
+
+    for (guint pc = 0; pc < n_code; pc++) {
+        const QueryInstr *instr = &code[pc];
+        switch (instr->op) {
+        case QUERY_OP_DONE:
+            result = task->is_completed;
+            break;
+        case QUERY_OP_TAG:
+            result = context->tag_sets[instr->arg] && g_hash_table_contains(context->tag_sets[instr->arg], task);
+            break;
+        case QUERY_OP_TEXT:
+            result = query_text_contains(task->text, g_ptr_array_index(query->strings, instr->arg));
+            break;
+        case QUERY_OP_DUE:
+            result = task->due != 0 &&
+                     query_compare(task->due, instr->cmp, instr->relative ? context->today + instr->arg : instr->arg);
+            break;
+        case QUERY_OP_PRIO:
+            result = query_compare(task->priority, instr->cmp, instr->arg);
+            break;
+        case QUERY_OP_STATUS:
+            result = task->status == context->statuses[instr->arg];
+            break;
+        case QUERY_OP_NOT:
+            result = !result;
+            break;
+        case QUERY_OP_JUMP_IF_FALSE:
+            if (!result) {
+                pc = instr->arg - 1;
+            }
+            break;
+        case QUERY_OP_JUMP_IF_TRUE:
+            if (result) {
+                pc = instr->arg - 1;
+            }
+            break;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Turns a due, priority or status predicate into an inclusive range
+ * of column values.
+ *
+ * @param low Return location for the lowest matching value.
+ * @param high Return location for the highest; below @low if none match.
+ * @param invert Return location for TRUE if the tasks outside the range match.
+ * @return FALSE if the predicate is not a single range.
+ */
+static gboolean query_instr_range(const QueryInstr *instr, const QueryContext *context, gint64 *low,
+                                  gint64 *high, gboolean *invert) {
+    gint64 operand = instr->relative ? context->today + instr->arg : instr->arg;
+    // Tasks without a due date hold 0 there and never match.
+    gint64 min = instr->op == QUERY_OP_DUE ? 1 : 0;
+    gint64 max = instr->op == QUERY_OP_DUE ? G_MAXUINT32 : G_MAXUINT8;
+
+    *invert = FALSE;
+    if (instr->op == QUERY_OP_STATUS) {
+        operand = context->statuses[instr->arg];
+        *low = operand < 0 ? 1 : operand;
+        *high = operand < 0 ? 0 : operand;
+        return TRUE;
+    }
+
+    *low = min;
+    *high = max;
+    switch (instr->cmp) {
+    case QUERY_CMP_LT:
+        *high = operand - 1;
+        break;
+    case QUERY_CMP_LE:
+        *high = operand;
+        break;
+    case QUERY_CMP_GT:
+        *low = operand + 1;
+        break;
+    case QUERY_CMP_GE:
+        *low = operand;
+        break;
+    case QUERY_CMP_EQ:
+        *low = *high = operand;
+        break;
+    case QUERY_CMP_NE:
+        if (instr->op == QUERY_OP_DUE) {
+            // Would match the tasks without a due date too.
+            return FALSE;
+        }
+        *low = *high = operand;
+        *invert = TRUE;
+        break;
+    default:
+        break;
+    }
+    *low = MAX(*low, min);
+    *high = MIN(*high, max);
+    return TRUE;
+}
+
+/**
+ * @brief Sets a bit in @bits for every task whose value in the column read
+ * by @op lies in [@low, @high].
+ *
+ * Each word is filled by a fixed run of 64 compares over one array, which
+ * the compiler turns into vector compares. The columns' capacity is a
+ * multiple of 64, so the last run may read past the end; those bits are
+ * cleared.
+ */
+static void task_columns_match(const TaskColumns *columns, QueryOpcode op, gint64 low, gint64 high, guint64 *bits) {
+    guint n_words = (columns->length + COLUMN_WORD_BITS - 1) / COLUMN_WORD_BITS;
+    guint32 base_value = low;
+    guint32 span = high - low;
+
+    if (low > high) {
+        memset(bits, 0, n_words * sizeof(guint64));
+        return;
+    }
+    for (guint w = 0; w < n_words; w++) {
+        guint base = w * COLUMN_WORD_BITS;
+        guint64 word = 0;
+
+        // One unsigned compare tests both ends of the range.
+        if (op == QUERY_OP_DUE) {
+            for (guint j = 0; j < COLUMN_WORD_BITS; j++) {
+                word |= (guint64)((guint32)(columns->due[base + j] - base_value) <= span) << j;
+            }
+        } else {
+            const guint8 *values = op == QUERY_OP_PRIO ? columns->priority : columns->status;
+            for (guint j = 0; j < COLUMN_WORD_BITS; j++) {
+                word |= (guint64)((guint32)(values[base + j] - base_value) <= span) << j;
+            }
+        }
+        bits[w] = word;
+    }
+    if (columns->length % COLUMN_WORD_BITS != 0) {
+        bits[n_words - 1] &= column_bits_below(columns->length);
+    }
+}
+
+/**
+ * @brief Runs a query over the store's columns instead of its tasks.
+ *
+ * Works for conjunctions of done, due, priority and status predicates,
+ * each possibly negated, such as "!done and due<7d and prio>=2". Every
+ * predicate is one pass over a column that narrows a bitmap of matches,
+ * and the positions are read off the bitmap at the end.
+ *
+ * @return FALSE, leaving @positions alone, for any other query.
+ */
+static gboolean query_run_columns(const Query *query, const QueryContext *context, TaskStore *store,
+                                  GArray *positions) {
+    const QueryInstr *code = (const QueryInstr *)query->code->data;
+    const TaskColumns *columns = &store->columns;
+    guint n_code = query->code->len;
+    guint n_words = (columns->length + COLUMN_WORD_BITS - 1) / COLUMN_WORD_BITS;
+    guint64 tail = columns->length % COLUMN_WORD_BITS ? column_bits_below(columns->length) : G_MAXUINT64;
+
+    if (n_code == 0 || columns->length != store->tasks->len) {
+        return FALSE;
+    }
+    // The program must read "term (JUMP_IF_FALSE term)*", each term a
+    // column predicate, optionally followed by NOT, and every jump exiting.
+    for (guint pc = 0; pc < n_code; pc++) {
+        guint8 op = code[pc].op;
+        gint64 low, high;
+        gboolean invert;
+        if (op != QUERY_OP_DONE && !((op == QUERY_OP_DUE || op == QUERY_OP_PRIO || op == QUERY_OP_STATUS) &&
+                                     query_instr_range(&code[pc], context, &low, &high, &invert))) {
+            return FALSE;
+        }
+        if (pc + 1 < n_code && code[pc + 1].op == QUERY_OP_NOT) {
+            pc++;
+        }
+        if (pc + 1 < n_code && (code[++pc].op != QUERY_OP_JUMP_IF_FALSE || code[pc].arg != (gint32)n_code)) {
+            return FALSE;
+        }
+    }
+
+    guint64 *bits = g_new(guint64, n_words);
+    guint64 *term = g_new(guint64, n_words);
+    guint n_matches = 0;
+
+    for (guint w = 0; w < n_words; w++) {
+        bits[w] = w + 1 < n_words ? G_MAXUINT64 : tail;
+    }
+    for (guint pc = 0; pc < n_code; pc += 2) {
+        gboolean negate = FALSE;
+        gint64 low, high;
+
+        if (code[pc].op == QUERY_OP_DONE) {
+            memcpy(term, columns->done, n_words * sizeof(guint64));
+        } else {
+            query_instr_range(&code[pc], context, &low, &high, &negate);
+            task_columns_match(columns, code[pc].op, low, high, term);
+        }
+        if (pc + 1 < n_code && code[pc + 1].op == QUERY_OP_NOT) {
+            negate = !negate;
+            pc++;
+        }
+        for (guint w = 0; w < n_words; w++) {
+            bits[w] &= negate ? ~term[w] : term[w];
+        }
+    }
+
+    for (guint w = 0; w < n_words; w++) {
+        n_matches += __builtin_popcountll(bits[w]);
+    }
+    g_array_set_size(positions, n_matches);
+    guint *out = (guint *)positions->data;
+    for (guint w = 0; w < n_words; w++) {
+        for (guint64 word = bits[w]; word != 0; word &= word - 1) {
+            *out++ = w * COLUMN_WORD_BITS + __builtin_ctzll(word);
+        }
+    }
+
+    g_free(term);
+    g_free(bits);
+    return TRUE;
+}
+
+/**
+ * @brief Collects the positions of the tasks matching a query.
+ *
+ * @param query The query.
+ * @param store The task store.
+ * @param positions A GArray of guint that receives the positions, in order.
+ */
+static void query_run(const Query *query, TaskStore *store, GArray *positions) {
+    Task **tasks = (Task **)store->tasks->pdata;
+    guint length = store->tasks->len;
+    gint64 start_time = g_get_monotonic_time();
+    QueryContext context;
+
+    guint *out;
+    guint n_matches = 0;
+
+    query_context_init(&context, query, store);
+    for (guint i = 0; i < query->required_tags->len; i++) {
+        if (!context.tag_sets[g_array_index(query->required_tags, gint32, i)]) {
+            length = 0;
+        }
+    }
+
+    if (length == 0 || !query_run_columns(query, &context, store, positions)) {
+        // Size for the worst case up front so the loop is a plain store.
+        g_array_set_size(positions, length);
+        out = (guint *)positions->data;
+        for (guint i = 0; i < length; i++) {
+            out[n_matches] = i;
+            n_matches += query_match(query, &context, tasks[i]);
+        }
+        g_array_set_size(positions, n_matches);
+    }
+
+    query_context_clear(&context);
+    g_debug("Filter '%s' matched %u of %u tasks in %" G_GINT64_FORMAT " us.",
+            query->source, positions->len, store->tasks->len, g_get_monotonic_time() - start_time);
+}
+
+/**
+ * @brief A run of a list's items replaced by a commit: @removed items at
+ * @index gave way to @added others. When a commit changes several runs,
+ * they come in item order, and each @index counts the runs before it as
+ * already replaced.
+ */
+typedef struct {
+    guint index;
+    guint removed;
+    guint added;
+} ItemsChange;
+
+/**
+ * @brief The materialized result of a query over a store.
+ *
+ * The result listens to the store ahead of the views and is updated in
+ * place on every commit: only the tasks inside the changed range are
+ * tested against the query, and the positions after it are shifted.
+ */
+typedef struct {
+    Query *query;
+    TaskStore *store;
+    GArray *positions;           // Sorted store positions of the matching tasks.
+    gint32 day;                  // The day relative dates were resolved against.
+    ItemsChange change;          // What the last commit did to the positions.
+} QueryResult;
+
+/**
+ * @brief Returns the index of the first entry of a sorted position array
+ * that is not less than @position.
+ */
+static guint positions_lower_bound(GArray *positions, guint position) {
+    guint low = 0, high = positions->len;
+
+    while (low < high) {
+        guint middle = low + (high - low) / 2;
+        if (g_array_index(positions, guint, middle) < position) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Re-runs the query over the whole store.
+ */
+static void query_result_refresh(QueryResult *result) {
+    guint old_length = result->positions->len;
+
+    result->day = query_today();
+    query_run(result->query, result->store, result->positions);
+    result->change = (ItemsChange){ 0, old_length, result->positions->len };
+}
+
+/**
+ * @brief Store listener that keeps a result up to date.
+ */
+static void query_result_store_changed(TaskStore *store, guint position, guint removed, guint added,
+                                       gpointer user_data) {
+    QueryResult *result = user_data;
+    GArray *positions = result->positions;
+    GArray *matches;
+    QueryContext context;
+
+    if (result->query->relative && query_today() != result->day) {
+        // Relative dates have moved on since the result was built.
+        query_result_refresh(result);
+        return;
+    }
+
+    guint low = positions_lower_bound(positions, position);
+    guint high = positions_lower_bound(positions, position + removed);
+    gint delta = (gint)added - (gint)removed;
+
+    // Only the tasks that entered the range need testing.
+    matches = g_array_new(FALSE, FALSE, sizeof(guint));
+    query_context_init(&context, result->query, store);
+    for (guint i = position; i < position + added; i++) {
+        if (query_match(result->query, &context, task_store_get(store, i))) {
+            g_array_append_val(matches, i);
+        }
+    }
+    query_context_clear(&context);
+
+    g_array_remove_range(positions, low, high - low);
+    g_array_insert_vals(positions, low, matches->data, matches->len);
+    if (delta != 0) {
+        guint *data = (guint *)positions->data;
+        for (guint i = low + matches->len; i < positions->len; i++) {
+            data[i] += delta;
+        }
+    }
+    result->change = (ItemsChange){ low, high - low, matches->len };
+    g_array_free(matches, TRUE);
+}
+
+/**
+ * @brief Materializes a query over a store.
+ *
+ * @param store The task store.
+ * @param query The query. The result takes ownership.
+ * @return A new QueryResult, kept up to date until query_result_free().
+ */
+static QueryResult *query_result_new(TaskStore *store, Query *query) {
+    QueryResult *result = g_new0(QueryResult, 1);
+
+    result->query = query;
+    result->store = store;
+    result->positions = g_array_new(FALSE, FALSE, sizeof(guint));
+    query_result_refresh(result);
+    task_store_prepend_listener(store, query_result_store_changed, result);
+    return result;
+}
+
+static void query_result_free(QueryResult *result) {
+    task_store_remove_listener(result->store, result);
+    query_free(result->query);
+    g_array_free(result->positions, TRUE);
+    g_free(result);
+}
+
+// --- Task Groups ---
+
+/*
+ * The list can show its tasks grouped, each group under a header. Groups
+ * form a run-length index over the grouped order: every group holds the
+ * sorted store positions of its tasks, and the index of its header among
+ * the view's items. Items are the headers plus the tasks of the expanded
+ * groups, so mapping an item to its task is a binary search over the
+ * groups, never a comparison of neighbouring rows. A commit only moves the
+ * positions it touched between groups, and collapsing a group changes one
+ * flag and the header indices after it.
+ */
+
+typedef enum {
+    TASK_GROUP_NONE,
+    TASK_GROUP_PROJECT,          // The first "+name" of the text.
+    TASK_GROUP_DUE,              // How far off the due date is.
+    TASK_GROUP_COMPLETION,
+} TaskGroupBy;
+
+// Header names of the due-date buckets, in order.
+static const gchar *const task_group_due_names[] = {
+    "Overdue", "Today", "Next 7 Days", "Later", "No Due Date",
+};
+
+/**
+ * @brief One group of the list.
+ */
+typedef struct {
+    guint rank;                  // Orders the groups; ties are broken by name.
+    gchar *name;                 // Shown in the header.
+    GArray *positions;           // Sorted store positions of the group's shown tasks.
+    guint first_item;            // Index of the group's header among the view's items.
+    gboolean collapsed;
+} TaskGroup;
+
+/**
+ * @brief The groups of a list, kept up to date with the store by the view.
+ */
+typedef struct {
+    TaskGroupBy by;
+    GPtrArray *groups;           // The non-empty TaskGroups, in display order.
+    GHashTable *collapsed;       // Names of collapsed groups, remembered while a group is empty.
+    guint n_items;               // Headers plus the tasks of the expanded groups.
+    gint32 day;                  // The day due-date buckets were computed for.
+} TaskGroups;
+
+static gchar *extract_project(const gchar *text);
+
+static void task_group_free(gpointer data) {
+    TaskGroup *group = data;
+    g_free(group->name);
+    g_array_free(group->positions, TRUE);
+    g_free(group);
+}
+
+/**
+ * @brief Works out which group a task belongs to.
+ *
+ * @param rank Return location for the group's rank.
+ * @return The group's name, newly allocated.
+ */
+static gchar *task_groups_classify(TaskGroups *groups, const Task *task, guint *rank) {
+    gchar *project;
+
+    switch (groups->by) {
+    case TASK_GROUP_PROJECT:
+        project = extract_project(task->text);
+        // Tasks without a project come last.
+        *rank = project ? 0 : 1;
+        return project ? project : g_strdup("No Project");
+    case TASK_GROUP_DUE:
+        if (task->due == 0) {
+            *rank = 4;
+        } else if ((gint32)task->due < groups->day) {
+            *rank = 0;
+        } else if ((gint32)task->due == groups->day) {
+            *rank = 1;
+        } else if ((gint32)task->due <= groups->day + 7) {
+            *rank = 2;
+        } else {
+            *rank = 3;
+        }
+        return g_strdup(task_group_due_names[*rank]);
+    default:
+        *rank = task->is_completed;
+        return g_strdup(task->is_completed ? "Done" : "To Do");
+    }
+}
+
+/**
+ * @brief Finds a group by rank and name.
+ *
+ * @param index Return location for the group's index, or where it would go.
+ * @return TRUE if the group exists.
+ */
+static gboolean task_groups_find(TaskGroups *groups, guint rank, const gchar *name, guint *index) {
+    guint low = 0, high = groups->groups->len;
+
+    while (low < high) {
+        guint middle = low + (high - low) / 2;
+        TaskGroup *group = g_ptr_array_index(groups->groups, middle);
+        gint order = group->rank != rank ? (group->rank < rank ? -1 : 1) : strcmp(group->name, name);
+        if (order == 0) {
+            *index = middle;
+            return TRUE;
+        }
+        if (order < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    *index = low;
+    return FALSE;
+}
+
+/**
+ * @brief Adds the task at @position to its group, creating the group if
+ * needed. Call task_groups_reindex() afterwards.
+ */
+static void task_groups_add(TaskGroups *groups, TaskStore *store, guint position) {
+    guint rank, index;
+    gchar *name = task_groups_classify(groups, task_store_get(store, position), &rank);
+    TaskGroup *group;
+
+    if (task_groups_find(groups, rank, name, &index)) {
+        group = g_ptr_array_index(groups->groups, index);
+        g_free(name);
+    } else {
+        group = g_new0(TaskGroup, 1);
+        group->rank = rank;
+        group->name = name;
+        group->positions = g_array_new(FALSE, FALSE, sizeof(guint));
+        group->collapsed = g_hash_table_contains(groups->collapsed, name);
+        g_ptr_array_insert(groups->groups, index, group);
+    }
+    // Positions mostly arrive in order, so check the end first.
+    GArray *positions = group->positions;
+    if (positions->len == 0 || g_array_index(positions, guint, positions->len - 1) < position) {
+        g_array_append_val(positions, position);
+    } else {
+        g_array_insert_val(positions, positions_lower_bound(positions, position), position);
+    }
+}
+
+/**
+ * @brief Recomputes where each group's header is among the items.
+ */
+static void task_groups_reindex(TaskGroups *groups) {
+    guint item = 0;
+
+    for (guint i = 0; i < groups->groups->len; i++) {
+        TaskGroup *group = g_ptr_array_index(groups->groups, i);
+        group->first_item = item;
+        item += 1 + (group->collapsed ? 0 : group->positions->len);
+    }
+    groups->n_items = item;
+}
+
+/**
+ * @brief Regroups every shown task.
+ *
+ * @param filter The view's filter, or NULL if it shows every task.
+ */
+static void task_groups_rebuild(TaskGroups *groups, TaskStore *store, QueryResult *filter) {
+    guint length = filter ? filter->positions->len : store->tasks->len;
+
+    g_ptr_array_set_size(groups->groups, 0);
+    groups->day = query_today();
+    for (guint i = 0; i < length; i++) {
+        task_groups_add(groups, store, filter ? g_array_index(filter->positions, guint, i) : i);
+    }
+    task_groups_reindex(groups);
+}
+
+/**
+ * @brief What a commit did to one of the groups there were before it.
+ */
+typedef struct {
+    TaskGroup *group;            // NULL if the commit emptied it.
+    guint low;                   // Offset of the changed range in its tasks.
+    guint removed;               // Tasks that left the range.
+    guint n_items;               // Items it had: its header and its shown tasks.
+} TaskGroupChange;
+
+/**
+ * @brief Appends to @changes the items a commit replaced, one run per
+ * group it touched, going down the old and new groups together.
+ */
+static void task_groups_list_changes(TaskGroups *groups, GArray *old, guint position, guint added,
+                                     GArray *changes) {
+    guint item = 0;
+    guint i = 0;
+
+    for (guint j = 0; j <= groups->groups->len; j++) {
+        // Emptied groups leave where they were, before the next group.
+        for (; i < old->len && !g_array_index(old, TaskGroupChange, i).group; i++) {
+            guint n_items = g_array_index(old, TaskGroupChange, i).n_items;
+            g_array_append_val(changes, ((ItemsChange){ item, n_items, 0 }));
+        }
+        if (j == groups->groups->len) {
+            break;
+        }
+
+        TaskGroup *group = g_ptr_array_index(groups->groups, j);
+        guint n_items = 1 + (group->collapsed ? 0 : group->positions->len);
+        if (i < old->len && g_array_index(old, TaskGroupChange, i).group == group) {
+            TaskGroupChange *change = &g_array_index(old, TaskGroupChange, i++);
+            guint high = positions_lower_bound(group->positions, position + added);
+            if (!group->collapsed && (change->removed > 0 || high > change->low)) {
+                g_array_append_val(changes, ((ItemsChange){ item + 1 + change->low, change->removed,
+                                                            high - change->low }));
+            }
+        } else {
+            g_array_append_val(changes, ((ItemsChange){ item, 0, n_items }));
+        }
+        item += n_items;
+    }
+}
+
+/**
+ * @brief Patches the groups for a committed transaction. The positions in
+ * the changed range leave their groups, the ones after it are shifted,
+ * and the tasks now shown in the range are added to theirs.
+ *
+ * @param changes Array of ItemsChange the replaced items are appended to.
+ */
+static void task_groups_store_changed(TaskGroups *groups, TaskStore *store, QueryResult *filter,
+                                      guint position, guint removed, guint added, GArray *changes) {
+    gint delta = (gint)added - (gint)removed;
+    guint old_n_items = groups->n_items;
+
+    if (groups->by == TASK_GROUP_DUE && query_today() != groups->day) {
+        // The buckets have moved on since the groups were built.
+        task_groups_rebuild(groups, store, filter);
+        g_array_append_val(changes, ((ItemsChange){ 0, old_n_items, groups->n_items }));
+        return;
+    }
+
+    GArray *old = g_array_sized_new(FALSE, FALSE, sizeof(TaskGroupChange), groups->groups->len);
+    g_array_set_size(old, groups->groups->len);
+    for (guint i = groups->groups->len; i-- > 0; ) {
+        TaskGroup *group = g_ptr_array_index(groups->groups, i);
+        GArray *positions = group->positions;
+        guint low = positions_lower_bound(positions, position);
+        guint high = positions_lower_bound(positions, position + removed);
+
+        g_array_index(old, TaskGroupChange, i) = (TaskGroupChange){
+            group, low, high - low, 1 + (group->collapsed ? 0 : positions->len),
+        };
+        g_array_remove_range(positions, low, high - low);
+        if (delta != 0) {
+            guint *data = (guint *)positions->data;
+            for (guint j = low; j < positions->len; j++) {
+                data[j] += delta;
+            }
+        }
+        if (positions->len == 0) {
+            g_array_index(old, TaskGroupChange, i).group = NULL;
+            g_ptr_array_remove_index(groups->groups, i);
+        }
+    }
+
+    if (filter) {
+        guint low = positions_lower_bound(filter->positions, position);
+        guint high = positions_lower_bound(filter->positions, position + added);
+        for (guint i = low; i < high; i++) {
+            task_groups_add(groups, store, g_array_index(filter->positions, guint, i));
+        }
+    } else {
+        for (guint i = position; i < position + added; i++) {
+            task_groups_add(groups, store, i);
+        }
+    }
+    task_groups_reindex(groups);
+    task_groups_list_changes(groups, old, position, added, changes);
+    g_array_free(old, TRUE);
+}
+
+/**
+ * @brief Maps an item to its group and task.
+ *
+ * @param group Return location for the item's group.
+ * @return The store position of the item's task, or G_MAXUINT for a header.
+ */
+static guint task_groups_get_item(TaskGroups *groups, guint index, TaskGroup **group) {
+    guint low = 0, high = groups->groups->len;
+
+    // The last group whose header is not after the item.
+    while (high - low > 1) {
+        guint middle = low + (high - low) / 2;
+        if (((TaskGroup *)g_ptr_array_index(groups->groups, middle))->first_item <= index) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    *group = g_ptr_array_index(groups->groups, low);
+    if (index == (*group)->first_item) {
+        return G_MAXUINT;
+    }
+    return g_array_index((*group)->positions, guint, index - (*group)->first_item - 1);
+}
+
+/**
+ * @brief Finds the item showing the task at @position.
+ *
+ * @return TRUE if the task is shown, FALSE if it is filtered out or its
+ * group is collapsed.
+ */
+static gboolean task_groups_find_item(TaskGroups *groups, TaskStore *store, guint position, guint *index) {
+    guint rank, group_index;
+    gchar *name = task_groups_classify(groups, task_store_get(store, position), &rank);
+    gboolean found = task_groups_find(groups, rank, name, &group_index);
+    TaskGroup *group;
+
+    g_free(name);
+    if (!found) {
+        return FALSE;
+    }
+    group = g_ptr_array_index(groups->groups, group_index);
+    guint offset = positions_lower_bound(group->positions, position);
+    if (group->collapsed || offset >= group->positions->len ||
+        g_array_index(group->positions, guint, offset) != position) {
+        return FALSE;
+    }
+    *index = group->first_item + 1 + offset;
+    return TRUE;
+}
+
+/**
+ * @brief Collapses or expands a group. Its tasks stay in the group; only
+ * the header indices after it move.
+ */
+static void task_groups_set_collapsed(TaskGroups *groups, TaskGroup *group, gboolean collapsed) {
+    group->collapsed = collapsed;
+    if (collapsed) {
+        g_hash_table_add(groups->collapsed, g_strdup(group->name));
+    } else {
+        g_hash_table_remove(groups->collapsed, group->name);
+    }
+    task_groups_reindex(groups);
+}
+
+static TaskGroups *task_groups_new(TaskGroupBy by) {
+    TaskGroups *groups = g_new0(TaskGroups, 1);
+
+    groups->by = by;
+    groups->groups = g_ptr_array_new_with_free_func(task_group_free);
+    groups->collapsed = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    return groups;
+}
+
+static void task_groups_free(TaskGroups *groups) {
+    g_ptr_array_unref(groups->groups);
+    g_hash_table_unref(groups->collapsed);
+    g_free(groups);
+}
+
+// --- Task Spans ---
+
+/*
+ * A task with a start or due date spans the days from one to the other (a
+ * single day if it has only one of them). The span index keeps those spans
+ * in an interval tree, a treap ordered by first day in which every node
+ * also records the latest end below it, so the spans overlapping any range
+ * of days are found in O(log n + k). Each span also has a lane, the row of
+ * the timeline it is drawn in: spans start out packed into as few lanes as
+ * possible, and a span whose dates change moves to the lowest lane free
+ * over its new days while every other span stays put, so an edit only
+ * changes what is drawn where that span was and where it is now. Once
+ * removals have left more than half of the lanes empty, everything is
+ * packed again.
+ */
+
+typedef struct _TaskSpan TaskSpan;
+
+struct _TaskSpan {
+    Task *task;              // Valid until the store's next commit reaches the index.
+    guint id;
+    gint32 begin;            // First day, as a julian day.
+    gint32 end;              // The day after the last day.
+    guint lane;
+    guint32 priority;        // Random heap priority for the treap.
+    gint32 max_end;          // The latest end in this subtree.
+    TaskSpan *left;
+    TaskSpan *right;
+};
+
+/**
+ * @brief The days and lane of a span, as it was or is now.
+ */
+typedef struct {
+    gint32 begin;
+    gint32 end;
+    guint lane;
+} SpanRect;
+
+/**
+ * @brief The spans of the tasks in a store, kept up to date on every commit.
+ */
+typedef struct {
+    TaskStore *store;
+    GPtrArray *spans;        // Every TaskSpan, by task id and so in store order.
+    TaskSpan *root;          // The interval tree.
+    GArray *lane_sizes;      // guint per lane: how many spans it holds.
+    GArray *dirty;           // SpanRects the last commit drew over, old and new.
+    gboolean repacked;       // The last commit moved every span.
+    GRand *rand;
+} SpanIndex;
+
+/**
+ * @brief Works out the days a task spans.
+ *
+ * @return FALSE if the task has neither a start nor a due date.
+ */
+static gboolean task_span_days(const Task *task, gint32 *begin, gint32 *end) {
+    guint32 first = task->start ? task->start : task->due;
+    guint32 last = task->due ? task->due : task->start;
+
+    if (!first) {
+        return FALSE;
+    }
+    *begin = MIN(first, last);
+    *end = MAX(first, last) + 1;
+    return TRUE;
+}
+
+static void span_update(TaskSpan *span) {
+    span->max_end = span->end;
+    if (span->left) {
+        span->max_end = MAX(span->max_end, span->left->max_end);
+    }
+    if (span->right) {
+        span->max_end = MAX(span->max_end, span->right->max_end);
+    }
+}
+
+/**
+ * @brief Orders spans by first day, then by id.
+ */
+static gint span_compare(const TaskSpan *a, const TaskSpan *b) {
+    if (a->begin != b->begin) {
+        return a->begin < b->begin ? -1 : 1;
+    }
+    return (a->id > b->id) - (a->id < b->id);
+}
+
+static TaskSpan *span_tree_insert(TaskSpan *node, TaskSpan *span) {
+    if (!node) {
+        span->left = span->right = NULL;
+        span_update(span);
+        return span;
+    }
+    if (span_compare(span, node) < 0) {
+        node->left = span_tree_insert(node->left, span);
+        if (node->left->priority > node->priority) {
+            TaskSpan *child = node->left;
+            node->left = child->right;
+            child->right = node;
+            span_update(node);
+            node = child;
+        }
+    } else {
+        node->right = span_tree_insert(node->right, span);
+        if (node->right->priority > node->priority) {
+            TaskSpan *child = node->right;
+            node->right = child->left;
+            child->left = node;
+            span_update(node);
+            node = child;
+        }
+    }
+    span_update(node);
+    return node;
+}
+
+/**
+ * @brief Joins two treaps whose keys are all less (@a) or greater (@b).
+ */
+static TaskSpan *span_tree_merge(TaskSpan *a, TaskSpan *b) {
+    if (!a || !b) {
+        return a ? a : b;
+    }
+    if (a->priority > b->priority) {
+        a->right = span_tree_merge(a->right, b);
+        span_update(a);
+        return a;
+    }
+    b->left = span_tree_merge(a, b->left);
+    span_update(b);
+    return b;
+}
+
+static TaskSpan *span_tree_remove(TaskSpan *node, TaskSpan *span) {
+    if (!node) {
+        return NULL;
+    }
+    if (node == span) {
+        return span_tree_merge(node->left, node->right);
+    }
+    if (span_compare(span, node) < 0) {
+        node->left = span_tree_remove(node->left, span);
+    } else {
+        node->right = span_tree_remove(node->right, span);
+    }
+    span_update(node);
+    return node;
+}
+
+/**
+ * @brief Collects the spans overlapping the days [@begin, @end).
+ */
+static void span_tree_query(TaskSpan *node, gint32 begin, gint32 end, GPtrArray *out) {
+    // Nothing below ends after the range starts.
+    while (node && node->max_end > begin) {
+        span_tree_query(node->left, begin, end, out);
+        if (node->begin >= end) {
+            // Neither does anything to the right start before it ends.
+            return;
+        }
+        if (node->end > begin) {
+            g_ptr_array_add(out, node);
+        }
+        node = node->right;
+    }
+}
+
+/**
+ * @brief Finds the spans overlapping a range of days.
+ *
+ * @param index The span index.
+ * @param begin The first day.
+ * @param end The day after the last day.
+ * @param out A GPtrArray that receives the TaskSpan pointers, in order of
+ * their first day.
+ */
+static void span_index_query(SpanIndex *index, gint32 begin, gint32 end, GPtrArray *out) {
+    g_ptr_array_set_size(out, 0);
+    span_tree_query(index->root, begin, end, out);
+}
+
+/**
+ * @brief Returns the number of lanes in use, counting any empty lanes
+ * below the highest one.
+ */
+static guint span_index_get_n_lanes(SpanIndex *index) {
+    return index->lane_sizes->len;
+}
+
+static void span_index_set_lane(SpanIndex *index, TaskSpan *span, guint lane) {
+    span->lane = lane;
+    if (lane >= index->lane_sizes->len) {
+        g_array_set_size(index->lane_sizes, lane + 1);
+    }
+    g_array_index(index->lane_sizes, guint, lane)++;
+}
+
+static void span_index_release_lane(SpanIndex *index, TaskSpan *span) {
+    GArray *sizes = index->lane_sizes;
+
+    g_array_index(sizes, guint, span->lane)--;
+    while (sizes->len > 0 && g_array_index(sizes, guint, sizes->len - 1) == 0) {
+        g_array_set_size(sizes, sizes->len - 1);
+    }
+}
+
+static void span_index_mark_dirty(SpanIndex *index, const TaskSpan *span) {
+    SpanRect rect = { span->begin, span->end, span->lane };
+    g_array_append_val(index->dirty, rect);
+}
+
+/**
+ * @brief Puts a span into the tree, in the lowest lane none of the spans
+ * overlapping it uses.
+ */
+static void span_index_place(SpanIndex *index, TaskSpan *span) {
+    GPtrArray *overlapping = g_ptr_array_new();
+    GArray *taken = g_array_new(FALSE, TRUE, sizeof(guint8));
+    guint lane = 0;
+
+    span_index_query(index, span->begin, span->end, overlapping);
+    g_array_set_size(taken, overlapping->len + 1);
+    for (guint i = 0; i < overlapping->len; i++) {
+        guint other = ((TaskSpan *)g_ptr_array_index(overlapping, i))->lane;
+        // With k overlapping spans, one of the lanes 0..k is always free.
+        if (other < taken->len) {
+            g_array_index(taken, guint8, other) = TRUE;
+        }
+    }
+    while (g_array_index(taken, guint8, lane)) {
+        lane++;
+    }
+    span_index_set_lane(index, span, lane);
+    span->priority = g_rand_int(index->rand);
+    index->root = span_tree_insert(index->root, span);
+
+    g_array_free(taken, TRUE);
+    g_ptr_array_free(overlapping, TRUE);
+}
+
+static void span_index_unplace(SpanIndex *index, TaskSpan *span) {
+    index->root = span_tree_remove(index->root, span);
+    span_index_release_lane(index, span);
+}
+
+/**
+ * @brief Orders span pointers by first day, then by end, for packing.
+ */
+static gint span_compare_for_packing(gconstpointer a, gconstpointer b) {
+    const TaskSpan *sa = *(TaskSpan *const *)a;
+    const TaskSpan *sb = *(TaskSpan *const *)b;
+    gint order = span_compare(sa, sb);
+
+    if (sa->begin == sb->begin && sa->end != sb->end) {
+        return sa->end < sb->end ? -1 : 1;
+    }
+    return order;
+}
+
+/**
+ * @brief Min-heap order of the lanes' ends during packing: a guint64 of
+ * end << 32 | lane, offset so that julian days stay positive.
+ */
+static void lane_heap_push(GArray *heap, guint64 value) {
+    guint i = heap->len;
+
+    g_array_append_val(heap, value);
+    while (i > 0 && g_array_index(heap, guint64, (i - 1) / 2) > value) {
+        g_array_index(heap, guint64, i) = g_array_index(heap, guint64, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    g_array_index(heap, guint64, i) = value;
+}
+
+static guint64 lane_heap_pop(GArray *heap) {
+    guint64 top = g_array_index(heap, guint64, 0);
+    guint64 last = g_array_index(heap, guint64, heap->len - 1);
+    guint i = 0;
+
+    g_array_set_size(heap, heap->len - 1);
+    while (heap->len > 0) {
+        guint child = 2 * i + 1;
+        if (child >= heap->len) {
+            break;
+        }
+        if (child + 1 < heap->len && g_array_index(heap, guint64, child + 1) < g_array_index(heap, guint64, child)) {
+            child++;
+        }
+        if (g_array_index(heap, guint64, child) >= last) {
+            break;
+        }
+        g_array_index(heap, guint64, i) = g_array_index(heap, guint64, child);
+        i = child;
+    }
+    if (heap->len > 0) {
+        g_array_index(heap, guint64, i) = last;
+    }
+    return top;
+}
+
+/**
+ * @brief Packs every span into as few lanes as possible and rebuilds the
+ * tree. Sweeping the spans by first day and reusing the lane that frees up
+ * earliest needs exactly as many lanes as the most spans over one day.
+ */
+static void span_index_pack(SpanIndex *index) {
+    GPtrArray *order = g_ptr_array_sized_new(index->spans->len);
+    GArray *free_lanes = g_array_new(FALSE, FALSE, sizeof(guint64));
+    GArray *busy_lanes = g_array_new(FALSE, FALSE, sizeof(guint64));
+
+    for (guint i = 0; i < index->spans->len; i++) {
+        g_ptr_array_add(order, g_ptr_array_index(index->spans, i));
+    }
+    g_ptr_array_sort(order, span_compare_for_packing);
+    g_array_set_size(index->lane_sizes, 0);
+    index->root = NULL;
+
+    for (guint i = 0; i < order->len; i++) {
+        TaskSpan *span = g_ptr_array_index(order, i);
+        guint lane;
+        // Lanes whose last span has ended become free, lowest lane first.
+        while (busy_lanes->len > 0 && (gint32)(g_array_index(busy_lanes, guint64, 0) >> 32) <= span->begin) {
+            lane_heap_push(free_lanes, (guint32)lane_heap_pop(busy_lanes));
+        }
+        lane = free_lanes->len > 0 ? (guint)lane_heap_pop(free_lanes) : index->lane_sizes->len;
+        span_index_set_lane(index, span, lane);
+        lane_heap_push(busy_lanes, ((guint64)(guint32)span->end << 32) | lane);
+        span->priority = g_rand_int(index->rand);
+        index->root = span_tree_insert(index->root, span);
+    }
+
+    g_array_free(busy_lanes, TRUE);
+    g_array_free(free_lanes, TRUE);
+    g_ptr_array_free(order, TRUE);
+}
+
+/**
+ * @brief Returns the index of the first span with an id of at least @id.
+ */
+static guint span_index_lower_bound(SpanIndex *index, guint id) {
+    guint low = 0, high = index->spans->len;
+
+    while (low < high) {
+        guint middle = low + (high - low) / 2;
+        if (((TaskSpan *)g_ptr_array_index(index->spans, middle))->id < id) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Store listener that keeps the index up to date. Every span the
+ * commit touched is recorded in the dirty list, both where it was and
+ * where it is now.
+ */
+static void span_index_store_changed(TaskStore *store, guint position, guint removed, guint added,
+                                     gpointer user_data) {
+    SpanIndex *index = user_data;
+    // The store is in id order and the tasks around the range are untouched,
+    // so the spans of the old range are those between its neighbours' ids.
+    guint low_id = position > 0 ? task_store_get(store, position - 1)->id : 0;
+    guint low = span_index_lower_bound(index, low_id + 1);
+    guint high = position + added < store->tasks->len
+                     ? span_index_lower_bound(index, task_store_get(store, position + added)->id)
+                     : index->spans->len;
+    GPtrArray *replacement = g_ptr_array_new();
+    guint next = low;
+
+    g_array_set_size(index->dirty, 0);
+    index->repacked = FALSE;
+    for (guint i = position; i < position + added; i++) {
+        Task *task = task_store_get(store, i);
+        TaskSpan *span = NULL;
+        gint32 begin, end;
+
+        // Spans of tasks that are gone.
+        while (next < high && ((TaskSpan *)g_ptr_array_index(index->spans, next))->id < task->id) {
+            TaskSpan *gone = g_ptr_array_index(index->spans, next++);
+            span_index_mark_dirty(index, gone);
+            span_index_unplace(index, gone);
+            g_free(gone);
+        }
+        if (next < high && ((TaskSpan *)g_ptr_array_index(index->spans, next))->id == task->id) {
+            span = g_ptr_array_index(index->spans, next++);
+            // The text or completion may have changed even if the days did not.
+            span_index_mark_dirty(index, span);
+        }
+
+        if (!task_span_days(task, &begin, &end)) {
+            if (span) {
+                span_index_unplace(index, span);
+                g_free(span);
+            }
+            continue;
+        }
+        if (!span) {
+            span = g_new0(TaskSpan, 1);
+            span->id = task->id;
+            span->begin = begin;
+            span->end = end;
+            span_index_place(index, span);
+        } else if (span->begin != begin || span->end != end) {
+            span_index_unplace(index, span);
+            span->begin = begin;
+            span->end = end;
+            span_index_place(index, span);
+        }
+        span->task = task;
+        span_index_mark_dirty(index, span);
+        g_ptr_array_add(replacement, span);
+    }
+    while (next < high) {
+        TaskSpan *gone = g_ptr_array_index(index->spans, next++);
+        span_index_mark_dirty(index, gone);
+        span_index_unplace(index, gone);
+        g_free(gone);
+    }
+
+    if (replacement->len == high - low) {
+        memcpy(index->spans->pdata + low, replacement->pdata, replacement->len * sizeof(gpointer));
+    } else {
+        // Splice the replacement in with one pass over the array.
+        GPtrArray *spans = g_ptr_array_sized_new(index->spans->len - (high - low) + replacement->len);
+        for (guint i = 0; i < low; i++) {
+            g_ptr_array_add(spans, g_ptr_array_index(index->spans, i));
+        }
+        for (guint i = 0; i < replacement->len; i++) {
+            g_ptr_array_add(spans, g_ptr_array_index(replacement, i));
+        }
+        for (guint i = high; i < index->spans->len; i++) {
+            g_ptr_array_add(spans, g_ptr_array_index(index->spans, i));
+        }
+        g_ptr_array_free(index->spans, TRUE);
+        index->spans = spans;
+    }
+    g_ptr_array_free(replacement, TRUE);
+
+    if (removed > added) {
+        guint empty = 0;
+        for (guint lane = 0; lane < index->lane_sizes->len; lane++) {
+            empty += g_array_index(index->lane_sizes, guint, lane) == 0;
+        }
+        if (empty > index->lane_sizes->len / 2) {
+            span_index_pack(index);
+            index->repacked = TRUE;
+        }
+    }
+}
+
+/**
+ * @brief Indexes the spans of every task in a store and keeps them up to
+ * date until span_index_free().
+ *
+ * @param store The task store.
+ * @return A new SpanIndex.
+ */
+static SpanIndex *span_index_new(TaskStore *store) {
+    SpanIndex *index = g_new0(SpanIndex, 1);
+    gint64 start_time = g_get_monotonic_time();
+
+    index->store = store;
+    index->spans = g_ptr_array_new();
+    index->lane_sizes = g_array_new(FALSE, TRUE, sizeof(guint));
+    index->dirty = g_array_new(FALSE, FALSE, sizeof(SpanRect));
+    index->rand = g_rand_new();
+
+    for (guint i = 0; i < store->tasks->len; i++) {
+        Task *task = task_store_get(store, i);
+        gint32 begin, end;
+        if (task_span_days(task, &begin, &end)) {
+            TaskSpan *span = g_new0(TaskSpan, 1);
+            span->task = task;
+            span->id = task->id;
+            span->begin = begin;
+            span->end = end;
+            g_ptr_array_add(index->spans, span);
+        }
+    }
+    span_index_pack(index);
+    task_store_prepend_listener(store, span_index_store_changed, index);
+
+    g_debug("Indexed %u spans in %u lanes in %" G_GINT64_FORMAT " us.", index->spans->len,
+            span_index_get_n_lanes(index), g_get_monotonic_time() - start_time);
+    return index;
+}
+
+static void span_index_free(SpanIndex *index) {
+    task_store_remove_listener(index->store, index);
+    g_ptr_array_set_free_func(index->spans, g_free);
+    g_ptr_array_unref(index->spans);
+    g_array_free(index->lane_sizes, TRUE);
+    g_array_free(index->dirty, TRUE);
+    g_rand_free(index->rand);
+    g_free(index);
+}
+
+// --- Task List View ---
+
+// Rows bound beyond each edge of the viewport, so small scrolls reuse rows.
+#define VIEW_OVERSCAN_ROWS 4
+// Row height used until the first row has been measured.
+#define VIEW_DEFAULT_ROW_HEIGHT 56
+// Larger changes are announced to assistive technologies as one
+// "visible-data-changed" instead of one event per child.
+#define VIEW_MAX_CHILD_EVENTS 64
+// Times an update re-lays out rows that measured differently than estimated.
+#define VIEW_MEASURE_PASSES 3
+
+/**
+ * @brief The vertical extent of a list whose rows differ in height.
+ *
+ * Every row counts as @base high until it has been measured. A Fenwick
+ * tree holds how much taller or shorter than that the measured rows are,
+ * so the offset of a row and the row at an offset both take O(log n), and
+ * the total height is known without building a single row.
+ */
+typedef struct {
+    gint base;
+    guint length;
+    guint top_step;              // Largest power of two not above length.
+    gint *rows;                  // The difference of each row.
+    gint *tree;                  // 1-based; tree[i] sums the differences of rows [i - lowbit(i), i).
+    gint64 extra;                // Sum of all differences.
+} RowHeights;
+
+/**
+ * @brief A virtualized view of the task store.
+ *
+ * Row widgets exist only for the tasks in and around the viewport. They
+ * live in a fixed pool and are positioned inside a viewport-sized
+ * GtkLayout, offset by the scroll position; the row for position p is
+ * always pool slot p % pool size, so rows keep their task while it stays
+ * visible. The scroll range lives only in the adjustment, so no window or
+ * cairo coordinate ever grows with the length of the list.
+ */
+typedef struct {
+    TaskStore *store;
+    GtkWidget *widget;           // The box holding the layout and the scrollbar.
+    GtkWidget *layout;           // A TaskListLayout the size of the viewport.
+    GtkAdjustment *vadjustment;
+    GPtrArray *rows;             // The pool of row widgets.
+    gint row_height;             // Height of a one-line row, assumed for rows not yet measured.
+    RowHeights heights;          // Per shown task.
+    GHashTable *measured;        // Task id -> height, for tasks measured at another height.
+    gboolean heights_stale;      // The shown tasks were replaced; rebuild heights from measured.
+    gboolean heights_changed;    // A row measured differently than it was laid out.
+    gint width;
+    gint height;
+    gboolean updating;
+    GHashTable *selected;        // Ids of the selected tasks.
+    guint anchor_id;             // Where a shift-click range starts.
+    guint update_idle_id;
+    AtkObject *accessible;       // Only set once an assistive technology asks for it.
+    QueryResult *filter;         // The tasks to show, or NULL to show every task.
+    gboolean owns_filter;        // TRUE for an ad hoc filter, FALSE for a saved view's.
+    TaskGroups *groups;          // How the shown tasks are grouped, or NULL.
+    GPtrArray *headers;          // The pool of group header widgets, bound to visible headers only.
+    gint header_height;
+    gboolean draggable;          // Rows can be dragged onto a board column.
+} TaskListView;
+
+// Rows dragged between board columns carry the task id.
+static const GtkTargetEntry task_drag_targets[] = {
+    { "application/x-project-tracker-task", GTK_TARGET_SAME_APP, 0 },
+};
+
+static void on_check_button_toggled(GtkWidget *widget, gpointer user_data);
+static gboolean on_row_button_press(GtkWidget *widget, GdkEventButton *event, gpointer user_data);
+static void on_row_drag_begin(GtkWidget *widget, GdkDragContext *context, gpointer user_data);
+static void on_row_drag_data_get(GtkWidget *widget, GdkDragContext *context, GtkSelectionData *selection_data,
+                                 guint info, guint time, gpointer user_data);
+static void start_list_item_edit(GtkWidget *row);
+static void finish_list_item_edit(GtkWidget *row, gboolean save, gboolean deferred);
+static gboolean task_list_view_find_index(TaskListView *view, guint id, guint *index);
+static gboolean on_header_button_press(GtkWidget *widget, GdkEventButton *event, gpointer user_data);
+
+// --- Task List Accessibility ---
+
+/*
+ * The layout's accessible reports every task in the store as a child, but
+ * creates a child object only when an assistive technology asks for that
+ * index. Children read their name and state from the model, not from row
+ * widgets, so off-screen tasks are visible to screen readers without any
+ * widget existing for them. Nothing here runs unless an AT client connects.
+ */
+
+typedef struct {
+    GtkWidgetAccessible parent_instance;
+    GHashTable *items;           // Index -> TaskItemAccessible, for children handed out.
+} TaskListAccessible;
+
+typedef struct {
+    GtkWidgetAccessibleClass parent_class;
+} TaskListAccessibleClass;
+
+typedef struct {
+    AtkObject parent_instance;
+    TaskListView *view;          // NULL once the item or the view is gone.
+    guint index;                 // Index among the tasks the view shows.
+} TaskItemAccessible;
+
+typedef struct {
+    AtkObjectClass parent_class;
+} TaskItemAccessibleClass;
+
+GType task_list_accessible_get_type(void);
+GType task_item_accessible_get_type(void);
+
+/**
+ * @brief Returns how many items the view shows: its tasks, and when it is
+ * grouped, the group headers.
+ */
+static guint task_list_view_get_n_items(TaskListView *view) {
+    if (view->groups) {
+        return view->groups->n_items;
+    }
+    return view->filter ? view->filter->positions->len : view->store->tasks->len;
+}
+
+/**
+ * @brief Maps an item index to a store position.
+ *
+ * @return The position, or G_MAXUINT if the item is a group header.
+ */
+static guint task_list_view_get_position(TaskListView *view, guint index) {
+    TaskGroup *group;
+
+    if (view->groups) {
+        return task_groups_get_item(view->groups, index, &group);
+    }
+    return view->filter ? g_array_index(view->filter->positions, guint, index) : index;
+}
+
+G_DEFINE_TYPE(TaskItemAccessible, task_item_accessible, ATK_TYPE_OBJECT)
+
+/**
+ * @brief Returns the task an item stands for, or NULL if it no longer exists.
+ */
+static Task *task_item_accessible_get_task(TaskItemAccessible *item) {
+    guint position;
+
+    if (!item->view || item->index >= task_list_view_get_n_items(item->view)) {
+        return NULL;
+    }
+    position = task_list_view_get_position(item->view, item->index);
+    return position != G_MAXUINT ? task_store_get(item->view->store, position) : NULL;
+}
+
+/**
+ * @brief Returns the group an item is the header of, or NULL.
+ */
+static TaskGroup *task_item_accessible_get_header(TaskItemAccessible *item) {
+    TaskGroup *group;
+
+    if (!item->view || !item->view->groups || item->index >= task_list_view_get_n_items(item->view)) {
+        return NULL;
+    }
+    return task_groups_get_item(item->view->groups, item->index, &group) == G_MAXUINT ? group : NULL;
+}
+
+static const gchar *task_item_accessible_get_name(AtkObject *object) {
+    Task *task = task_item_accessible_get_task((TaskItemAccessible *)object);
+    TaskGroup *header;
+
+    if (task) {
+        return task->text;
+    }
+    header = task_item_accessible_get_header((TaskItemAccessible *)object);
+    return header ? header->name : NULL;
+}
+
+static gint task_item_accessible_get_index_in_parent(AtkObject *object) {
+    return ((TaskItemAccessible *)object)->index;
+}
+
+static AtkStateSet *task_item_accessible_ref_state_set(AtkObject *object) {
+    TaskItemAccessible *item = (TaskItemAccessible *)object;
+    Task *task = task_item_accessible_get_task(item);
+    AtkStateSet *states = atk_state_set_new();
+
+    if (!task) {
+        TaskGroup *header = task_item_accessible_get_header(item);
+        if (!header) {
+            atk_state_set_add_state(states, ATK_STATE_DEFUNCT);
+            return states;
+        }
+        atk_state_set_add_state(states, ATK_STATE_ENABLED);
+        atk_state_set_add_state(states, ATK_STATE_VISIBLE);
+        atk_state_set_add_state(states, ATK_STATE_EXPANDABLE);
+        if (!header->collapsed) {
+            atk_state_set_add_state(states, ATK_STATE_EXPANDED);
+        }
+        return states;
+    }
+    atk_state_set_add_state(states, ATK_STATE_ENABLED);
+    atk_state_set_add_state(states, ATK_STATE_SENSITIVE);
+    atk_state_set_add_state(states, ATK_STATE_VISIBLE);
+    atk_state_set_add_state(states, ATK_STATE_CHECKABLE);
+    atk_state_set_add_state(states, ATK_STATE_SELECTABLE);
+    if (task->is_completed) {
+        atk_state_set_add_state(states, ATK_STATE_CHECKED);
+    }
+    if (g_hash_table_contains(item->view->selected, GUINT_TO_POINTER(task->id))) {
+        atk_state_set_add_state(states, ATK_STATE_SELECTED);
+    }
+    return states;
+}
+
+static void task_item_accessible_init(TaskItemAccessible *item) {
+}
+
+static void task_item_accessible_class_init(TaskItemAccessibleClass *klass) {
+    AtkObjectClass *atk_class = ATK_OBJECT_CLASS(klass);
+
+    atk_class->get_name = task_item_accessible_get_name;
+    atk_class->get_index_in_parent = task_item_accessible_get_index_in_parent;
+    atk_class->ref_state_set = task_item_accessible_ref_state_set;
+}
+
+G_DEFINE_TYPE(TaskListAccessible, task_list_accessible, GTK_TYPE_WIDGET_ACCESSIBLE)
+
+/**
+ * @brief Returns the view behind a list accessible, or NULL once the widget is gone.
+ */
+static TaskListView *task_list_accessible_get_view(AtkObject *object) {
+    GtkWidget *widget = gtk_accessible_get_widget(GTK_ACCESSIBLE(object));
+    return widget ? g_object_get_data(G_OBJECT(widget), "view") : NULL;
+}
+
+static void task_list_accessible_initialize(AtkObject *object, gpointer data) {
+    ATK_OBJECT_CLASS(task_list_accessible_parent_class)->initialize(object, data);
+    object->role = ATK_ROLE_LIST;
+
+    TaskListView *view = g_object_get_data(G_OBJECT(data), "view");
+    if (view) {
+        view->accessible = object;
+        g_object_add_weak_pointer(G_OBJECT(object), (gpointer *)&view->accessible);
+    }
+}
+
+static gint task_list_accessible_get_n_children(AtkObject *object) {
+    TaskListView *view = task_list_accessible_get_view(object);
+    return view ? (gint)task_list_view_get_n_items(view) : 0;
+}
+
+static AtkObject *task_list_accessible_ref_child(AtkObject *object, gint index) {
+    TaskListAccessible *list = (TaskListAccessible *)object;
+    TaskListView *view = task_list_accessible_get_view(object);
+    TaskItemAccessible *item;
+
+    if (!view || index < 0 || (guint)index >= task_list_view_get_n_items(view)) {
+        return NULL;
+    }
+
+    item = g_hash_table_lookup(list->items, GINT_TO_POINTER(index));
+    if (!item) {
+        item = g_object_new(task_item_accessible_get_type(), NULL);
+        item->view = view;
+        item->index = index;
+        atk_object_set_role(ATK_OBJECT(item), ATK_ROLE_LIST_ITEM);
+        atk_object_set_parent(ATK_OBJECT(item), object);
+        g_hash_table_insert(list->items, GINT_TO_POINTER(index), item);
+    }
+    return g_object_ref(item);
+}
+
+static void task_list_accessible_finalize(GObject *object) {
+    g_hash_table_unref(((TaskListAccessible *)object)->items);
+    G_OBJECT_CLASS(task_list_accessible_parent_class)->finalize(object);
+}
+
+static void task_list_accessible_init(TaskListAccessible *list) {
+    list->items = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_object_unref);
+}
+
+static void task_list_accessible_class_init(TaskListAccessibleClass *klass) {
+    AtkObjectClass *atk_class = ATK_OBJECT_CLASS(klass);
+
+    G_OBJECT_CLASS(klass)->finalize = task_list_accessible_finalize;
+    atk_class->initialize = task_list_accessible_initialize;
+    atk_class->get_n_children = task_list_accessible_get_n_children;
+    atk_class->ref_child = task_list_accessible_ref_child;
+}
+
+/**
+ * @brief Tells assistive technologies about items a commit replaced.
+ *
+ * Children handed out for items before the change are untouched; those
+ * in an in-place update are told their name and state may have changed;
+ * those after a length change have moved, so they are made defunct and
+ * dropped, to be recreated on demand.
+ */
+static void task_list_accessible_items_changed(TaskListView *view, const ItemsChange *change) {
+    TaskListAccessible *list = (TaskListAccessible *)view->accessible;
+    guint position = change->index;
+    guint removed = change->removed;
+    guint added = change->added;
+    guint updated = MIN(removed, added);
+    GHashTableIter iter;
+    gpointer key, value;
+
+    if (!list) {
+        return;
+    }
+
+    g_hash_table_iter_init(&iter, list->items);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        guint index = GPOINTER_TO_UINT(key);
+        TaskItemAccessible *item = value;
+
+        if (index < position) {
+            continue;
+        } else if (index < position + updated) {
+            Task *task = task_item_accessible_get_task(item);
+            g_object_notify(G_OBJECT(item), "accessible-name");
+            if (task) {
+                atk_object_notify_state_change(ATK_OBJECT(item), ATK_STATE_CHECKED, task->is_completed);
+            }
+        } else if (removed != added) {
+            item->view = NULL;
+            atk_object_notify_state_change(ATK_OBJECT(item), ATK_STATE_DEFUNCT, TRUE);
+            g_hash_table_iter_remove(&iter);
+        }
+    }
+
+    if (removed == added) {
+        return;
+    }
+    if (MAX(removed, added) - updated > VIEW_MAX_CHILD_EVENTS) {
+        g_signal_emit_by_name(list, "visible-data-changed");
+        return;
+    }
+    for (guint i = updated; i < removed; i++) {
+        g_signal_emit_by_name(list, "children-changed::remove", position + updated, NULL);
+    }
+    for (guint i = updated; i < added; i++) {
+        g_signal_emit_by_name(list, "children-changed::add", position + i, NULL);
+    }
+}
+
+/**
+ * @brief Tells assistive technologies that the shown tasks were replaced,
+ * as when a filter changes. Every child handed out becomes defunct.
+ */
+static void task_list_accessible_reset(TaskListView *view) {
+    TaskListAccessible *list = (TaskListAccessible *)view->accessible;
+    GHashTableIter iter;
+    gpointer value;
+
+    if (!list) {
+        return;
+    }
+    g_hash_table_iter_init(&iter, list->items);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        ((TaskItemAccessible *)value)->view = NULL;
+        atk_object_notify_state_change(ATK_OBJECT(value), ATK_STATE_DEFUNCT, TRUE);
+    }
+    g_hash_table_remove_all(list->items);
+    g_signal_emit_by_name(list, "visible-data-changed");
+}
+
+/**
+ * @brief Detaches the accessible's children from a view that is going away.
+ */
+static void task_list_accessible_detach(TaskListView *view) {
+    TaskListAccessible *list = (TaskListAccessible *)view->accessible;
+    GHashTableIter iter;
+    gpointer value;
+
+    if (!list) {
+        return;
+    }
+    g_hash_table_iter_init(&iter, list->items);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        ((TaskItemAccessible *)value)->view = NULL;
+    }
+    g_hash_table_remove_all(list->items);
+    g_object_remove_weak_pointer(G_OBJECT(list), (gpointer *)&view->accessible);
+    view->accessible = NULL;
+}
+
+/**
+ * @brief A GtkLayout whose accessible is a TaskListAccessible.
+ */
+typedef struct {
+    GtkLayout parent_instance;
+} TaskListLayout;
+
+typedef struct {
+    GtkLayoutClass parent_class;
+} TaskListLayoutClass;
+
+GType task_list_layout_get_type(void);
+
+G_DEFINE_TYPE(TaskListLayout, task_list_layout, GTK_TYPE_LAYOUT)
+
+static void task_list_layout_init(TaskListLayout *layout) {
+}
+
+static void task_list_layout_class_init(TaskListLayoutClass *klass) {
+    gtk_widget_class_set_accessible_type(GTK_WIDGET_CLASS(klass), task_list_accessible_get_type());
+}
+
+// --- Task Rows ---
+
+/**
+ * @brief Creates a new list item for the to-do list.
+ *
+ * This function creates a row (a GtkEventBox) containing a horizontal box
+ * with a GtkCheckButton and a GtkLabel. It also applies a CSS class to the
+ * label if the task is completed.
+ *
+ * @param text The text for the to-do item.
+ * @param is_completed TRUE if the task is completed, FALSE otherwise.
+ * @return A pointer to the newly created row widget.
+ */
+GtkWidget *create_list_item(const gchar *text, gboolean is_completed) {
+    GtkWidget *row = gtk_event_box_new();
+    GtkWidget *hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 15); // Increased spacing
+    GtkWidget *check_button = gtk_check_button_new();
+    GtkWidget *label = gtk_label_new(text);
+
+    gtk_container_add(GTK_CONTAINER(row), hbox);
+    gtk_box_pack_start(GTK_BOX(hbox), check_button, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox), label, TRUE, TRUE, 0);
+    gtk_style_context_add_class(gtk_widget_get_style_context(row), "task-row");
+
+    // Long texts wrap; the list measures each row as it is shown.
+    gtk_label_set_xalign(GTK_LABEL(label), 0.0);
+    gtk_label_set_line_wrap(GTK_LABEL(label), TRUE);
+    gtk_label_set_line_wrap_mode(GTK_LABEL(label), PANGO_WRAP_WORD_CHAR);
+
+    // Keep direct references so the row can be updated without walking its children.
+    g_object_set_data(G_OBJECT(row), "check_button", check_button);
+    g_object_set_data(G_OBJECT(row), "label", label);
+
+    // Set the check button state and connect the signal
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(check_button), is_completed);
+    g_signal_connect(check_button, "toggled", G_CALLBACK(on_check_button_toggled), row);
+
+    // Apply the "completed" CSS class if the task is done
+    if (is_completed) {
+        GtkStyleContext *context = gtk_widget_get_style_context(label);
+        gtk_style_context_add_class(context, "completed");
+    }
+
+    return row;
+}
+
+/**
+ * @brief Brings an existing row up to date with its task.
+ *
+ * @param row The row created by create_list_item().
+ * @param task The task the row displays.
+ */
+static void update_list_item(GtkWidget *row, const Task *task) {
+    GtkWidget *check_button = g_object_get_data(G_OBJECT(row), "check_button");
+    GtkWidget *label = g_object_get_data(G_OBJECT(row), "label");
+    GtkStyleContext *context = gtk_widget_get_style_context(label);
+
+    // The change came from the model, so don't feed it back through the toggle handler.
+    g_signal_handlers_block_by_func(check_button, on_check_button_toggled, row);
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(check_button), task->is_completed);
+    g_signal_handlers_unblock_by_func(check_button, on_check_button_toggled, row);
+
+    if (g_strcmp0(gtk_label_get_text(GTK_LABEL(label)), task->text) != 0) {
+        gtk_label_set_text(GTK_LABEL(label), task->text);
+    }
+    if (task->is_completed) {
+        gtk_style_context_add_class(context, "completed");
+    } else {
+        gtk_style_context_remove_class(context, "completed");
+    }
+}
+
+// --- Task List View ---
+
+/**
+ * @brief Sizes the heights for @length rows, all assumed @base high.
+ */
+static void row_heights_reset(RowHeights *heights, guint length, gint base) {
+    g_free(heights->rows);
+    heights->rows = g_new0(gint, length);
+    heights->tree = g_renew(gint, heights->tree, length + 1);
+    memset(heights->tree, 0, (length + 1) * sizeof(gint));
+    heights->base = base;
+    heights->length = length;
+    heights->top_step = length > 0 ? 1u << (g_bit_storage(length) - 1) : 0;
+    heights->extra = 0;
+}
+
+/**
+ * @brief Changes the height of row @index by @delta.
+ */
+static void row_heights_add(RowHeights *heights, guint index, gint delta) {
+    heights->rows[index] += delta;
+    heights->extra += delta;
+    for (guint i = index + 1; i <= heights->length; i += i & -i) {
+        heights->tree[i] += delta;
+    }
+}
+
+/**
+ * @brief Returns the offset of the top of row @index, or the total height
+ * for @index == length.
+ */
+static gint64 row_heights_offset(const RowHeights *heights, guint index) {
+    gint64 offset = (gint64)index * heights->base;
+
+    for (guint i = index; i > 0; i -= i & -i) {
+        offset += heights->tree[i];
+    }
+    return offset;
+}
+
+static gint64 row_heights_total(const RowHeights *heights) {
+    return (gint64)heights->length * heights->base + heights->extra;
+}
+
+static gint row_heights_get(const RowHeights *heights, guint index) {
+    return heights->base + heights->rows[index];
+}
+
+/**
+ * @brief Replaces @removed rows at @index with @added rows of the base
+ * height. When the count changes, the rows after them move over in the
+ * array; the tree nodes before @index cover none of the change and are
+ * kept, and each node after it is summed again from the nodes below it.
+ */
+static void row_heights_splice(RowHeights *heights, guint index, guint removed, guint added) {
+    guint length = heights->length - removed + added;
+    guint tail = heights->length - index - removed;
+
+    if (removed == added) {
+        for (guint i = index; i < index + added; i++) {
+            row_heights_add(heights, i, -heights->rows[i]);
+        }
+        return;
+    }
+    for (guint i = index; i < index + removed; i++) {
+        heights->extra -= heights->rows[i];
+    }
+    if (added > removed) {
+        heights->rows = g_renew(gint, heights->rows, length);
+        heights->tree = g_renew(gint, heights->tree, length + 1);
+    }
+    memmove(heights->rows + index + added, heights->rows + index + removed, tail * sizeof(gint));
+    memset(heights->rows + index, 0, added * sizeof(gint));
+    heights->length = length;
+    heights->top_step = length > 0 ? 1u << (g_bit_storage(length) - 1) : 0;
+
+    for (guint i = index + 1; i <= length; i++) {
+        gint sum = heights->rows[i - 1];
+        // The nodes below i cover the rest of its rows.
+        for (guint child = i - 1; child > i - (i & -i); child -= child & -child) {
+            sum += heights->tree[child];
+        }
+        heights->tree[i] = sum;
+    }
+}
+
+/**
+ * @brief Finds the row at @offset, or the last row if @offset is past the
+ * end. Descends the tree, skipping a whole node's rows at each step.
+ */
+static guint row_heights_find(const RowHeights *heights, gint64 offset) {
+    guint index = 0;
+
+    for (guint step = heights->top_step; step > 0; step >>= 1) {
+        guint next = index + step;
+        if (next <= heights->length) {
+            gint64 span = (gint64)step * heights->base + heights->tree[next];
+            if (span <= offset) {
+                index = next;
+                offset -= span;
+            }
+        }
+    }
+    return heights->length > 0 ? MIN(index, heights->length - 1) : 0;
+}
+
+/**
+ * @brief Rebuilds the view's heights after the shown tasks were replaced,
+ * or the row height changed. Tasks measured before keep their height; the
+ * rest count as one line.
+ */
+static void task_list_view_rebuild_heights(TaskListView *view) {
+    GHashTableIter iter;
+    gpointer id, height;
+    guint index;
+
+    row_heights_reset(&view->heights, task_list_view_get_n_items(view), view->row_height);
+    g_hash_table_iter_init(&iter, view->measured);
+    while (g_hash_table_iter_next(&iter, &id, &height)) {
+        if (task_list_view_find_index(view, GPOINTER_TO_UINT(id), &index)) {
+            row_heights_add(&view->heights, index, GPOINTER_TO_INT(height) - view->row_height);
+        } else {
+            g_hash_table_iter_remove(&iter);
+        }
+    }
+    for (guint i = 0; view->groups && i < view->groups->groups->len; i++) {
+        TaskGroup *group = g_ptr_array_index(view->groups->groups, i);
+        row_heights_add(&view->heights, group->first_item, view->header_height - view->row_height);
+    }
+    view->heights_stale = FALSE;
+}
+
+/**
+ * @brief Patches the view's heights for items a commit replaced. Only the
+ * new items are looked at: headers get the header height, and tasks the
+ * height they were last measured at, wherever they came from.
+ */
+static void task_list_view_splice_heights(TaskListView *view, const ItemsChange *change) {
+    row_heights_splice(&view->heights, change->index, change->removed, change->added);
+    for (guint i = change->index; i < change->index + change->added; i++) {
+        guint position = task_list_view_get_position(view, i);
+        gint height = view->header_height;
+
+        if (position != G_MAXUINT) {
+            gpointer measured = g_hash_table_lookup(view->measured,
+                                                    GUINT_TO_POINTER(task_store_get(view->store, position)->id));
+            height = measured ? GPOINTER_TO_INT(measured) : view->row_height;
+        }
+        if (height != view->row_height) {
+            row_heights_add(&view->heights, i, height - view->row_height);
+        }
+    }
+}
+
+/**
+ * @brief Measures a bound row at the view's width and records its height
+ * if it differs from what the row was laid out with.
+ *
+ * @return The row's height.
+ */
+static gint task_list_view_measure_row(TaskListView *view, GtkWidget *row, guint index, const Task *task) {
+    gint height = row_heights_get(&view->heights, index);
+    gint natural;
+
+    if (view->width <= 0) {
+        // Nothing wraps before the first allocation.
+        return height;
+    }
+    // The old size request would count as the row's minimum.
+    gtk_widget_set_size_request(row, -1, -1);
+    gtk_widget_get_preferred_height_for_width(row, view->width, NULL, &natural);
+    natural = MAX(natural, 1);
+    if (natural != height) {
+        row_heights_add(&view->heights, index, natural - height);
+        view->heights_changed = TRUE;
+    }
+    if (natural != view->row_height) {
+        g_hash_table_insert(view->measured, GUINT_TO_POINTER(task->id), GINT_TO_POINTER(natural));
+    } else {
+        g_hash_table_remove(view->measured, GUINT_TO_POINTER(task->id));
+    }
+    return natural;
+}
+
+/**
+ * @brief Binds a pool row to the shown task at @index, or hides it if
+ * @index is G_MAXUINT.
+ *
+ * The row keeps both its index in the view and the store position of its task.
+ */
+static void task_list_view_bind_row(TaskListView *view, GtkWidget *row, guint index) {
+    GtkStyleContext *context = gtk_widget_get_style_context(row);
+
+    if (index == G_MAXUINT) {
+        finish_list_item_edit(row, TRUE, TRUE);
+        g_object_set_data(G_OBJECT(row), "index", GUINT_TO_POINTER(G_MAXUINT));
+        g_object_set_data(G_OBJECT(row), "position", GUINT_TO_POINTER(G_MAXUINT));
+        gtk_widget_hide(row);
+        return;
+    }
+
+    guint position = task_list_view_get_position(view, index);
+    Task *task = task_store_get(view->store, position);
+    guint edit_id = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(row), "edit_task_id"));
+    if (edit_id && edit_id != task->id) {
+        // The task being edited scrolled away or was removed.
+        finish_list_item_edit(row, TRUE, TRUE);
+    }
+
+    g_object_set_data(G_OBJECT(row), "index", GUINT_TO_POINTER(index));
+    g_object_set_data(G_OBJECT(row), "position", GUINT_TO_POINTER(position));
+    update_list_item(row, task);
+    if (g_hash_table_contains(view->selected, GUINT_TO_POINTER(task->id))) {
+        gtk_style_context_add_class(context, "selected");
+    } else {
+        gtk_style_context_remove_class(context, "selected");
+    }
+
+    gint height = task_list_view_measure_row(view, row, index, task);
+    gtk_widget_set_size_request(row, view->width, height);
+    gtk_layout_move(GTK_LAYOUT(view->layout), row, 0,
+                    (gint)(row_heights_offset(&view->heights, index) - gtk_adjustment_get_value(view->vadjustment)));
+    gtk_widget_show(row);
+}
+
+/**
+ * @brief Creates a pool row and adds it to the layout.
+ */
+static GtkWidget *task_list_view_new_row(TaskListView *view) {
+    GtkWidget *row = create_list_item("", FALSE);
+
+    g_object_set_data(G_OBJECT(row), "view", view);
+    g_object_set_data(G_OBJECT(row), "index", GUINT_TO_POINTER(G_MAXUINT));
+    g_object_set_data(G_OBJECT(row), "position", GUINT_TO_POINTER(G_MAXUINT));
+    if (view->draggable) {
+        // The drag source watches button presses too, so it must see them first.
+        gtk_drag_source_set(row, GDK_BUTTON1_MASK, task_drag_targets, G_N_ELEMENTS(task_drag_targets),
+                            GDK_ACTION_MOVE);
+        g_signal_connect(row, "drag-begin", G_CALLBACK(on_row_drag_begin), view);
+        g_signal_connect(row, "drag-data-get", G_CALLBACK(on_row_drag_data_get), view);
+    }
+    g_signal_connect(row, "button-press-event", G_CALLBACK(on_row_button_press), view);
+    gtk_layout_put(GTK_LAYOUT(view->layout), row, 0, 0);
+    gtk_widget_show_all(row);
+
+    if (view->rows->len == 0) {
+        // The empty first row gives the height of a one-line row.
+        gint natural_height;
+        gtk_widget_get_preferred_height(row, NULL, &natural_height);
+        view->row_height = MAX(natural_height, 1);
+        view->heights_stale = TRUE;
+    }
+    g_ptr_array_add(view->rows, row);
+    return row;
+}
+
+/**
+ * @brief Creates a pool header and adds it to the layout.
+ */
+static GtkWidget *task_list_view_new_header(TaskListView *view) {
+    GtkWidget *header = gtk_event_box_new();
+    GtkWidget *label = gtk_label_new("Group");
+
+    gtk_label_set_xalign(GTK_LABEL(label), 0.0);
+    gtk_label_set_ellipsize(GTK_LABEL(label), PANGO_ELLIPSIZE_END);
+    gtk_container_add(GTK_CONTAINER(header), label);
+    gtk_style_context_add_class(gtk_widget_get_style_context(header), "group-header");
+    g_object_set_data(G_OBJECT(header), "label", label);
+    g_object_set_data(G_OBJECT(header), "index", GUINT_TO_POINTER(G_MAXUINT));
+    g_signal_connect(header, "button-press-event", G_CALLBACK(on_header_button_press), view);
+    gtk_layout_put(GTK_LAYOUT(view->layout), header, 0, 0);
+    gtk_widget_show_all(header);
+
+    if (view->headers->len == 0) {
+        // Headers are one line, so they all share the height of the first.
+        gint natural_height;
+        gtk_widget_get_preferred_height(header, NULL, &natural_height);
+        view->header_height = MAX(natural_height, 1);
+    }
+    g_ptr_array_add(view->headers, header);
+    return header;
+}
+
+/**
+ * @brief Binds the @n-th pool header to the group header at item @index,
+ * or hides it if @index is G_MAXUINT.
+ */
+static void task_list_view_bind_header(TaskListView *view, guint n, guint index) {
+    GtkWidget *header;
+    TaskGroup *group;
+    gchar *text;
+
+    if (index == G_MAXUINT) {
+        header = g_ptr_array_index(view->headers, n);
+        g_object_set_data(G_OBJECT(header), "index", GUINT_TO_POINTER(G_MAXUINT));
+        gtk_widget_hide(header);
+        return;
+    }
+    while (view->headers->len <= n) {
+        task_list_view_new_header(view);
+    }
+    header = g_ptr_array_index(view->headers, n);
+    task_groups_get_item(view->groups, index, &group);
+
+    text = g_strdup_printf("%s %s (%u)", group->collapsed ? "▸" : "▾", group->name, group->positions->len);
+    gtk_label_set_text(GTK_LABEL(g_object_get_data(G_OBJECT(header), "label")), text);
+    g_free(text);
+    g_object_set_data(G_OBJECT(header), "index", GUINT_TO_POINTER(index));
+    gtk_widget_set_size_request(header, view->width, view->header_height);
+    gtk_layout_move(GTK_LAYOUT(view->layout), header, 0,
+                    (gint)(row_heights_offset(&view->heights, index) - gtk_adjustment_get_value(view->vadjustment)));
+    gtk_widget_show(header);
+}
+
+/**
+ * @brief Binds the pool rows to the tasks in and around the viewport.
+ *
+ * This only touches as many rows as fit on screen, however long the list.
+ * Rows are measured as they are bound. When one turns out taller or
+ * shorter than assumed, the rows are laid out again, keeping the task at
+ * the top of the viewport where it was.
+ *
+ * @param view The task list view.
+ */
+static void task_list_view_update(TaskListView *view) {
+    guint length = task_list_view_get_n_items(view);
+    gdouble page_size = view->height;
+    gdouble upper;
+    gdouble value;
+    guint first, last, needed;
+    guint anchor;
+    gdouble anchor_inside;
+
+    if (view->updating) {
+        return;
+    }
+    view->updating = TRUE;
+
+    if (length > 0 && view->rows->len == 0) {
+        task_list_view_new_row(view);
+    }
+    value = gtk_adjustment_get_value(view->vadjustment);
+    anchor = row_heights_find(&view->heights, value);
+    anchor_inside = value - row_heights_offset(&view->heights, MIN(anchor, view->heights.length));
+    if (view->heights_stale || view->heights.length != length) {
+        task_list_view_rebuild_heights(view);
+        value = row_heights_offset(&view->heights, MIN(anchor, length)) + anchor_inside;
+    }
+
+    for (guint pass = 0; pass < VIEW_MEASURE_PASSES; pass++) {
+        upper = row_heights_total(&view->heights);
+        value = CLAMP(value, 0.0, MAX(upper - page_size, 0.0));
+        gtk_adjustment_configure(view->vadjustment, value, 0.0, upper, view->row_height,
+                                 MAX(page_size - view->row_height, view->row_height), page_size);
+
+        first = row_heights_find(&view->heights, value);
+        first = first > VIEW_OVERSCAN_ROWS ? first - VIEW_OVERSCAN_ROWS : 0;
+        last = MIN(length, row_heights_find(&view->heights, value + page_size) + 1 + VIEW_OVERSCAN_ROWS);
+        first = MIN(first, last);
+        needed = last - first;
+
+        if (view->rows->len < needed) {
+            // Growing the pool changes which slot each position maps to.
+            for (guint i = 0; i < view->rows->len; i++) {
+                task_list_view_bind_row(view, g_ptr_array_index(view->rows, i), G_MAXUINT);
+            }
+            while (view->rows->len < needed) {
+                task_list_view_new_row(view);
+            }
+        }
+
+        guint pool_size = view->rows->len;
+        guint n_headers = 0;
+        view->heights_changed = FALSE;
+        for (guint slot = 0; slot < pool_size; slot++) {
+            // The index in [first, first + pool_size) that maps to this slot.
+            guint index = first + (slot + pool_size - first % pool_size) % pool_size;
+            if (index < last && view->groups && task_list_view_get_position(view, index) == G_MAXUINT) {
+                // Only the headers of groups on screen get a widget.
+                task_list_view_bind_row(view, g_ptr_array_index(view->rows, slot), G_MAXUINT);
+                task_list_view_bind_header(view, n_headers++, index);
+                continue;
+            }
+            task_list_view_bind_row(view, g_ptr_array_index(view->rows, slot),
+                                    index < last ? index : G_MAXUINT);
+        }
+        for (guint i = n_headers; i < view->headers->len; i++) {
+            task_list_view_bind_header(view, i, G_MAXUINT);
+        }
+        if (!view->heights_changed || length == 0) {
+            break;
+        }
+        anchor = MIN(anchor, length - 1);
+        value = row_heights_offset(&view->heights, anchor) + MIN(anchor_inside, row_heights_get(&view->heights, anchor));
+    }
+    view->updating = FALSE;
+}
+
+/**
+ * @brief Idle callback for task_list_view_queue_update().
+ */
+static gboolean on_view_update_idle(gpointer user_data) {
+    TaskListView *view = user_data;
+    view->update_idle_id = 0;
+    task_list_view_update(view);
+    return G_SOURCE_REMOVE;
+}
+
+/**
+ * @brief Schedules task_list_view_update() for when GTK is idle. Used from
+ * size-allocate, where changing size requests directly is not allowed.
+ */
+static void task_list_view_queue_update(TaskListView *view) {
+    if (!view->update_idle_id) {
+        view->update_idle_id = g_idle_add(on_view_update_idle, view);
+    }
+}
+
+/**
+ * @brief Store listener for the view.
+ */
+static void on_view_store_changed(TaskStore *store, guint position, guint removed, guint added, gpointer user_data) {
+    TaskListView *view = user_data;
+    GArray *changes = g_array_new(FALSE, FALSE, sizeof(ItemsChange));
+    ItemsChange change = { position, removed, added };
+    guint old_n_items;
+
+    if (view->groups) {
+        // A commit can move tasks between groups, so it may replace items
+        // in several places.
+        task_groups_store_changed(view->groups, store, view->filter, position, removed, added, changes);
+    } else if (view->filter) {
+        // The filter's result was updated ahead of the views.
+        g_array_append_val(changes, view->filter->change);
+    } else {
+        g_array_append_val(changes, change);
+    }
+    old_n_items = task_list_view_get_n_items(view);
+    for (guint i = 0; i < changes->len; i++) {
+        ItemsChange *item_change = &g_array_index(changes, ItemsChange, i);
+        old_n_items += item_change->removed - item_change->added;
+    }
+    // Heights not laid out for the items there were are rebuilt instead.
+    view->heights_stale |= view->heights.length != old_n_items;
+    for (guint i = 0; i < changes->len && !view->heights_stale; i++) {
+        // Edited rows are measured again when bound.
+        task_list_view_splice_heights(view, &g_array_index(changes, ItemsChange, i));
+    }
+    task_list_view_update(view);
+    for (guint i = 0; i < changes->len; i++) {
+        task_list_accessible_items_changed(view, &g_array_index(changes, ItemsChange, i));
+    }
+    g_array_free(changes, TRUE);
+}
+
+/**
+ * @brief Callback for the vertical adjustment's "value-changed" signal.
+ */
+static void on_view_scrolled(GtkAdjustment *adjustment, gpointer user_data) {
+    task_list_view_update(user_data);
+}
+
+/**
+ * @brief Callback for the layout's "size-allocate" signal. Rows span the
+ * full width, and the height decides how many rows are bound. Texts wrap
+ * differently at another width, so the measured heights are dropped.
+ */
+static void on_view_size_allocate(GtkWidget *widget, GdkRectangle *allocation, gpointer user_data) {
+    TaskListView *view = user_data;
+
+    if (allocation->width != view->width) {
+        g_hash_table_remove_all(view->measured);
+        view->heights_stale = TRUE;
+    }
+    if (allocation->width != view->width || allocation->height != view->height) {
+        view->width = allocation->width;
+        view->height = allocation->height;
+        task_list_view_queue_update(view);
+    }
+}
+
+/**
+ * @brief Callback for "scroll-event" on the layout, which has no scrolling
+ * of its own.
+ */
+static gboolean on_view_scroll_event(GtkWidget *widget, GdkEventScroll *event, gpointer user_data) {
+    TaskListView *view = user_data;
+    gdouble delta_x, delta_y;
+    gdouble step = view->row_height * 3;
+    gdouble value = gtk_adjustment_get_value(view->vadjustment);
+
+    if (gdk_event_get_scroll_deltas((GdkEvent *)event, &delta_x, &delta_y)) {
+        value += delta_y * step;
+    } else if (event->direction == GDK_SCROLL_UP) {
+        value -= step;
+    } else if (event->direction == GDK_SCROLL_DOWN) {
+        value += step;
+    } else {
+        return GDK_EVENT_PROPAGATE;
+    }
+    gtk_adjustment_set_value(view->vadjustment, value);
+    return GDK_EVENT_STOP;
+}
+
+/**
+ * @brief Re-applies the selection style to the bound rows.
+ */
+static void task_list_view_refresh_selection(TaskListView *view) {
+    for (guint i = 0; i < view->rows->len; i++) {
+        GtkWidget *row = g_ptr_array_index(view->rows, i);
+        guint index = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(row), "index"));
+        if (index != G_MAXUINT) {
+            task_list_view_bind_row(view, row, index);
+        }
+    }
+}
+
+/**
+ * @brief Selects every task the view shows.
+ *
+ * @param view The task list view.
+ */
+static void task_list_view_select_all(TaskListView *view) {
+    guint n_items = task_list_view_get_n_items(view);
+
+    for (guint i = 0; i < n_items; i++) {
+        guint position = task_list_view_get_position(view, i);
+        if (position != G_MAXUINT) {
+            g_hash_table_add(view->selected, GUINT_TO_POINTER(task_store_get(view->store, position)->id));
+        }
+    }
+    task_list_view_refresh_selection(view);
+}
+
+/**
+ * @brief Finds where a task is shown.
+ *
+ * @param view The task list view.
+ * @param id The task id.
+ * @param index Return location for the index among the shown tasks.
+ * @return TRUE if the task exists and is shown.
+ */
+static gboolean task_list_view_find_index(TaskListView *view, guint id, guint *index) {
+    GArray *positions;
+    guint position;
+
+    if (!task_store_find(view->store, id, &position)) {
+        return FALSE;
+    }
+    if (view->groups) {
+        // Groups only hold the tasks the filter lets through.
+        return task_groups_find_item(view->groups, view->store, position, index);
+    }
+    if (!view->filter) {
+        *index = position;
+        return TRUE;
+    }
+    positions = view->filter->positions;
+    *index = positions_lower_bound(positions, position);
+    return *index < positions->len && g_array_index(positions, guint, *index) == position;
+}
+
+/**
+ * @brief Selects the shown task at @index and scrolls it into view.
+ *
+ * The row's offset comes from the heights, so a jump anywhere in the list
+ * costs O(log n) and builds only the rows that end up on screen.
+ *
+ * @param view The task list view.
+ * @param index The index among the shown tasks.
+ */
+static void task_list_view_scroll_to(TaskListView *view, guint index) {
+    Task *task = task_store_get(view->store, task_list_view_get_position(view, index));
+    gdouble value = gtk_adjustment_get_value(view->vadjustment);
+    gdouble top, height;
+
+    if (view->heights_stale) {
+        task_list_view_update(view);
+    }
+    top = row_heights_offset(&view->heights, index);
+    height = row_heights_get(&view->heights, index);
+    if (top < value || top + height > value + view->height) {
+        // Out of view: bring it to the middle.
+        value = top - MAX(view->height - height, 0.0) / 2;
+    }
+
+    g_hash_table_remove_all(view->selected);
+    g_hash_table_add(view->selected, GUINT_TO_POINTER(task->id));
+    view->anchor_id = task->id;
+    gtk_adjustment_set_value(view->vadjustment, value);
+    task_list_view_refresh_selection(view);
+}
+
+/**
+ * @brief Returns the current positions of the selected tasks.
+ *
+ * @param view The task list view.
+ * @param n_positions Return location for the number of positions.
+ * @return A newly allocated array of positions, in ascending order.
+ */
+static guint *task_list_view_get_selected_positions(TaskListView *view, guint *n_positions) {
+    guint *positions = g_new(guint, g_hash_table_size(view->selected) + 1);
+    guint n = 0;
+
+    for (guint i = 0; i < view->store->tasks->len && n < g_hash_table_size(view->selected); i++) {
+        if (g_hash_table_contains(view->selected, GUINT_TO_POINTER(task_store_get(view->store, i)->id))) {
+            positions[n++] = i;
+        }
+    }
+    *n_positions = n;
+    return positions;
+}
+
+/**
+ * @brief Callback for "button-press-event" on a row.
+ *
+ * A click selects the row, Ctrl+click toggles it and Shift+click extends
+ * the selection from the last clicked row. A double-click starts editing.
+ */
+static gboolean on_row_button_press(GtkWidget *widget, GdkEventButton *event, gpointer user_data) {
+    TaskListView *view = user_data;
+    guint index = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(widget), "index"));
+    guint anchor_index;
+
+    if (event->button != 1 || index >= task_list_view_get_n_items(view)) {
+        return GDK_EVENT_PROPAGATE;
+    }
+    if (event->type == GDK_2BUTTON_PRESS) {
+        start_list_item_edit(widget);
+        return GDK_EVENT_STOP;
+    }
+    if (event->type != GDK_BUTTON_PRESS) {
+        return GDK_EVENT_PROPAGATE;
+    }
+
+    Task *task = task_store_get(view->store, task_list_view_get_position(view, index));
+    if ((event->state & GDK_SHIFT_MASK) && task_list_view_find_index(view, view->anchor_id, &anchor_index)) {
+        for (guint i = MIN(index, anchor_index); i <= MAX(index, anchor_index); i++) {
+            guint position = task_list_view_get_position(view, i);
+            if (position != G_MAXUINT) {
+                g_hash_table_add(view->selected, GUINT_TO_POINTER(task_store_get(view->store, position)->id));
+            }
+        }
+    } else if (event->state & GDK_CONTROL_MASK) {
+        if (!g_hash_table_remove(view->selected, GUINT_TO_POINTER(task->id))) {
+            g_hash_table_add(view->selected, GUINT_TO_POINTER(task->id));
+        }
+        view->anchor_id = task->id;
+    } else {
+        g_hash_table_remove_all(view->selected);
+        g_hash_table_add(view->selected, GUINT_TO_POINTER(task->id));
+        view->anchor_id = task->id;
+    }
+    task_list_view_refresh_selection(view);
+    return GDK_EVENT_STOP;
+}
+
+/**
+ * @brief Callback for "drag-begin" on a row. The task is remembered now,
+ * since the row may be rebound to another task while the drag is going on.
+ */
+static void on_row_drag_begin(GtkWidget *widget, GdkDragContext *context, gpointer user_data) {
+    TaskListView *view = user_data;
+    guint position = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(widget), "position"));
+    guint id = position < view->store->tasks->len ? task_store_get(view->store, position)->id : 0;
+
+    g_object_set_data(G_OBJECT(widget), "drag_task_id", GUINT_TO_POINTER(id));
+}
+
+/**
+ * @brief Callback for "drag-data-get" on a row. Hands out the dragged
+ * task's id.
+ */
+static void on_row_drag_data_get(GtkWidget *widget, GdkDragContext *context, GtkSelectionData *selection_data,
+                                 guint info, guint time, gpointer user_data) {
+    guint id = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(widget), "drag_task_id"));
+    gchar *text;
+
+    if (!id) {
+        return;
+    }
+    text = g_strdup_printf("%u", id);
+    gtk_selection_data_set(selection_data, gtk_selection_data_get_target(selection_data), 8,
+                           (const guchar *)text, strlen(text));
+    g_free(text);
+}
+
+/**
+ * @brief Frees the view when its layout is destroyed.
+ */
+static void on_view_destroy(GtkWidget *widget, gpointer user_data) {
+    TaskListView *view = user_data;
+
+    // The rows are destroyed after this handler; make sure they don't reach back.
+    for (guint i = 0; i < view->rows->len; i++) {
+        g_object_set_data(G_OBJECT(g_ptr_array_index(view->rows, i)), "view", NULL);
+    }
+    task_store_remove_listener(view->store, view);
+    task_list_accessible_detach(view);
+    if (view->update_idle_id) {
+        g_source_remove(view->update_idle_id);
+    }
+    g_signal_handlers_disconnect_by_func(view->vadjustment, on_view_scrolled, view);
+    g_object_unref(view->vadjustment);
+    g_object_set_data(G_OBJECT(view->layout), "view", NULL);
+    g_ptr_array_free(view->rows, TRUE);
+    g_hash_table_unref(view->selected);
+    g_hash_table_unref(view->measured);
+    g_free(view->heights.rows);
+    g_free(view->heights.tree);
+    g_ptr_array_free(view->headers, TRUE);
+    g_clear_pointer(&view->groups, task_groups_free);
+    if (view->filter && view->owns_filter) {
+        query_result_free(view->filter);
+    }
+    g_free(view);
+}
+
+/**
+ * @brief Shows only the tasks in a query result.
+ *
+ * The selection is cleared, so bulk actions never reach tasks the user
+ * cannot see.
+ *
+ * @param view The task list view.
+ * @param filter A query result, or NULL to show every task.
+ * @param owned TRUE if the view should free @filter when done with it.
+ */
+static void task_list_view_set_filter(TaskListView *view, QueryResult *filter, gboolean owned) {
+    if (view->filter && view->owns_filter) {
+        query_result_free(view->filter);
+    }
+    view->filter = filter;
+    view->owns_filter = owned;
+    if (filter && filter->query->relative && filter->day != query_today()) {
+        query_result_refresh(filter);
+    }
+    if (view->groups) {
+        task_groups_rebuild(view->groups, view->store, filter);
+    }
+    g_hash_table_remove_all(view->selected);
+    view->heights_stale = TRUE;
+    gtk_adjustment_set_value(view->vadjustment, 0.0);
+    task_list_view_update(view);
+    task_list_accessible_reset(view);
+}
+
+/**
+ * @brief Collapses or expands a group of the view. The rows of its tasks
+ * are not touched; only the items after its header move.
+ */
+static void task_list_view_set_group_collapsed(TaskListView *view, TaskGroup *group, gboolean collapsed) {
+    if (collapsed) {
+        // Like a filter, hiding tasks drops them from the selection.
+        for (guint i = 0; i < group->positions->len; i++) {
+            Task *task = task_store_get(view->store, g_array_index(group->positions, guint, i));
+            g_hash_table_remove(view->selected, GUINT_TO_POINTER(task->id));
+        }
+    }
+    task_groups_set_collapsed(view->groups, group, collapsed);
+    view->heights_stale = TRUE;
+    task_list_view_update(view);
+    task_list_view_refresh_selection(view);
+    task_list_accessible_reset(view);
+}
+
+/**
+ * @brief Callback for "button-press-event" on a group header. A click
+ * collapses or expands the group.
+ */
+static gboolean on_header_button_press(GtkWidget *widget, GdkEventButton *event, gpointer user_data) {
+    TaskListView *view = user_data;
+    guint index = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(widget), "index"));
+    TaskGroup *group;
+
+    if (event->button != 1 || event->type != GDK_BUTTON_PRESS || !view->groups ||
+        index >= task_list_view_get_n_items(view) ||
+        task_groups_get_item(view->groups, index, &group) != G_MAXUINT) {
+        return GDK_EVENT_PROPAGATE;
+    }
+    task_list_view_set_group_collapsed(view, group, !group->collapsed);
+    return GDK_EVENT_STOP;
+}
+
+/**
+ * @brief Groups the shown tasks under headers, or stops grouping them.
+ *
+ * @param view The task list view.
+ * @param by What to group by, or TASK_GROUP_NONE.
+ */
+static void task_list_view_set_group_by(TaskListView *view, TaskGroupBy by) {
+    if ((view->groups ? view->groups->by : TASK_GROUP_NONE) == by) {
+        return;
+    }
+    g_clear_pointer(&view->groups, task_groups_free);
+    if (by != TASK_GROUP_NONE) {
+        view->groups = task_groups_new(by);
+        task_groups_rebuild(view->groups, view->store, view->filter);
+        if (view->headers->len == 0) {
+            // Measures the header height before any header is laid out.
+            task_list_view_new_header(view);
+        }
+    }
+    view->heights_stale = TRUE;
+    gtk_adjustment_set_value(view->vadjustment, 0.0);
+    task_list_view_update(view);
+    task_list_accessible_reset(view);
+}
+
+/**
+ * @brief Returns how many tasks the view shows, headers and collapsed
+ * groups aside.
+ */
+static guint task_list_view_get_n_tasks(TaskListView *view) {
+    return view->filter ? view->filter->positions->len : view->store->tasks->len;
+}
+
+/**
+ * @brief Finds the item of the @n-th shown task, counting every group's
+ * tasks in order. A collapsed group holding it is expanded.
+ */
+static guint task_list_view_get_nth_task(TaskListView *view, guint n) {
+    if (!view->groups) {
+        return n;
+    }
+    for (guint i = 0; i < view->groups->groups->len; i++) {
+        TaskGroup *group = g_ptr_array_index(view->groups->groups, i);
+        if (n < group->positions->len) {
+            if (group->collapsed) {
+                task_list_view_set_group_collapsed(view, group, FALSE);
+            }
+            return group->first_item + 1 + n;
+        }
+        n -= group->positions->len;
+    }
+    return 0;
+}
+
+/**
+ * @brief Creates a virtualized task list with its own scrollbar.
+ *
+ * @param store The task store to show.
+ * @param parent The GtkBox to pack the list into. The list needs a styled
+ * parent before its first row can be measured.
+ * @param filter A query result the view takes ownership of, or NULL to show
+ * every task.
+ * @param draggable TRUE if rows can be dragged onto a board column.
+ * @return The new view. It is freed when its layout is destroyed.
+ */
+static TaskListView *task_list_view_new_full(TaskStore *store, GtkWidget *parent, QueryResult *filter,
+                                             gboolean draggable) {
+    TaskListView *view = g_new0(TaskListView, 1);
+
+    view->store = store;
+    view->filter = filter;
+    view->owns_filter = filter != NULL;
+    view->draggable = draggable;
+    view->rows = g_ptr_array_new();
+    view->headers = g_ptr_array_new();
+    view->row_height = VIEW_DEFAULT_ROW_HEIGHT;
+    view->selected = g_hash_table_new(g_direct_hash, g_direct_equal);
+    view->measured = g_hash_table_new(g_direct_hash, g_direct_equal);
+    view->heights_stale = TRUE;
+    view->vadjustment = g_object_ref_sink(gtk_adjustment_new(0, 0, 0, 0, 0, 0));
+
+    view->widget = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
+    gtk_style_context_add_class(gtk_widget_get_style_context(view->widget), "task-list");
+    gtk_box_pack_start(GTK_BOX(parent), view->widget, TRUE, TRUE, 0);
+
+    view->layout = g_object_new(task_list_layout_get_type(), NULL);
+    g_object_set_data(G_OBJECT(view->layout), "view", view);
+    gtk_widget_add_events(view->layout, GDK_SCROLL_MASK | GDK_SMOOTH_SCROLL_MASK);
+    gtk_box_pack_start(GTK_BOX(view->widget), view->layout, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(view->widget), gtk_scrollbar_new(GTK_ORIENTATION_VERTICAL, view->vadjustment),
+                       FALSE, FALSE, 0);
+
+    g_signal_connect(view->vadjustment, "value-changed", G_CALLBACK(on_view_scrolled), view);
+    g_signal_connect(view->layout, "size-allocate", G_CALLBACK(on_view_size_allocate), view);
+    g_signal_connect(view->layout, "scroll-event", G_CALLBACK(on_view_scroll_event), view);
+    g_signal_connect(view->layout, "destroy", G_CALLBACK(on_view_destroy), view);
+
+    task_store_add_listener(store, on_view_store_changed, view);
+    task_list_view_update(view);
+    return view;
+}
+
+/**
+ * @brief Creates a virtualized list of every task; see task_list_view_new_full().
+ */
+static TaskListView *task_list_view_new(TaskStore *store, GtkWidget *parent) {
+    return task_list_view_new_full(store, parent, NULL, FALSE);
+}
+
+// --- Inline Editing ---
+
+/**
+ * @brief Pending edit saved from an idle callback.
+ */
+typedef struct {
+    TaskStore *store;
+    guint task_id;
+    gchar *text;
+} PendingEdit;
+
+/**
+ * @brief Stores an edited text in the task with the given id, if it still exists.
+ */
+static void save_task_edit(TaskStore *store, guint task_id, const gchar *text) {
+    guint position;
+
+    if (task_store_find(store, task_id, &position)) {
+        task_store_set_text(store, position, text);
+    }
+}
+
+/**
+ * @brief Idle callback that applies a PendingEdit.
+ */
+static gboolean on_pending_edit_idle(gpointer user_data) {
+    PendingEdit *edit = user_data;
+
+    save_task_edit(edit->store, edit->task_id, edit->text);
+    g_free(edit->text);
+    g_free(edit);
+    return G_SOURCE_REMOVE;
+}
+
+/**
+ * @brief Ends inline editing of a row, optionally saving the new text.
+ *
+ * @param row The row being edited.
+ * @param save TRUE to store the entry's text in the task, FALSE to discard it.
+ * @param deferred TRUE to save from an idle callback. Used when the edit
+ * ends because the row is rebound, which may happen inside a store
+ * notification where starting another transaction is not allowed.
+ */
+static void finish_list_item_edit(GtkWidget *row, gboolean save, gboolean deferred) {
+    GtkWidget *entry = g_object_get_data(G_OBJECT(row), "edit_entry");
+    GtkWidget *label = g_object_get_data(G_OBJECT(row), "label");
+    TaskListView *view = g_object_get_data(G_OBJECT(row), "view");
+    guint task_id = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(row), "edit_task_id"));
+
+    if (!entry) {
+        return;
+    }
+    // Clear the references first: destroying the entry moves the focus, which
+    // emits focus-out-event and re-enters this function.
+    g_object_set_data(G_OBJECT(row), "edit_entry", NULL);
+    g_object_set_data(G_OBJECT(row), "edit_task_id", NULL);
+
+    gchar *text = g_strstrip(g_strdup(gtk_entry_get_text(GTK_ENTRY(entry))));
+    gtk_widget_destroy(entry);
+    gtk_widget_show(label);
+
+    if (save && *text && view) {
+        if (deferred) {
+            PendingEdit *edit = g_new0(PendingEdit, 1);
+            edit->store = view->store;
+            edit->task_id = task_id;
+            edit->text = text;
+            g_idle_add(on_pending_edit_idle, edit);
+            return;
+        }
+        save_task_edit(view->store, task_id, text);
+    }
+    g_free(text);
+}
+
+/**
+ * @brief Callback for the inline edit entry's "activate" signal.
+ */
+static void on_edit_entry_activate(GtkWidget *widget, gpointer user_data) {
+    finish_list_item_edit(GTK_WIDGET(user_data), TRUE, FALSE);
+}
+
+/**
+ * @brief Callback for the inline edit entry's "focus-out-event".
+ */
+static gboolean on_edit_entry_focus_out(GtkWidget *widget, GdkEvent *event, gpointer user_data) {
+    finish_list_item_edit(GTK_WIDGET(user_data), TRUE, FALSE);
+    return GDK_EVENT_PROPAGATE;
+}
+
+/**
+ * @brief Callback for the inline edit entry's "key-press-event". Escape
+ * discards the edit.
+ */
+static gboolean on_edit_entry_key_press(GtkWidget *widget, GdkEventKey *event, gpointer user_data) {
+    if (event->keyval == GDK_KEY_Escape) {
+        finish_list_item_edit(GTK_WIDGET(user_data), FALSE, FALSE);
+        return GDK_EVENT_STOP;
+    }
+    return GDK_EVENT_PROPAGATE;
+}
+
+/**
+ * @brief Swaps a row's label for an entry so the task text can be edited.
+ *
+ * Only the row being edited gets an entry; all other rows keep their label.
+ *
+ * @param row The row to edit.
+ */
+static void start_list_item_edit(GtkWidget *row) {
+    TaskListView *view = g_object_get_data(G_OBJECT(row), "view");
+    guint position = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(row), "position"));
+    GtkWidget *label = g_object_get_data(G_OBJECT(row), "label");
+    GtkWidget *entry;
+
+    if (g_object_get_data(G_OBJECT(row), "edit_entry") || position >= view->store->tasks->len) {
+        return;
+    }
+
+    entry = gtk_entry_new();
+    // A pasted line break would otherwise stay inside the text.
+    gtk_entry_set_truncate_multiline(GTK_ENTRY(entry), TRUE);
+    gtk_entry_set_text(GTK_ENTRY(entry), task_store_get(view->store, position)->text);
+    gtk_box_pack_start(GTK_BOX(gtk_bin_get_child(GTK_BIN(row))), entry, TRUE, TRUE, 0);
+    g_object_set_data(G_OBJECT(row), "edit_entry", entry);
+    g_object_set_data(G_OBJECT(row), "edit_task_id", GUINT_TO_POINTER(task_store_get(view->store, position)->id));
+
+    g_signal_connect(entry, "activate", G_CALLBACK(on_edit_entry_activate), row);
+    g_signal_connect(entry, "focus-out-event", G_CALLBACK(on_edit_entry_focus_out), row);
+    g_signal_connect(entry, "key-press-event", G_CALLBACK(on_edit_entry_key_press), row);
+
+    gtk_widget_hide(label);
+    gtk_widget_show(entry);
+    gtk_widget_grab_focus(entry);
+}
+
+// --- Encryption ---
+
+/*
+ * With PROJECT_TRACKER_KEY_FILE set to a file holding a 256-bit key (32
+ * raw bytes, or 64 hex digits), TASKS_FILE and JOURNAL_FILE are sealed
+ * with an AEAD cipher: AES-256-GCM on processors with AES instructions,
+ * ChaCha20-Poly1305 elsewhere. A sealed file is a header followed by
+ * blocks:
+ *
+ *   header   "PTCRYPT1", cipher id (1 byte), 3 reserved bytes, file id (8 bytes)
+ *   block    length (4 bytes, little-endian; bit 31 marks a snapshot's last
+ *            block), ciphertext, tag (16 bytes)
+ *
+ * The nonce of a block is the file's random id followed by the block's
+ * index, and the header and length word are authenticated with it, so
+ * blocks cannot be reordered, moved between files or cut off unnoticed.
+ * Snapshots are cut into blocks of CIPHER_BLOCK_SIZE, so any block can be
+ * read on its own; the journal gets one block per group commit, so it can
+ * still be appended to.
+ *
+ * A plain task file is sealed the first time it is saved with a key set.
+ */
+
+#define CIPHER_MAGIC "PTCRYPT1"
+#define CIPHER_HEADER_SIZE 20
+#define CIPHER_TAG_SIZE 16
+// Largest plaintext in one block of a snapshot.
+#define CIPHER_BLOCK_SIZE (64 * 1024)
+#define CIPHER_LAST_BLOCK 0x80000000u
+
+typedef enum {
+    CIPHER_AES_256_GCM = 1,
+    CIPHER_CHACHA20_POLY1305 = 2,
+} CipherId;
+
+/**
+ * @brief Where a sealed file is up to: its header and the index of the
+ * next block.
+ */
+typedef struct {
+    guint8 header[CIPHER_HEADER_SIZE];
+    guint32 next_block;
+} CipherStream;
+
+/**
+ * @brief Tells whether a file starts like a sealed one.
+ */
+static gboolean file_is_sealed(const gchar *data, gsize length) {
+    return length >= CIPHER_HEADER_SIZE && memcmp(data, CIPHER_MAGIC, strlen(CIPHER_MAGIC)) == 0;
+}
+
+#ifdef PROJECT_TRACKER_WITH_CRYPTO
+
+struct _FileCipher {
+    CipherId id;             // Used for new files; existing ones say which they use.
+    guint8 key[32];
+};
+
+static const EVP_CIPHER *file_cipher_evp(CipherId id) {
+    switch (id) {
+    case CIPHER_AES_256_GCM:
+        return EVP_aes_256_gcm();
+    case CIPHER_CHACHA20_POLY1305:
+        return EVP_chacha20_poly1305();
+    }
+    return NULL;
+}
+
+/**
+ * @brief Reads the key named by PROJECT_TRACKER_KEY_FILE.
+ *
+ * @return The cipher, or NULL if no key file is set. Exits if the key
+ * file cannot be read, rather than writing the tasks unsealed.
+ */
+static FileCipher *file_cipher_new_from_env(void) {
+    const gchar *path = g_getenv("PROJECT_TRACKER_KEY_FILE");
+    FileCipher *cipher;
+    gchar *contents = NULL;
+    gsize length = 0;
+
+    if (!path) {
+        return NULL;
+    }
+    if (!g_file_get_contents(path, &contents, &length, NULL)) {
+        g_error("Could not read key file '%s'.", path);
+    }
+    cipher = g_new0(FileCipher, 1);
+    if (length == sizeof(cipher->key)) {
+        memcpy(cipher->key, contents, length);
+    } else {
+        gchar *hex = g_strstrip(contents);
+        if (strlen(hex) != 2 * sizeof(cipher->key)) {
+            g_error("Key file '%s' must hold 32 bytes or 64 hex digits.", path);
+        }
+        for (gsize i = 0; i < sizeof(cipher->key); i++) {
+            gint high = g_ascii_xdigit_value(hex[2 * i]);
+            gint low = g_ascii_xdigit_value(hex[2 * i + 1]);
+            if (high < 0 || low < 0) {
+                g_error("Key file '%s' must hold 32 bytes or 64 hex digits.", path);
+            }
+            cipher->key[i] = high << 4 | low;
+        }
+    }
+    OPENSSL_cleanse(contents, length);
+    g_free(contents);
+
+    cipher->id = CIPHER_CHACHA20_POLY1305;
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("aes") && __builtin_cpu_supports("pclmul")) {
+        cipher->id = CIPHER_AES_256_GCM;
+    }
+#endif
+    return cipher;
+}
+
+static void file_cipher_free(FileCipher *cipher) {
+    if (cipher) {
+        OPENSSL_cleanse(cipher->key, sizeof(cipher->key));
+        g_free(cipher);
+    }
+}
+
+/**
+ * @brief Starts a new sealed file with a fresh random id, appending its
+ * header to @out.
+ */
+static void file_cipher_begin(FileCipher *cipher, CipherStream *stream, GString *out) {
+    memset(stream, 0, sizeof(*stream));
+    memcpy(stream->header, CIPHER_MAGIC, strlen(CIPHER_MAGIC));
+    stream->header[8] = cipher->id;
+    if (RAND_bytes(stream->header + 12, 8) != 1) {
+        g_error("Could not generate a file id.");
+    }
+    g_string_append_len(out, (const gchar *)stream->header, CIPHER_HEADER_SIZE);
+}
+
+static EVP_CIPHER_CTX *file_cipher_context(FileCipher *cipher, const CipherStream *stream, gboolean encrypt) {
+    EVP_CIPHER_CTX *context = EVP_CIPHER_CTX_new();
+    const EVP_CIPHER *evp = file_cipher_evp(stream->header[8]);
+
+    if (!evp || EVP_CipherInit_ex(context, evp, NULL, cipher->key, NULL, encrypt) != 1) {
+        EVP_CIPHER_CTX_free(context);
+        return NULL;
+    }
+    return context;
+}
+
+/**
+ * @brief Sets up @context for the next block of @stream and authenticates
+ * its length word.
+ */
+static gboolean file_cipher_start_block(EVP_CIPHER_CTX *context, const CipherStream *stream, guint32 length_word) {
+    guint8 nonce[12];
+    guint32 index = GUINT32_TO_BE(stream->next_block);
+    int n;
+
+    memcpy(nonce, stream->header + 12, 8);
+    memcpy(nonce + 8, &index, 4);
+    length_word = GUINT32_TO_LE(length_word);
+    return EVP_CipherInit_ex(context, NULL, NULL, NULL, nonce, -1) == 1 &&
+           EVP_CipherUpdate(context, NULL, &n, stream->header, CIPHER_HEADER_SIZE) == 1 &&
+           EVP_CipherUpdate(context, NULL, &n, (const guint8 *)&length_word, 4) == 1;
+}
+
+/**
+ * @brief Seals @data as the next blocks of @stream, appending them to @out.
+ *
+ * @param last TRUE if this is the end of a snapshot.
+ */
+static void file_cipher_seal(FileCipher *cipher, CipherStream *stream, const gchar *data, gsize length,
+                             gboolean last, GString *out) {
+    EVP_CIPHER_CTX *context = file_cipher_context(cipher, stream, TRUE);
+    gsize offset = 0;
+
+    do {
+        gsize chunk = MIN(length - offset, CIPHER_BLOCK_SIZE);
+        guint32 length_word = chunk | (last && offset + chunk == length ? CIPHER_LAST_BLOCK : 0);
+        guint32 le = GUINT32_TO_LE(length_word);
+        gsize start = out->len;
+        int n = 0, final = 0;
+
+        g_string_append_len(out, (const gchar *)&le, 4);
+        g_string_set_size(out, start + 4 + chunk + CIPHER_TAG_SIZE);
+        guint8 *ciphertext = (guint8 *)out->str + start + 4;
+        if (!context || !file_cipher_start_block(context, stream, length_word) ||
+            EVP_CipherUpdate(context, ciphertext, &n, (const guint8 *)data + offset, chunk) != 1 ||
+            EVP_CipherFinal_ex(context, ciphertext + n, &final) != 1 ||
+            EVP_CIPHER_CTX_ctrl(context, EVP_CTRL_AEAD_GET_TAG, CIPHER_TAG_SIZE, ciphertext + chunk) != 1) {
+            g_error("Could not encrypt: %s", ERR_error_string(ERR_get_error(), NULL));
+        }
+        stream->next_block++;
+        offset += chunk;
+    } while (offset < length);
+    EVP_CIPHER_CTX_free(context);
+}
+
+/**
+ * @brief Opens a sealed file, stopping at the first block that is cut
+ * short or fails to authenticate.
+ *
+ * @param stream Receives the file's header and the index after the last
+ * good block, to append to it.
+ * @param sealed_length Receives the length of the good blocks, header
+ * included.
+ * @param last Receives TRUE if the last good block ends a snapshot.
+ * @return The plaintext of the good blocks, or NULL if the header is not
+ * valid. Free with g_free().
+ */
+static gchar *file_cipher_open(FileCipher *cipher, const gchar *data, gsize length, CipherStream *stream,
+                               gsize *plain_length, gsize *sealed_length, gboolean *last) {
+    EVP_CIPHER_CTX *context;
+    GString *plain;
+    gsize offset = CIPHER_HEADER_SIZE;
+
+    *last = FALSE;
+    memset(stream, 0, sizeof(*stream));
+    if (!file_is_sealed(data, length)) {
+        return NULL;
+    }
+    memcpy(stream->header, data, CIPHER_HEADER_SIZE);
+    context = file_cipher_context(cipher, stream, FALSE);
+    if (!context) {
+        return NULL;
+    }
+
+    plain = g_string_sized_new(length);
+    while (length - offset >= 4 + CIPHER_TAG_SIZE && !*last) {
+        guint32 length_word;
+        memcpy(&length_word, data + offset, 4);
+        length_word = GUINT32_FROM_LE(length_word);
+        gsize chunk = length_word & ~CIPHER_LAST_BLOCK;
+        const guint8 *ciphertext = (const guint8 *)data + offset + 4;
+        gsize start = plain->len;
+        int n = 0, final = 0;
+
+        if (chunk > length - offset - 4 - CIPHER_TAG_SIZE) {
+            break;
+        }
+        g_string_set_size(plain, start + chunk);
+        if (!file_cipher_start_block(context, stream, length_word) ||
+            EVP_CipherUpdate(context, (guint8 *)plain->str + start, &n, ciphertext, chunk) != 1 ||
+            EVP_CIPHER_CTX_ctrl(context, EVP_CTRL_AEAD_SET_TAG, CIPHER_TAG_SIZE, (guint8 *)ciphertext + chunk) != 1 ||
+            EVP_CipherFinal_ex(context, (guint8 *)plain->str + start + n, &final) != 1) {
+            g_string_truncate(plain, start);
+            break;
+        }
+        stream->next_block++;
+        offset += 4 + chunk + CIPHER_TAG_SIZE;
+        *last = (length_word & CIPHER_LAST_BLOCK) != 0;
+    }
+    EVP_CIPHER_CTX_free(context);
+
+    *plain_length = plain->len;
+    *sealed_length = offset;
+    return g_string_free(plain, FALSE);
+}
+
+#else
+
+static FileCipher *file_cipher_new_from_env(void) {
+    if (g_getenv("PROJECT_TRACKER_KEY_FILE")) {
+        g_error("PROJECT_TRACKER_KEY_FILE is set, but this build cannot encrypt.");
+    }
+    return NULL;
+}
+
+// Without PROJECT_TRACKER_WITH_CRYPTO there is never a cipher to call these with.
+
+static void file_cipher_free(FileCipher *cipher) {
+}
+
+static void file_cipher_begin(FileCipher *cipher, CipherStream *stream, GString *out) {
+    g_assert_not_reached();
+}
+
+static void file_cipher_seal(FileCipher *cipher, CipherStream *stream, const gchar *data, gsize length,
+                             gboolean last, GString *out) {
+    g_assert_not_reached();
+}
+
+static gchar *file_cipher_open(FileCipher *cipher, const gchar *data, gsize length, CipherStream *stream,
+                               gsize *plain_length, gsize *sealed_length, gboolean *last) {
+    g_assert_not_reached();
+    return NULL;
+}
+
+#endif
+
+// --- Task Writer ---
+
+// Entries in the writer's io_uring: one write and its fsync are in flight at a time.
+#define URING_ENTRIES 2
+
+/**
+ * @brief The kinds of work queued for the writer thread.
+ */
+typedef enum {
+    WRITE_JOURNAL,           // Append records to the journal.
+    WRITE_SNAPSHOT,          // Replace a file atomically, then restart the journal.
+    WRITE_QUIT               // Flush and stop the thread.
+} WriteRequestType;
+
+typedef struct {
+    WriteRequestType type;
+    GString *data;           // Journal records or snapshot contents.
+    gchar *path;             // Destination of a snapshot.
+} WriteRequest;
+
+/**
+ * @brief Moves all disk writes off the main thread.
+ *
+ * Journal records queued while the thread is busy are written together
+ * with one pwrite() and made durable with one fdatasync() (group commit).
+ * Snapshots are written to a temporary file, fsync()ed and renamed into
+ * place, and the journal is then restarted for the new snapshot. With a
+ * cipher, each batch becomes one sealed block and snapshots are sealed
+ * whole, on this thread too.
+ *
+ * Built with io_uring, each write is submitted linked to its fsync, so the
+ * pair costs one system call and the sync only runs if the whole write
+ * went through. Snapshot buffers are registered with the ring for their
+ * write. Without a ring, pwrite() and fsync() are used as before.
+ *
+ * A block's nonce is never used twice. A sealed block that may be partly
+ * on disk, after a failed write or a crash, has spent its nonce, so the
+ * journal is then sealed afresh under a new file id before anything more
+ * is appended to it.
+ */
+struct _TaskWriter {
+    GThread *thread;
+    GAsyncQueue *queue;
+    GMutex lock;
+    gchar *journal_path;
+    int journal_fd;
+    off_t journal_offset;
+    FileCipher *cipher;      // Seals what is written, or NULL.
+    CipherStream journal_stream;
+    GString *journal_plain;  // Plaintext of the sealed journal, to seal it afresh.
+    gboolean journal_torn;   // The journal ends in a block that spent its nonce.
+    gboolean snapshot_failed; // The last snapshot was not written; read once the thread stops.
+#ifdef PROJECT_TRACKER_WITH_URING
+    struct io_uring ring;
+    gboolean ring_ready;     // The ring could be set up; otherwise pwrite() is used.
+#endif
+
+    // Counters, updated by the writer thread under @lock.
+    guint64 logical_bytes;   // Journal bytes handed in by the store.
+    guint64 bytes_written;   // Bytes actually written, snapshots included.
+    guint64 fsync_count;
+    gint64 fsync_total_us;
+    gint64 fsync_max_us;
+};
+
+/**
+ * @brief Returns the journal header that ties the journal to one version of
+ * a snapshot file.
+ *
+ * Renaming a new snapshot into place gives the file a new inode, so a
+ * journal whose header no longer matches was already folded into the
+ * snapshot and must not be replayed again.
+ *
+ * @param path The snapshot file.
+ * @return A newly allocated header line, including the newline.
+ */
+static gchar *snapshot_journal_header(const gchar *path) {
+    struct stat info;
+
+    if (stat(path, &info) != 0) {
+        memset(&info, 0, sizeof(info));
+    }
+    return g_strdup_printf("S\t%lu\t%ld\n", (gulong)info.st_ino, (glong)info.st_size);
+}
+
+/**
+ * @brief Writes a whole buffer at an offset, retrying short writes.
+ *
+ * @return TRUE on success.
+ */
+static gboolean pwrite_all(int fd, const gchar *data, gsize length, off_t offset) {
+    while (length > 0) {
+        ssize_t written = pwrite(fd, data, length, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return FALSE;
+        }
+        data += written;
+        length -= written;
+        offset += written;
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Runs fsync() or fdatasync() and records its latency.
+ */
+static void task_writer_sync(TaskWriter *writer, int fd, gboolean data_only) {
+    gint64 start = g_get_monotonic_time();
+    if ((data_only ? fdatasync(fd) : fsync(fd)) != 0) {
+        g_warning("Could not sync file to disk: %s", g_strerror(errno));
+    }
+    gint64 elapsed = g_get_monotonic_time() - start;
+
+    g_mutex_lock(&writer->lock);
+    writer->fsync_count++;
+    writer->fsync_total_us += elapsed;
+    writer->fsync_max_us = MAX(writer->fsync_max_us, elapsed);
+    g_mutex_unlock(&writer->lock);
+}
+
+/**
+ * @brief Adds to the bytes-written counter.
+ */
+static void task_writer_count_bytes(TaskWriter *writer, gsize length) {
+    g_mutex_lock(&writer->lock);
+    writer->bytes_written += length;
+    g_mutex_unlock(&writer->lock);
+}
+
+#ifdef PROJECT_TRACKER_WITH_URING
+/**
+ * @brief Writes a buffer and syncs the file with one io_uring submission.
+ *
+ * The write is linked to the fsync, so the kernel only starts the sync
+ * once the whole write is done, and drops it if the write fails or comes
+ * up short. The rest of a short write is then finished with pwrite().
+ * The sync latency recorded includes the write.
+ *
+ * @param fixed TRUE to register @data with the ring for the write.
+ * @return TRUE if the data was written, or FALSE with errno set. A failed
+ * sync is only logged, as with task_writer_sync(). If the ring itself
+ * fails, it is shut down and errno is ENOSYS, for the caller to write
+ * with pwrite() instead.
+ */
+static gboolean task_writer_uring_write(TaskWriter *writer, int fd, const gchar *data, gsize length, off_t offset,
+                                        gboolean data_only, gboolean fixed) {
+    struct iovec buffer = { (void *)data, length };
+    struct io_uring_sqe *sqe;
+    struct io_uring_cqe *cqe;
+    int written = -ECANCELED, synced = -ECANCELED;
+
+    // Pinning fails under a low RLIMIT_MEMLOCK; the write then maps the pages itself.
+    fixed = fixed && io_uring_register_buffers(&writer->ring, &buffer, 1) == 0;
+
+    sqe = io_uring_get_sqe(&writer->ring);
+    if (fixed) {
+        io_uring_prep_write_fixed(sqe, fd, data, length, offset, 0);
+    } else {
+        io_uring_prep_write(sqe, fd, data, length, offset);
+    }
+    io_uring_sqe_set_data64(sqe, 0);
+    sqe->flags |= IOSQE_IO_LINK;
+    sqe = io_uring_get_sqe(&writer->ring);
+    io_uring_prep_fsync(sqe, fd, data_only ? IORING_FSYNC_DATASYNC : 0);
+    io_uring_sqe_set_data64(sqe, 1);
+
+    gint64 start = g_get_monotonic_time();
+    int submitted = io_uring_submit_and_wait(&writer->ring, 2);
+    for (int i = 0; i < submitted && io_uring_wait_cqe(&writer->ring, &cqe) == 0; i++) {
+        if (io_uring_cqe_get_data64(cqe) == 0) {
+            written = cqe->res;
+        } else {
+            synced = cqe->res;
+        }
+        io_uring_cqe_seen(&writer->ring, cqe);
+    }
+    gint64 elapsed = g_get_monotonic_time() - start;
+    if (fixed) {
+        io_uring_unregister_buffers(&writer->ring);
+    }
+
+    if (submitted < 2) {
+        // Anything that went through is written again, over the same bytes.
+        g_warning("Could not submit to io_uring: %s", g_strerror(submitted < 0 ? -submitted : EBUSY));
+        io_uring_queue_exit(&writer->ring);
+        writer->ring_ready = FALSE;
+        errno = ENOSYS;
+        return FALSE;
+    }
+    if (written < 0) {
+        errno = -written;
+        return FALSE;
+    }
+    if ((gsize)written < length) {
+        if (!pwrite_all(fd, data + written, length - written, offset + written)) {
+            return FALSE;
+        }
+        task_writer_count_bytes(writer, length);
+        task_writer_sync(writer, fd, data_only);
+        return TRUE;
+    }
+    if (synced < 0) {
+        g_warning("Could not sync file to disk: %s", g_strerror(-synced));
+    }
+    task_writer_count_bytes(writer, length);
+
+    g_mutex_lock(&writer->lock);
+    writer->fsync_count++;
+    writer->fsync_total_us += elapsed;
+    writer->fsync_max_us = MAX(writer->fsync_max_us, elapsed);
+    g_mutex_unlock(&writer->lock);
+    return TRUE;
+}
+#endif
+
+/**
+ * @brief Writes a whole buffer at an offset, makes it durable and counts
+ * the bytes: through io_uring if the writer has a ring, otherwise with
+ * pwrite() and then fsync() or fdatasync().
+ *
+ * @param fixed TRUE if @data is a snapshot, whose buffer is registered with
+ * the ring for the write.
+ * @return TRUE if the data was written, or FALSE with errno set. Nothing is
+ * synced then.
+ */
+static gboolean task_writer_write_synced(TaskWriter *writer, int fd, const gchar *data, gsize length, off_t offset,
+                                         gboolean data_only, gboolean fixed) {
+#ifdef PROJECT_TRACKER_WITH_URING
+    if (writer->ring_ready) {
+        if (task_writer_uring_write(writer, fd, data, length, offset, data_only, fixed)) {
+            return TRUE;
+        }
+        if (writer->ring_ready) {
+            return FALSE;
+        }
+        // The ring broke before the write was sent; fall through to pwrite().
+    }
+#else
+    (void)fixed;
+#endif
+    if (!pwrite_all(fd, data, length, offset)) {
+        return FALSE;
+    }
+    task_writer_count_bytes(writer, length);
+    task_writer_sync(writer, fd, data_only);
+    return TRUE;
+}
+
+/**
+ * @brief Seals the whole sealed journal again under a new file id, and
+ * puts it in place of the old one atomically. If that fails, the journal
+ * stays torn and this is tried again with the next batch.
+ */
+static void task_writer_reseal_journal(TaskWriter *writer) {
+    gchar *tmp_path = g_strconcat(writer->journal_path, ".tmp", NULL);
+    GString *contents = g_string_new(NULL);
+    CipherStream stream;
+    int fd;
+
+    file_cipher_begin(writer->cipher, &stream, contents);
+    file_cipher_seal(writer->cipher, &stream, writer->journal_plain->str, writer->journal_plain->len, FALSE,
+                     contents);
+
+    fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    gboolean ok = fd >= 0 && task_writer_write_synced(writer, fd, contents->str, contents->len, 0, FALSE, FALSE);
+    ok = fd >= 0 && close(fd) == 0 && ok && rename(tmp_path, writer->journal_path) == 0;
+
+    int journal_fd = ok ? open(writer->journal_path, O_WRONLY) : -1;
+    if (journal_fd >= 0) {
+        close(writer->journal_fd);
+        writer->journal_fd = journal_fd;
+        writer->journal_offset = contents->len;
+        writer->journal_stream = stream;
+        writer->journal_torn = FALSE;
+    } else {
+        g_warning("Could not write file '%s': %s", writer->journal_path, g_strerror(errno));
+    }
+    g_free(tmp_path);
+    g_string_free(contents, TRUE);
+}
+
+/**
+ * @brief Writes the pending journal batch and makes it durable.
+ */
+static void task_writer_write_batch(TaskWriter *writer, GString *batch) {
+    GString *sealed = NULL;
+
+    if (batch->len == 0 || writer->journal_fd < 0) {
+        g_string_truncate(batch, 0);
+        return;
+    }
+    if (writer->cipher) {
+        g_string_append_len(writer->journal_plain, batch->str, batch->len);
+        if (writer->journal_torn) {
+            // The batch goes out with the rest of the journal.
+            task_writer_reseal_journal(writer);
+            g_string_truncate(batch, 0);
+            return;
+        }
+        sealed = g_string_sized_new(batch->len + 64);
+        file_cipher_seal(writer->cipher, &writer->journal_stream, batch->str, batch->len, FALSE, sealed);
+    }
+
+    GString *data = sealed ? sealed : batch;
+    if (!task_writer_write_synced(writer, writer->journal_fd, data->str, data->len, writer->journal_offset, TRUE,
+                                  FALSE)) {
+        g_warning("Could not write file '%s': %s", JOURNAL_FILE, g_strerror(errno));
+        // A plain batch is simply written again over the same bytes.
+        writer->journal_torn = writer->cipher != NULL;
+    } else {
+        writer->journal_offset += data->len;
+    }
+    if (sealed) {
+        g_string_free(sealed, TRUE);
+    }
+    g_string_truncate(batch, 0);
+}
+
+/**
+ * @brief Empties the journal and writes a fresh header.
+ */
+static void task_writer_restart_journal(TaskWriter *writer, const gchar *header) {
+    GString *contents;
+
+    if (writer->journal_fd < 0 || ftruncate(writer->journal_fd, 0) != 0) {
+        return;
+    }
+    contents = g_string_new(NULL);
+    if (writer->cipher) {
+        file_cipher_begin(writer->cipher, &writer->journal_stream, contents);
+        file_cipher_seal(writer->cipher, &writer->journal_stream, header, strlen(header), FALSE, contents);
+        g_string_assign(writer->journal_plain, header);
+    } else {
+        g_string_append(contents, header);
+    }
+    writer->journal_offset = 0;
+    writer->journal_torn = FALSE;
+    if (task_writer_write_synced(writer, writer->journal_fd, contents->str, contents->len, 0, TRUE, FALSE)) {
+        writer->journal_offset = contents->len;
+    } else {
+        writer->journal_torn = writer->cipher != NULL;
+        // The truncation still has to reach the disk.
+        task_writer_sync(writer, writer->journal_fd, TRUE);
+    }
+    g_string_free(contents, TRUE);
+}
+
+/**
+ * @brief Replaces a file with new contents via a temporary file and rename.
+ */
+static void task_writer_write_snapshot(TaskWriter *writer, const gchar *path, GString *contents) {
+    gchar *tmp_path = g_strconcat(path, ".tmp", NULL);
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    GString *sealed = NULL;
+
+    if (fd < 0) {
+        g_warning("Could not open file '%s' for writing.", tmp_path);
+        g_free(tmp_path);
+        return;
+    }
+    if (writer->cipher) {
+        CipherStream stream;
+        sealed = g_string_sized_new(contents->len + contents->len / CIPHER_BLOCK_SIZE * 32 + 64);
+        file_cipher_begin(writer->cipher, &stream, sealed);
+        file_cipher_seal(writer->cipher, &stream, contents->str, contents->len, TRUE, sealed);
+        contents = sealed;
+    }
+
+    gboolean ok = task_writer_write_synced(writer, fd, contents->str, contents->len, 0, FALSE, TRUE);
+    ok = close(fd) == 0 && ok && rename(tmp_path, path) == 0;
+    g_free(tmp_path);
+    if (sealed) {
+        g_string_free(sealed, TRUE);
+    }
+
+    writer->snapshot_failed = !ok;
+    if (!ok) {
+        g_warning("Could not write file '%s'.", path);
+        return;
+    }
+
+    // Everything in the journal is now part of the snapshot.
+    gchar *header = snapshot_journal_header(path);
+    task_writer_restart_journal(writer, header);
+    g_free(header);
+}
+
+/**
+ * @brief Body of the writer thread.
+ */
+static gpointer task_writer_thread(gpointer data) {
+    TaskWriter *writer = data;
+    GString *batch = g_string_new(NULL);
+    gboolean quit = FALSE;
+
+    while (!quit) {
+        WriteRequest *request = g_async_queue_pop(writer->queue);
+
+        // Group commit: take everything else that is already queued, too.
+        do {
+            switch (request->type) {
+            case WRITE_JOURNAL:
+                g_string_append_len(batch, request->data->str, request->data->len);
+                break;
+            case WRITE_SNAPSHOT:
+                // Journal records queued before the snapshot go first.
+                task_writer_write_batch(writer, batch);
+                task_writer_write_snapshot(writer, request->path, request->data);
+                break;
+            case WRITE_QUIT:
+                quit = TRUE;
+                break;
+            }
+            if (request->data) {
+                g_string_free(request->data, TRUE);
+            }
+            g_free(request->path);
+            g_free(request);
+        } while (!quit && (request = g_async_queue_try_pop(writer->queue)) != NULL);
+
+        task_writer_write_batch(writer, batch);
+    }
+
+    g_string_free(batch, TRUE);
+    return NULL;
+}
+
+/**
+ * @brief Picks up a sealed journal where its last good block ends, so that
+ * new blocks follow on from it. A block cut short by a crash is dropped,
+ * and the journal sealed afresh, since the block's nonce may be spent.
+ * A plain journal is left alone; it has to be restarted before anything
+ * sealed is appended.
+ */
+static void task_writer_resume_sealed(TaskWriter *writer, const gchar *journal_path) {
+    gchar *contents = NULL;
+    gsize length = 0, plain_length, sealed_length;
+    gboolean last;
+
+    if (!g_file_get_contents(journal_path, &contents, &length, NULL)) {
+        return;
+    }
+    gchar *plain = file_cipher_open(writer->cipher, contents, length, &writer->journal_stream, &plain_length,
+                                    &sealed_length, &last);
+    if (plain) {
+        g_string_append_len(writer->journal_plain, plain, plain_length);
+        writer->journal_offset = sealed_length;
+        // The block cut short may have been written under the next nonce.
+        if (sealed_length < length) {
+            writer->journal_torn = TRUE;
+            task_writer_reseal_journal(writer);
+        }
+    }
+    g_free(plain);
+    g_free(contents);
+}
+
+/**
+ * @brief Opens the journal and starts the writer thread.
+ *
+ * @param journal_path The journal file.
+ * @param header If not NULL, the journal is emptied and restarted with this
+ * header. Otherwise new records are appended to the existing journal.
+ * @param cipher Seals the journal and snapshots, or NULL.
+ * @return A new TaskWriter.
+ */
+TaskWriter *task_writer_new(const gchar *journal_path, const gchar *header, FileCipher *cipher) {
+    TaskWriter *writer = g_new0(TaskWriter, 1);
+
+    writer->cipher = cipher;
+    writer->journal_path = g_strdup(journal_path);
+    writer->journal_plain = g_string_new(NULL);
+    g_mutex_init(&writer->lock);
+    writer->queue = g_async_queue_new();
+#ifdef PROJECT_TRACKER_WITH_URING
+    int error = io_uring_queue_init(URING_ENTRIES, &writer->ring, 0);
+    writer->ring_ready = error == 0;
+    if (error != 0) {
+        g_debug("No io_uring, writing with pwrite(): %s", g_strerror(-error));
+    }
+#endif
+    writer->journal_fd = open(journal_path, O_WRONLY | O_CREAT, 0644);
+    if (writer->journal_fd < 0) {
+        g_warning("Could not open file '%s' for writing.", journal_path);
+    } else if (header) {
+        task_writer_restart_journal(writer, header);
+    } else {
+        writer->journal_offset = lseek(writer->journal_fd, 0, SEEK_END);
+        if (cipher) {
+            task_writer_resume_sealed(writer, journal_path);
+        }
+    }
+    writer->thread = g_thread_new("task-writer", task_writer_thread, writer);
+    return writer;
+}
+
+/**
+ * @brief Queues one transaction's journal records.
+ *
+ * @param writer The task writer.
+ * @param data The records, each terminated by a newline.
+ * @param length The length of @data in bytes.
+ */
+void task_writer_append(TaskWriter *writer, const gchar *data, gsize length) {
+    WriteRequest *request = g_new0(WriteRequest, 1);
+
+    request->type = WRITE_JOURNAL;
+    request->data = g_string_new_len(data, length);
+
+    g_mutex_lock(&writer->lock);
+    writer->logical_bytes += length;
+    g_mutex_unlock(&writer->lock);
+
+    g_async_queue_push(writer->queue, request);
+}
+
+/**
+ * @brief Queues an atomic replacement of @path. The journal is restarted
+ * once the new file is in place.
+ *
+ * @param writer The task writer.
+ * @param path The file to replace.
+ * @param contents The new contents. The writer takes ownership.
+ */
+void task_writer_snapshot(TaskWriter *writer, const gchar *path, GString *contents) {
+    WriteRequest *request = g_new0(WriteRequest, 1);
+
+    request->type = WRITE_SNAPSHOT;
+    request->path = g_strdup(path);
+    request->data = contents;
+    g_async_queue_push(writer->queue, request);
+}
+
+/**
+ * @brief Logs the writer's counters at debug level.
+ *
+ * Write amplification is the number of bytes written to disk, snapshots
+ * included, divided by the journal bytes the store asked to persist.
+ *
+ * @param writer The task writer.
+ */
+static void task_writer_log_stats(TaskWriter *writer) {
+    g_mutex_lock(&writer->lock);
+    g_debug("Writer: %" G_GUINT64_FORMAT " bytes written for %" G_GUINT64_FORMAT
+            " journal bytes (amplification %.2f), %" G_GUINT64_FORMAT
+            " syncs, avg %" G_GINT64_FORMAT " us, max %" G_GINT64_FORMAT " us.",
+            writer->bytes_written, writer->logical_bytes,
+            writer->logical_bytes ? (gdouble)writer->bytes_written / writer->logical_bytes : 0.0,
+            writer->fsync_count,
+            writer->fsync_count ? writer->fsync_total_us / (gint64)writer->fsync_count : 0,
+            writer->fsync_max_us);
+    g_mutex_unlock(&writer->lock);
+}
+
+/**
+ * @brief Writes out everything still queued, stops the writer thread and
+ * closes the journal.
+ *
+ * @param writer The task writer.
+ * @return TRUE unless the last snapshot asked for could not be written.
+ */
+gboolean task_writer_free(TaskWriter *writer) {
+    WriteRequest *request = g_new0(WriteRequest, 1);
+    gboolean saved;
+
+    request->type = WRITE_QUIT;
+    g_async_queue_push(writer->queue, request);
+    g_thread_join(writer->thread);
+    saved = !writer->snapshot_failed;
+
+    task_writer_log_stats(writer);
+    if (writer->journal_fd >= 0) {
+        close(writer->journal_fd);
+    }
+#ifdef PROJECT_TRACKER_WITH_URING
+    if (writer->ring_ready) {
+        io_uring_queue_exit(&writer->ring);
+    }
+#endif
+    g_async_queue_unref(writer->queue);
+    g_mutex_clear(&writer->lock);
+    g_string_free(writer->journal_plain, TRUE);
+    g_free(writer->journal_path);
+    g_free(writer);
+    return saved;
+}
+
+// --- Store Location ---
+
+/*
+ * The store lives in its own directory, so the app finds the same tasks
+ * wherever it is started from:
+ *
+ *   $XDG_DATA_HOME/project-tracker/WORKSPACE/
+ *
+ * WORKSPACE is PROJECT_TRACKER_WORKSPACE, or "default". Setting
+ * PROJECT_TRACKER_DATA_DIR uses that directory instead; "." gives the old
+ * behavior of keeping the files where the app is started. Every file the
+ * store uses is named relative to that directory, which the primary
+ * instance makes its working directory on startup.
+ *
+ * Each store gets its own application id, so starting the app again for
+ * the same store forwards to the instance that has it open. An instance
+ * that cannot be reached that way, for example one in another session,
+ * is kept from writing by LOCK_FILE: the instance holding its lock is the
+ * store's only writer, and any other opens the store read-only. Readers
+ * need no lock, since every file is replaced atomically.
+ */
+
+#define LOCK_FILE "lock"
+#define DEFAULT_WORKSPACE "default"
+
+/**
+ * @brief Returns the workspace named by PROJECT_TRACKER_WORKSPACE, or
+ * DEFAULT_WORKSPACE if it is unset or not a valid name.
+ */
+static const gchar *store_workspace(void) {
+    const gchar *workspace = g_getenv("PROJECT_TRACKER_WORKSPACE");
+    static gboolean warned = FALSE;
+
+    if (!workspace || !*workspace) {
+        return DEFAULT_WORKSPACE;
+    }
+    for (const gchar *p = workspace; *p; p++) {
+        if (!g_ascii_isalnum(*p) && *p != '-' && *p != '_') {
+            if (!warned) {
+                g_warning("Workspace names may only use letters, digits, '-' and '_'. Using '%s'.", DEFAULT_WORKSPACE);
+                warned = TRUE;
+            }
+            return DEFAULT_WORKSPACE;
+        }
+    }
+    return workspace;
+}
+
+/**
+ * @brief Returns the store's directory, as an absolute path.
+ */
+static gchar *store_data_dir(void) {
+    const gchar *override = g_getenv("PROJECT_TRACKER_DATA_DIR");
+
+    if (override && *override) {
+        return g_canonicalize_filename(override, NULL);
+    }
+    return g_build_filename(g_get_user_data_dir(), "project-tracker", store_workspace(), NULL);
+}
+
+/**
+ * @brief Returns the name the store goes by outside its directory: the
+ * workspace, or for PROJECT_TRACKER_DATA_DIR a hash of the directory.
+ */
+static gchar *store_instance_name(void) {
+    if (g_getenv("PROJECT_TRACKER_DATA_DIR") && *g_getenv("PROJECT_TRACKER_DATA_DIR")) {
+        gchar *dir = store_data_dir();
+        gchar *name = g_strdup_printf("dir-%08x", g_str_hash(dir));
+        g_free(dir);
+        return name;
+    }
+    return g_strdup(store_workspace());
+}
+
+/**
+ * @brief Returns the application id for the store, so that only instances
+ * for the same store are forwarded to each other.
+ */
+static gchar *store_application_id(void) {
+    gchar *name = store_instance_name();
+    gchar *id = g_strcmp0(name, DEFAULT_WORKSPACE) == 0 ? g_strdup("org.gtk.todo_list")
+                                                         : g_strdup_printf("org.gtk.todo_list.w_%s", name);
+    g_free(name);
+    return id;
+}
+
+/**
+ * @brief Moves the files of a store kept in the working directory, as
+ * before there were data directories, into @dir if that has no store yet.
+ */
+static void store_adopt_legacy_files(const gchar *dir) {
+    static const gchar *const names[] = { TASKS_FILE, JOURNAL_FILE, VIEWS_FILE, STATUSES_FILE, SQLITE_FILE };
+    gboolean found = FALSE;
+
+    for (guint i = 0; i < G_N_ELEMENTS(names); i++) {
+        gchar *path = g_build_filename(dir, names[i], NULL);
+        if (g_file_test(path, G_FILE_TEST_EXISTS)) {
+            g_free(path);
+            return;
+        }
+        found = found || g_file_test(names[i], G_FILE_TEST_EXISTS);
+        g_free(path);
+    }
+    if (!found) {
+        return;
+    }
+    // Renaming keeps TASKS_FILE's inode, which the journal's header refers to.
+    for (guint i = 0; i < G_N_ELEMENTS(names); i++) {
+        gchar *path = g_build_filename(dir, names[i], NULL);
+        if (g_file_test(names[i], G_FILE_TEST_EXISTS) && rename(names[i], path) != 0) {
+            g_warning("Could not move '%s' to '%s': %s", names[i], path, g_strerror(errno));
+        }
+        g_free(path);
+    }
+    g_print("Moved the tasks in the current directory to '%s'.\n", dir);
+}
+
+/**
+ * @brief Creates the store's directory if needed, makes it the working
+ * directory and takes the store's lock.
+ *
+ * @param store A pointer to the TaskStore. Its read_only flag is set if
+ * another process holds the lock.
+ */
+static void store_enter_data_dir(TaskStore *store) {
+    gchar *dir = store_data_dir();
+
+    if (g_mkdir_with_parents(dir, 0700) != 0) {
+        g_warning("Could not create '%s': %s", dir, g_strerror(errno));
+    } else {
+        if (!g_getenv("PROJECT_TRACKER_DATA_DIR")) {
+            store_adopt_legacy_files(dir);
+        }
+        if (chdir(dir) != 0) {
+            g_warning("Could not open '%s': %s", dir, g_strerror(errno));
+        }
+    }
+    g_free(dir);
+
+    store->lock_fd = open(LOCK_FILE, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (store->lock_fd < 0) {
+        g_warning("Could not open '%s': %s", LOCK_FILE, g_strerror(errno));
+    } else if (flock(store->lock_fd, LOCK_EX | LOCK_NB) != 0) {
+        close(store->lock_fd);
+        store->lock_fd = -1;
+        store->read_only = TRUE;
+        g_print("The tasks are open in another instance; opening them read-only.\n");
+    } else {
+        // For the read-only instances to name the writer.
+        gchar *pid = g_strdup_printf("%d\n", (int)getpid());
+        if (ftruncate(store->lock_fd, 0) != 0 || !pwrite_all(store->lock_fd, pid, strlen(pid), 0)) {
+            g_warning("Could not write '%s': %s", LOCK_FILE, g_strerror(errno));
+        }
+        g_free(pid);
+    }
+}
+
+/**
+ * @brief Returns the process id of the store's writer, as it wrote it in
+ * LOCK_FILE, or 0 if unknown.
+ */
+static gint store_lock_holder(void) {
+    gchar *contents = NULL;
+    gint pid = 0;
+
+    if (g_file_get_contents(LOCK_FILE, &contents, NULL, NULL)) {
+        pid = atoi(contents);
+        g_free(contents);
+    }
+    return pid;
+}
+
+// --- Warm Start ---
+
+/*
+ * A clean shutdown leaves an image of the loaded store next to the task
+ * file: the fields of every task in the layout of TaskColumns, the texts,
+ * and the tag index as lists of task positions. Everything in it is an
+ * offset from the start of the file, so the next launch maps it and takes
+ * the store from it without parsing a line or extracting a tag. The image
+ * names the version of TASKS_FILE it was written for (inode, size and
+ * modification time); if the task file has changed since, the image is
+ * ignored and the task file is parsed as usual. The journal is replayed on
+ * top either way.
+ *
+ * Layout, each part starting on an 8-byte boundary:
+ *
+ *   WarmImageHeader
+ *   guint64 done[(n_tasks + 63) / 64]
+ *   guint32 due[n_tasks], start[n_tasks]
+ *   guint8 priority[n_tasks], status[n_tasks], reopen_status[n_tasks]
+ *   guint64 texts[n_tasks + 1]        heap offsets; texts[i + 1] ends task i
+ *   guint64 tag_names[n_tags]         heap offsets
+ *   guint32 tag_starts[n_tags + 1]    tag i owns members[tag_starts[i]..]
+ *   guint32 members[n_members]        task positions
+ *   gchar heap[heap_length]           NUL-terminated strings
+ */
+
+#define IMAGE_MAGIC "PTIMAGE"
+// Bumped whenever the layout changes, or what the loader derives from a
+// line (fields, tags) does.
+#define IMAGE_VERSION 2
+
+typedef struct {
+    gchar magic[8];          // IMAGE_MAGIC, NUL-terminated.
+    guint32 version;         // IMAGE_VERSION.
+    guint32 n_tasks;
+    guint64 source_inode;    // The TASKS_FILE the image stands in for.
+    guint64 source_size;
+    gint64 source_mtime;     // In nanoseconds.
+    guint32 n_tags;
+    guint32 n_members;       // Tasks under all tags together.
+    guint64 heap_length;
+    guint64 length;          // Of the whole image.
+} WarmImageHeader;
+
+/**
+ * @brief Offsets of the parts of an image.
+ */
+typedef struct {
+    gsize done, due, start, priority, status, reopen_status, texts, tag_names, tag_starts, members, heap, length;
+} WarmImageLayout;
+
+#define IMAGE_ALIGN(offset) (((offset) + 7) & ~(gsize)7)
+
+/**
+ * @brief Places the parts of an image with the counts in @header.
+ */
+static void warm_image_layout(const WarmImageHeader *header, WarmImageLayout *layout) {
+    gsize n = header->n_tasks;
+    gsize offset = sizeof(WarmImageHeader);
+
+    layout->done = offset;
+    offset += (n + COLUMN_WORD_BITS - 1) / COLUMN_WORD_BITS * sizeof(guint64);
+    layout->due = offset;
+    offset = IMAGE_ALIGN(offset + n * sizeof(guint32));
+    layout->start = offset;
+    offset = IMAGE_ALIGN(offset + n * sizeof(guint32));
+    layout->priority = offset;
+    layout->status = offset + n;
+    layout->reopen_status = offset + 2 * n;
+    offset = IMAGE_ALIGN(offset + 3 * n);
+    layout->texts = offset;
+    offset += (n + 1) * sizeof(guint64);
+    layout->tag_names = offset;
+    offset += header->n_tags * sizeof(guint64);
+    layout->tag_starts = offset;
+    offset = IMAGE_ALIGN(offset + (header->n_tags + 1) * sizeof(guint32));
+    layout->members = offset;
+    offset = IMAGE_ALIGN(offset + header->n_members * sizeof(guint32));
+    layout->heap = offset;
+    layout->length = offset + header->heap_length;
+}
+
+/**
+ * @brief Reads the version of TASKS_FILE an image has to match.
+ *
+ * @return FALSE if there is no task file.
+ */
+static gboolean warm_image_source(WarmImageHeader *header) {
+    struct stat info;
+
+    if (stat(TASKS_FILE, &info) != 0) {
+        return FALSE;
+    }
+    header->source_inode = info.st_ino;
+    header->source_size = info.st_size;
+    header->source_mtime = (gint64)info.st_mtim.tv_sec * G_GINT64_CONSTANT(1000000000) + info.st_mtim.tv_nsec;
+    return TRUE;
+}
+
+/**
+ * @brief Checks that a heap offset starts a string that ends in the heap.
+ */
+static gboolean warm_image_string_ok(const gchar *heap, guint64 heap_length, guint64 offset) {
+    return offset < heap_length && memchr(heap + offset, '\0', heap_length - offset) != NULL;
+}
+
+/**
+ * @brief Checks that a mapped image belongs to the current task file and
+ * that every offset and position in it stays inside it.
+ */
+static gboolean warm_image_check(const gchar *data, gsize length, WarmImageLayout *layout) {
+    const WarmImageHeader *header = (const WarmImageHeader *)data;
+    WarmImageHeader source;
+
+    if (length < sizeof(WarmImageHeader) || memcmp(header->magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0 ||
+        header->version != IMAGE_VERSION || header->length != length || header->heap_length > length) {
+        return FALSE;
+    }
+    if (!warm_image_source(&source) || source.source_inode != header->source_inode ||
+        source.source_size != header->source_size || source.source_mtime != header->source_mtime) {
+        return FALSE;
+    }
+    warm_image_layout(header, layout);
+    if (layout->length != length) {
+        return FALSE;
+    }
+
+    const gchar *heap = data + layout->heap;
+    const guint64 *texts = (const guint64 *)(data + layout->texts);
+    for (guint i = 0; i < header->n_tasks; i++) {
+        if (texts[i] >= texts[i + 1] || texts[i + 1] > header->heap_length || heap[texts[i + 1] - 1] != '\0') {
+            return FALSE;
+        }
+    }
+
+    const guint64 *tag_names = (const guint64 *)(data + layout->tag_names);
+    const guint32 *tag_starts = (const guint32 *)(data + layout->tag_starts);
+    const guint32 *members = (const guint32 *)(data + layout->members);
+    if (tag_starts[0] != 0 || tag_starts[header->n_tags] != header->n_members) {
+        return FALSE;
+    }
+    for (guint i = 0; i < header->n_tags; i++) {
+        if (tag_starts[i] > tag_starts[i + 1] || !warm_image_string_ok(heap, header->heap_length, tag_names[i])) {
+            return FALSE;
+        }
+    }
+    for (guint i = 0; i < header->n_members; i++) {
+        if (members[i] >= header->n_tasks) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Fills the empty store from IMAGE_FILE, if it is there and still
+ * belongs to the task file.
+ *
+ * The store's columns are copied from the image whole, and each tag's set
+ * is filled straight from its list of positions.
+ *
+ * @param store A pointer to the TaskStore, which must be empty.
+ * @return TRUE if the store was loaded from the image.
+ */
+static gboolean warm_image_load(TaskStore *store) {
+    gint64 start_time = g_get_monotonic_time();
+    GMappedFile *mapped = g_mapped_file_new(IMAGE_FILE, FALSE, NULL);
+    WarmImageLayout layout;
+
+    if (!mapped) {
+        return FALSE;
+    }
+    const gchar *data = g_mapped_file_get_contents(mapped);
+    gsize length = g_mapped_file_get_length(mapped);
+    if (!data || !warm_image_check(data, length, &layout)) {
+        g_debug("'%s' does not match '%s'; parsing the task file.", IMAGE_FILE, TASKS_FILE);
+        g_mapped_file_unref(mapped);
+        return FALSE;
+    }
+
+    const WarmImageHeader *header = (const WarmImageHeader *)data;
+    const gchar *heap = data + layout.heap;
+    const guint64 *texts = (const guint64 *)(data + layout.texts);
+    const guint32 *start = (const guint32 *)(data + layout.start);
+    const guint8 *reopen_status = (const guint8 *)(data + layout.reopen_status);
+    TaskColumns *columns = &store->columns;
+    guint n = header->n_tasks;
+    guint words = (n + COLUMN_WORD_BITS - 1) / COLUMN_WORD_BITS;
+
+    task_columns_reserve(columns, n);
+    memcpy(columns->done, data + layout.done, words * sizeof(guint64));
+    if (n % COLUMN_WORD_BITS != 0) {
+        columns->done[words - 1] &= column_bits_below(n);
+    }
+    memcpy(columns->due, data + layout.due, n * sizeof(guint32));
+    memcpy(columns->priority, data + layout.priority, n);
+    memcpy(columns->status, data + layout.status, n);
+
+    g_ptr_array_set_size(store->tasks, n);
+    for (guint i = 0; i < n; i++) {
+        Task *task = g_new0(Task, 1);
+        task->id = ++store->next_id;
+        task->text = g_strndup(heap + texts[i], texts[i + 1] - texts[i] - 1);
+        task->is_completed = (columns->done[i / COLUMN_WORD_BITS] >> (i % COLUMN_WORD_BITS)) & 1;
+        task->status = columns->status[i];
+        if (task->is_completed) {
+            task->status = columns->status[i] = TASK_STATUS_DONE;
+        } else if (task->status >= store->statuses->len || task->status == TASK_STATUS_DONE) {
+            // The custom status was removed from STATUSES_FILE.
+            task->status = columns->status[i] = TASK_STATUS_TODO;
+        }
+        if (task->is_completed && reopen_status[i] < store->statuses->len && reopen_status[i] != TASK_STATUS_DONE) {
+            task->reopen_status = reopen_status[i];
+        }
+        task->due = columns->due[i];
+        task->start = start[i];
+        task->priority = columns->priority[i];
+        g_ptr_array_index(store->tasks, i) = task;
+    }
+    columns->length = n;
+    columns->n_done = task_columns_count_done(columns, 0, n);
+
+    const guint64 *tag_names = (const guint64 *)(data + layout.tag_names);
+    const guint32 *tag_starts = (const guint32 *)(data + layout.tag_starts);
+    const guint32 *members = (const guint32 *)(data + layout.members);
+    for (guint i = 0; i < header->n_tags; i++) {
+        GHashTable *tasks = g_hash_table_new(g_direct_hash, g_direct_equal);
+        for (guint j = tag_starts[i]; j < tag_starts[i + 1]; j++) {
+            g_hash_table_add(tasks, g_ptr_array_index(store->tasks, members[j]));
+        }
+        g_hash_table_insert(store->tag_index, g_strdup(heap + tag_names[i]), tasks);
+    }
+
+    g_debug("Mapped %u tasks and %u tags from '%s' in %" G_GINT64_FORMAT " us.", n, header->n_tags,
+            IMAGE_FILE, g_get_monotonic_time() - start_time);
+    g_mapped_file_unref(mapped);
+    return TRUE;
+}
+
+static gint compare_guint32(gconstpointer a, gconstpointer b) {
+    guint32 va = *(const guint32 *)a;
+    guint32 vb = *(const guint32 *)b;
+    return (va > vb) - (va < vb);
+}
+
+/**
+ * @brief Writes IMAGE_FILE for the store as it is now. Only call this when
+ * the store holds exactly what TASKS_FILE holds, i.e. right after a
+ * snapshot with nothing committed since.
+ *
+ * @param store A pointer to the TaskStore.
+ */
+static void warm_image_save(TaskStore *store) {
+    WarmImageHeader header = { IMAGE_MAGIC, IMAGE_VERSION };
+    WarmImageLayout layout;
+    GHashTable *positions = g_hash_table_new(g_direct_hash, g_direct_equal);
+    GHashTableIter iter;
+    gpointer tag, tasks;
+    GError *error = NULL;
+    guint n = store->tasks->len;
+
+    if (!warm_image_source(&header)) {
+        g_hash_table_unref(positions);
+        return;
+    }
+    header.n_tasks = n;
+    header.n_tags = g_hash_table_size(store->tag_index);
+    for (guint i = 0; i < n; i++) {
+        Task *task = task_store_get(store, i);
+        g_hash_table_insert(positions, task, GUINT_TO_POINTER(i));
+        header.heap_length += strlen(task->text) + 1;
+    }
+    g_hash_table_iter_init(&iter, store->tag_index);
+    while (g_hash_table_iter_next(&iter, &tag, &tasks)) {
+        header.n_members += g_hash_table_size(tasks);
+        header.heap_length += strlen(tag) + 1;
+    }
+    warm_image_layout(&header, &layout);
+    header.length = layout.length;
+
+    gchar *data = g_malloc0(layout.length);
+    guint64 *done = (guint64 *)(data + layout.done);
+    guint32 *due = (guint32 *)(data + layout.due);
+    guint32 *start = (guint32 *)(data + layout.start);
+    guint64 *texts = (guint64 *)(data + layout.texts);
+    gchar *heap = data + layout.heap;
+    guint64 heap_used = 0;
+
+    memcpy(data, &header, sizeof(header));
+    for (guint i = 0; i < n; i++) {
+        Task *task = task_store_get(store, i);
+        gsize text_length = strlen(task->text) + 1;
+
+        if (task->is_completed) {
+            done[i / COLUMN_WORD_BITS] |= G_GUINT64_CONSTANT(1) << (i % COLUMN_WORD_BITS);
+        }
+        due[i] = task->due;
+        start[i] = task->start;
+        ((guint8 *)data + layout.priority)[i] = task->priority;
+        ((guint8 *)data + layout.status)[i] = task->status;
+        ((guint8 *)data + layout.reopen_status)[i] = task->reopen_status;
+        texts[i] = heap_used;
+        memcpy(heap + heap_used, task->text, text_length);
+        heap_used += text_length;
+    }
+    texts[n] = heap_used;
+
+    guint64 *tag_names = (guint64 *)(data + layout.tag_names);
+    guint32 *tag_starts = (guint32 *)(data + layout.tag_starts);
+    guint32 *members = (guint32 *)(data + layout.members);
+    guint tag_count = 0, member_count = 0;
+    g_hash_table_iter_init(&iter, store->tag_index);
+    while (g_hash_table_iter_next(&iter, &tag, &tasks)) {
+        GHashTableIter task_iter;
+        gpointer task;
+        gsize tag_length = strlen(tag) + 1;
+
+        tag_names[tag_count] = heap_used;
+        memcpy(heap + heap_used, tag, tag_length);
+        heap_used += tag_length;
+        tag_starts[tag_count++] = member_count;
+
+        guint first = member_count;
+        g_hash_table_iter_init(&task_iter, tasks);
+        while (g_hash_table_iter_next(&task_iter, &task, NULL)) {
+            members[member_count++] = GPOINTER_TO_UINT(g_hash_table_lookup(positions, task));
+        }
+        // In store order, so the image depends only on the store.
+        qsort(members + first, member_count - first, sizeof(guint32), compare_guint32);
+    }
+    tag_starts[tag_count] = member_count;
+
+    if (!g_file_set_contents(IMAGE_FILE, data, layout.length, &error)) {
+        g_warning("Could not save '%s': %s", IMAGE_FILE, error->message);
+        g_error_free(error);
+    }
+    g_free(data);
+    g_hash_table_unref(positions);
+}
+
+// --- Persistence ---
+
+/**
+ * @brief Saves all tasks from the store to a file.
+ *
+ * This function formats the completion status and text of every task and
+ * hands the result to the writer thread, which replaces "tasks.txt"
+ * atomically and then truncates the journal. An open task in a status
+ * other than "To Do" gets it appended as "0:1;text", and a completed task
+ * the status it reopens to as "1:1;text"; older versions still read both
+ * as the completion alone.
+ *
+ * @param store A pointer to the TaskStore.
+ */
+void save_tasks_to_file(TaskStore *store) {
+    GString *contents = g_string_new(NULL);
+
+    for (guint i = 0; i < store->tasks->len; i++) {
+        Task *task = task_store_get(store, i);
+        guint status = task->is_completed ? task->reopen_status : task->status;
+        if (status == TASK_STATUS_TODO) {
+            g_string_append_printf(contents, "%d;%s\n", task->is_completed, task->text);
+        } else {
+            g_string_append_printf(contents, "%d:%u;%s\n", task->is_completed, status, task->text);
+        }
+    }
+
+    task_writer_snapshot(store->writer, TASKS_FILE, contents);
+    store->journal_records = 0;
+}
+
+/**
+ * @brief Loads the custom statuses from STATUSES_FILE, one name per line.
+ * They follow the built-in statuses, in file order.
+ *
+ * @param store A pointer to the TaskStore.
+ */
+static void load_task_statuses(TaskStore *store) {
+    gchar *contents = NULL;
+    gchar **lines;
+
+    if (!g_file_get_contents(STATUSES_FILE, &contents, NULL, NULL)) {
+        return;
+    }
+    lines = g_strsplit(contents, "\n", -1);
+    for (guint i = 0; lines[i] && store->statuses->len < TASK_STATUS_MAX; i++) {
+        gchar *name = g_strstrip(lines[i]);
+        if (*name && g_utf8_validate(name, -1, NULL) && task_store_find_status(store, name) < 0) {
+            g_ptr_array_add(store->statuses, g_strdup(name));
+        }
+    }
+    g_strfreev(lines);
+    g_free(contents);
+}
+
+/**
+ * @brief Writes the custom statuses to STATUSES_FILE.
+ *
+ * @param store A pointer to the TaskStore.
+ */
+static void save_task_statuses(TaskStore *store) {
+    GString *contents;
+    GError *error = NULL;
+
+    if (store->read_only) {
+        return;
+    }
+    contents = g_string_new(NULL);
+    for (guint i = TASK_STATUS_N_BUILTIN; i < store->statuses->len; i++) {
+        g_string_append_printf(contents, "%s\n", (const gchar *)g_ptr_array_index(store->statuses, i));
+    }
+    if (!g_file_set_contents(STATUSES_FILE, contents->str, contents->len, &error)) {
+        g_warning("Could not save statuses: %s", error->message);
+        g_error_free(error);
+    }
+    g_string_free(contents, TRUE);
+}
+
+/**
+ * @brief Adds a custom status and saves the list.
+ *
+ * @param store A pointer to the TaskStore.
+ * @param name The status name.
+ * @return The new status index, or -1 if the name is taken or there is no
+ * room for another status.
+ */
+static gint task_store_add_status(TaskStore *store, const gchar *name) {
+    if (store->statuses->len >= TASK_STATUS_MAX || task_store_find_status(store, name) >= 0) {
+        return -1;
+    }
+    g_ptr_array_add(store->statuses, g_strdup(name));
+    save_task_statuses(store);
+    return store->statuses->len - 1;
+}
+
+// Files smaller than this are parsed on the calling thread.
+#define PARALLEL_LOAD_MIN_BYTES (4 * 1024 * 1024)
+// Chunks per worker thread, so that uneven chunks still balance out.
+#define PARALLEL_LOAD_CHUNKS_PER_THREAD 4
+
+/**
+ * @brief A slice of the mapped task file, parsed by one worker.
+ */
+typedef struct {
+    const gchar *start;
+    const gchar *end;
+    GPtrArray *tasks;        // Parsed Task pointers, in file order.
+    guint repaired;          // Lines whose text was not valid UTF-8.
+} LoadChunk;
+
+/**
+ * @brief Returns the length of the valid UTF-8 sequence starting at @p, or 0
+ * if the bytes there are not valid UTF-8 (including overlong forms,
+ * surrogates, code points above U+10FFFF and NUL).
+ */
+static gsize utf8_sequence_length(const guchar *p, const guchar *end) {
+    guchar c = p[0];
+    gsize needed;
+
+    if (c >= 0x01 && c < 0x80) {
+        return 1;
+    } else if (c >= 0xC2 && c < 0xE0) {
+        needed = 2;
+    } else if (c >= 0xE0 && c < 0xF0) {
+        needed = 3;
+    } else if (c >= 0xF0 && c < 0xF5) {
+        needed = 4;
+    } else {
+        return 0;
+    }
+
+    if ((gsize)(end - p) < needed) {
+        return 0;
+    }
+    // The second byte has a narrower range for a few lead bytes.
+    if ((c == 0xE0 && p[1] < 0xA0) || (c == 0xED && p[1] >= 0xA0) ||
+        (c == 0xF0 && p[1] < 0x90) || (c == 0xF4 && p[1] >= 0x90)) {
+        return 0;
+    }
+    for (gsize i = 1; i < needed; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+    }
+    return needed;
+}
+
+#if defined(__SSSE3__)
+/*
+ * Validates 16 bytes at a time, ASCII or not, after Keiser and Lemire,
+ * "Validating UTF-8 In Less Than One Instruction Per Byte". Each byte is
+ * looked up three times by nibble: the high and low nibble of the byte
+ * before it, and its own high nibble. Each lookup gives the set of errors
+ * that nibble allows, so a pair of bytes is wrong where all three agree.
+ * The bit UTF8_TWO_CONTS, two continuation bytes in a row, is expected
+ * exactly where the byte two or three back began a longer sequence.
+ */
+
+#define UTF8_TOO_SHORT (1 << 0)      // 11______ 0_______ or 11______ 11______
+#define UTF8_TOO_LONG (1 << 1)       // 0_______ 10______
+#define UTF8_OVERLONG_3 (1 << 2)     // 11100000 100_____
+#define UTF8_TOO_LARGE (1 << 3)      // 11110100 1001____ and above
+#define UTF8_SURROGATE (1 << 4)      // 11101101 101_____
+#define UTF8_OVERLONG_2 (1 << 5)     // 1100000_ 10______
+#define UTF8_TOO_LARGE_1000 (1 << 6) // 11110101 1000____ and above
+#define UTF8_OVERLONG_4 (1 << 6)     // 11110000 1000____
+#define UTF8_TWO_CONTS (1 << 7)      // 10______ 10______
+// Errors decided by the first byte's high nibble alone.
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+/**
+ * @brief Returns the bytes of @input, with @previous the 16 bytes before
+ * it, that are in error or are a continuation byte no lead asked for.
+ */
+static inline __m128i utf8_block_errors(__m128i input, __m128i previous) {
+    const __m128i low_nibble = _mm_set1_epi8(0x0F);
+    const __m128i byte_1_high_table = _mm_setr_epi8(
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+        UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+        UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+        UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4);
+    const __m128i byte_1_low_table = _mm_setr_epi8(
+        UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+        UTF8_CARRY | UTF8_OVERLONG_2,
+        UTF8_CARRY,
+        UTF8_CARRY,
+        UTF8_CARRY | UTF8_TOO_LARGE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000);
+    const __m128i byte_2_high_table = _mm_setr_epi8(
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT);
+
+    __m128i prev1 = _mm_alignr_epi8(input, previous, 15);
+    __m128i prev2 = _mm_alignr_epi8(input, previous, 14);
+    __m128i prev3 = _mm_alignr_epi8(input, previous, 13);
+    __m128i byte_1_high = _mm_shuffle_epi8(byte_1_high_table, _mm_and_si128(_mm_srli_epi16(prev1, 4), low_nibble));
+    __m128i byte_1_low = _mm_shuffle_epi8(byte_1_low_table, _mm_and_si128(prev1, low_nibble));
+    __m128i byte_2_high = _mm_shuffle_epi8(byte_2_high_table, _mm_and_si128(_mm_srli_epi16(input, 4), low_nibble));
+    __m128i special = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+    // The high bit is set where the byte two back is 111_____, or three back 1111____.
+    __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80));
+    __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80));
+    __m128i must_continue = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(0x80));
+    return _mm_xor_si128(must_continue, special);
+}
+
+/**
+ * @brief Skips the valid UTF-8 at the start of a buffer, 16 bytes at a time.
+ *
+ * @return The start of the character holding the first error, or of one
+ * shortly before it, or where fewer than 16 bytes are left. Everything
+ * before it is valid.
+ */
+static const guchar *utf8_skip_valid(const guchar *p, const guchar *stop) {
+    const guchar *start = p;
+    const __m128i zero = _mm_setzero_si128();
+    // Where the last three bytes of a block must still be followed by more.
+    const __m128i incomplete_above = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                   0xF0 - 1, 0xE0 - 1, 0xC0 - 1);
+    __m128i previous = zero;
+    __m128i incomplete = zero;
+
+    while (stop - p >= 16) {
+        __m128i input = _mm_loadu_si128((const __m128i *)p);
+        // A NUL is as invalid as a bad sequence.
+        __m128i errors = _mm_cmpeq_epi8(input, zero);
+
+        if (_mm_movemask_epi8(input) == 0) {
+            // ASCII: only a sequence cut short before it can be wrong.
+            errors = _mm_or_si128(errors, incomplete);
+            incomplete = zero;
+        } else {
+            errors = _mm_or_si128(errors, utf8_block_errors(input, previous));
+            incomplete = _mm_subs_epu8(input, incomplete_above);
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(errors, zero)) != 0xFFFF) {
+            break;
+        }
+        previous = input;
+        p += 16;
+    }
+
+    // Back up to the lead byte of a character the block boundary cuts.
+    const guchar *boundary = p;
+    while (boundary > start && p - boundary < 3 && (boundary[-1] & 0xC0) == 0x80) {
+        boundary--;
+    }
+    if (boundary > start && boundary[-1] >= 0xC0) {
+        boundary--;
+    }
+    return boundary;
+}
+#endif
+
+/**
+ * @brief Finds the first byte that is not part of valid UTF-8 text.
+ *
+ * With SSSE3 the text is validated 16 bytes at a time, and the first
+ * error is then found byte by byte from the character before it.
+ * Otherwise runs of plain ASCII are skipped 16 bytes at a time with SSE2
+ * (or 8 bytes at a time with word operations elsewhere), and only
+ * non-ASCII sequences are decoded byte by byte.
+ *
+ * @param start The start of the buffer.
+ * @param end The end of the buffer.
+ * @return A pointer to the first invalid byte, or @end if the buffer is valid.
+ */
+static const gchar *utf8_find_invalid(const gchar *start, const gchar *end) {
+    const guchar *p = (const guchar *)start;
+    const guchar *stop = (const guchar *)end;
+
+#if defined(__SSSE3__)
+    p = utf8_skip_valid(p, stop);
+#endif
+    while (p < stop) {
+#if defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        while (stop - p >= 16) {
+            __m128i block = _mm_loadu_si128((const __m128i *)p);
+            // Any high bit means non-ASCII; any zero byte is an embedded NUL.
+            if (_mm_movemask_epi8(_mm_or_si128(block, _mm_cmpeq_epi8(block, zero))) != 0) {
+                break;
+            }
+            p += 16;
+        }
+#else
+        const guint64 ones = G_GUINT64_CONSTANT(0x0101010101010101);
+        const guint64 highs = G_GUINT64_CONSTANT(0x8080808080808080);
+        while (stop - p >= 8) {
+            guint64 word;
+            memcpy(&word, p, sizeof(word));
+            if (((word | ((word - ones) & ~word)) & highs) != 0) {
+                break;
+            }
+            p += 8;
+        }
+#endif
+        if (p == stop) {
+            break;
+        }
+        gsize length = utf8_sequence_length(p, stop);
+        if (length == 0) {
+            return (const gchar *)p;
+        }
+        p += length;
+    }
+    return end;
+}
+
+/**
+ * @brief Parses one line of the task file.
+ *
+ * The line format is "completion_status;task_text", where the completion
+ * may be followed by ":status" for a task in a status other than "To Do"
+ * or "Done", or for a completed task, the status it goes back to when
+ * reopened if that is not "To Do". A line without a semicolon is taken as
+ * the text of an open task.
+ *
+ * @param line The start of the line.
+ * @param end The end of the line, excluding the newline.
+ * @param repair TRUE if the line is not valid UTF-8. Invalid bytes in the
+ * text, which GTK labels cannot display, are then replaced with U+FFFD.
+ * @return A newly allocated Task.
+ */
+static Task *parse_task_line(const gchar *line, const gchar *end, gboolean repair) {
+    Task *task = g_new0(Task, 1);
+    const gchar *semicolon_pos = memchr(line, ';', end - line);
+
+    if (semicolon_pos) {
+        // Equivalent to atoi() on the status field.
+        const gchar *p = line;
+        gint64 status = 0;
+        while (p < semicolon_pos && g_ascii_isspace(*p)) {
+            p++;
+        }
+        gboolean negative = p < semicolon_pos && *p == '-';
+        if (p < semicolon_pos && (*p == '-' || *p == '+')) {
+            p++;
+        }
+        while (p < semicolon_pos && g_ascii_isdigit(*p) && status <= G_MAXINT) {
+            status = status * 10 + (*p++ - '0');
+        }
+        task->is_completed = !negative && status == 1;
+        task->status = task_status_for_completion(task->is_completed);
+        if (p < semicolon_pos && *p == ':') {
+            // Checked against the store's statuses once the chunks are joined.
+            guint custom = 0;
+            for (p++; p < semicolon_pos && g_ascii_isdigit(*p) && custom < TASK_STATUS_MAX; p++) {
+                custom = custom * 10 + (*p - '0');
+            }
+            if (custom < TASK_STATUS_MAX && custom != TASK_STATUS_DONE) {
+                if (task->is_completed) {
+                    task->reopen_status = custom;
+                } else {
+                    task->status = custom;
+                }
+            }
+        }
+        line = semicolon_pos + 1;
+    }
+    task->text = repair ? g_utf8_make_valid(line, end - line) : g_strndup(line, end - line);
+    task_parse_fields(task);
+    return task;
+}
+
+/**
+ * @brief Parses every line in a chunk. Runs on a worker thread.
+ *
+ * @param data A pointer to the LoadChunk.
+ * @param user_data Unused.
+ */
+static void parse_load_chunk(gpointer data, gpointer user_data) {
+    LoadChunk *chunk = data;
+    const gchar *line = chunk->start;
+    // The whole chunk is validated up front; lines are only looked at again
+    // when they contain an invalid byte.
+    const gchar *invalid = utf8_find_invalid(chunk->start, chunk->end);
+
+    while (line < chunk->end) {
+        const gchar *newline_pos = memchr(line, '\n', chunk->end - line);
+        const gchar *line_end = newline_pos ? newline_pos : chunk->end;
+        gboolean repair = invalid < line_end;
+
+        g_ptr_array_add(chunk->tasks, parse_task_line(line, line_end, repair));
+        if (repair) {
+            chunk->repaired++;
+            invalid = utf8_find_invalid(line_end, chunk->end);
+        }
+        line = line_end + 1;
+    }
+}
+
+/**
+ * @brief Returns the number of threads used to parse the task file.
+ *
+ * Defaults to the number of processors; PROJECT_TRACKER_LOAD_THREADS
+ * overrides it, which is handy for measuring how loading scales.
+ */
+static guint get_load_thread_count(void) {
+    const gchar *override = g_getenv("PROJECT_TRACKER_LOAD_THREADS");
+    guint n_threads = override ? (guint)g_ascii_strtoull(override, NULL, 10) : g_get_num_processors();
+    return MAX(n_threads, 1);
+}
+
+/**
+ * @brief Decrypts a sealed task file or journal. Exits if there is no key,
+ * or the file does not open with it, rather than lose tasks by starting
+ * over.
+ *
+ * @param store A pointer to the TaskStore.
+ * @param snapshot TRUE for a task file, which must be complete. A journal
+ * may end in a block cut short by a crash.
+ * @return The plaintext, NUL-terminated. Free with g_free().
+ */
+static gchar *open_sealed_file(TaskStore *store, const gchar *path, const gchar *data, gsize length,
+                               gsize *plain_length, gboolean snapshot) {
+    CipherStream stream;
+    gsize sealed_length = 0;
+    gboolean last = FALSE;
+    gchar *plain;
+
+    if (!store->cipher) {
+        g_error("'%s' is encrypted; set PROJECT_TRACKER_KEY_FILE to its key file.", path);
+    }
+    plain = file_cipher_open(store->cipher, data, length, &stream, plain_length, &sealed_length, &last);
+
+    // A block that is all there but did not open means the wrong key, or damage.
+    gboolean failed = !plain;
+    if (plain && sealed_length + 4 + CIPHER_TAG_SIZE <= length) {
+        guint32 length_word;
+        memcpy(&length_word, data + sealed_length, 4);
+        failed = (GUINT32_FROM_LE(length_word) & ~CIPHER_LAST_BLOCK) <= length - sealed_length - 4 - CIPHER_TAG_SIZE;
+    }
+    if (failed || (snapshot && (!last || sealed_length != length))) {
+        g_error("Could not decrypt '%s': wrong key, or the file is damaged.", path);
+    }
+    return plain;
+}
+
+/**
+ * @brief Reads the task file and its journal into the store, writing
+ * nothing.
+ *
+ * This function maps "tasks.txt" into memory, splits it at newline
+ * boundaries into chunks and parses the chunks on a thread pool. The
+ * per-chunk task arrays are then stitched into the store in file order,
+ * each at the offset given by the prefix sum of the chunks before it.
+ * Any records left in the journal by a session that did not shut down
+ * cleanly are then replayed on top. Sealed files are decrypted first,
+ * with the store's cipher. When the last session left an image of this
+ * very task file, the store is taken from the image instead of parsing.
+ *
+ * @param store A pointer to the TaskStore.
+ * @param reseal Set to TRUE if a file was found plain although there is a
+ * cipher.
+ * @return TRUE if the journal was replayed, so new records can be appended
+ * to it.
+ */
+static gboolean read_tasks_from_file(TaskStore *store, gboolean *reseal) {
+    GError *error = NULL;
+    GMappedFile *mapped;
+
+    // Task lines refer to custom statuses by index.
+    load_task_statuses(store);
+
+    // A sealed store keeps no image; it would hold the tasks in the clear.
+    gboolean warm = !store->cipher && warm_image_load(store);
+    mapped = warm ? NULL : g_mapped_file_new(TASKS_FILE, FALSE, &error);
+
+    if (warm) {
+        // The image stands in for the task file; the journal still applies.
+    } else if (!mapped) {
+        g_print("No 'tasks.txt' found. Starting with an empty list.\n");
+        g_clear_error(&error);
+    } else {
+        const gchar *contents = g_mapped_file_get_contents(mapped);
+        gsize length = g_mapped_file_get_length(mapped);
+        gint64 start_time = g_get_monotonic_time();
+        gchar *opened = NULL;
+
+        if (file_is_sealed(contents, length)) {
+            opened = open_sealed_file(store, TASKS_FILE, contents, length, &length, TRUE);
+            contents = opened;
+        } else {
+            *reseal = store->cipher != NULL;
+        }
+        guint n_threads = length < PARALLEL_LOAD_MIN_BYTES ? 1 : get_load_thread_count();
+        guint n_chunks = n_threads == 1 ? 1 : n_threads * PARALLEL_LOAD_CHUNKS_PER_THREAD;
+        LoadChunk *chunks = g_new0(LoadChunk, n_chunks);
+
+        // Cut the file into roughly equal chunks, moving each cut forward to
+        // just past the next newline so that no line is split. Long lines can
+        // push the cuts ahead of their share, so a cut never passes the end,
+        // and chunks that would start there are left out.
+        const gchar *end = contents + length;
+        const gchar *cut = contents;
+        guint used_chunks = 0;
+        for (guint i = 0; i < n_chunks && cut < end; i++) {
+            gsize share = length / n_chunks;
+            const gchar *chunk_end = (i == n_chunks - 1 || share >= (gsize)(end - cut)) ? end : cut + share;
+            if (chunk_end < end) {
+                const gchar *newline_pos = memchr(chunk_end, '\n', end - chunk_end);
+                chunk_end = newline_pos ? newline_pos + 1 : end;
+            }
+            chunks[used_chunks].start = cut;
+            chunks[used_chunks].end = chunk_end;
+            chunks[used_chunks].tasks = g_ptr_array_new();
+            used_chunks++;
+            cut = chunk_end;
+        }
+
+        if (used_chunks == 1) {
+            parse_load_chunk(&chunks[0], NULL);
+        } else if (used_chunks > 1) {
+            GThreadPool *pool = g_thread_pool_new(parse_load_chunk, NULL, n_threads, FALSE, NULL);
+            for (guint i = 0; i < used_chunks; i++) {
+                g_thread_pool_push(pool, &chunks[i], NULL);
+            }
+            // Wait for every chunk to be parsed.
+            g_thread_pool_free(pool, FALSE, TRUE);
+        }
+
+        // Prefix sums give each chunk its final position in the store.
+        guint base = store->tasks->len;
+        guint offset = base;
+        guint repaired = 0;
+        for (guint i = 0; i < used_chunks; i++) {
+            guint count = chunks[i].tasks->len;
+            repaired += chunks[i].repaired;
+            g_ptr_array_set_size(store->tasks, offset + count);
+            memcpy(store->tasks->pdata + offset, chunks[i].tasks->pdata, count * sizeof(gpointer));
+            offset += count;
+            g_ptr_array_free(chunks[i].tasks, TRUE);
+        }
+        g_free(chunks);
+        g_free(opened);
+        g_mapped_file_unref(mapped);
+
+        if (repaired > 0) {
+            g_warning("Replaced invalid UTF-8 in %u line(s) of '%s'.", repaired, TASKS_FILE);
+        }
+
+        for (guint i = base; i < store->tasks->len; i++) {
+            Task *task = task_store_get(store, i);
+            task->id = ++store->next_id;
+            if (task->status >= store->statuses->len) {
+                // The custom status was removed from STATUSES_FILE.
+                task->status = TASK_STATUS_TODO;
+            }
+            if (task->reopen_status >= store->statuses->len) {
+                task->reopen_status = TASK_STATUS_TODO;
+            }
+            tag_index_task(store->tag_index, task, TRUE);
+        }
+
+        g_debug("Loaded %u tasks (%" G_GSIZE_FORMAT " bytes) on %u thread(s) in %" G_GINT64_FORMAT " us.",
+                store->tasks->len - base, length, n_threads, g_get_monotonic_time() - start_time);
+    }
+
+    gchar *header = snapshot_journal_header(TASKS_FILE);
+    gchar *contents = NULL;
+    gsize length = 0;
+
+    if (g_file_get_contents(JOURNAL_FILE, &contents, &length, NULL) && file_is_sealed(contents, length)) {
+        gchar *opened = open_sealed_file(store, JOURNAL_FILE, contents, length, &length, FALSE);
+        g_free(contents);
+        contents = opened;
+    } else if (length > 0) {
+        *reseal = *reseal || store->cipher != NULL;
+    }
+
+    // Only replay a journal that was started for the snapshot just loaded.
+    gboolean replay = contents && g_str_has_prefix(contents, header);
+    if (replay) {
+        store->replaying = TRUE;
+        gchar *line = contents + strlen(header);
+        gchar *newline_pos;
+        // A trailing record without a newline was cut short by a crash; skip it.
+        while ((newline_pos = memchr(line, '\n', contents + length - line)) != NULL) {
+            *newline_pos = '\0';
+            if (*line) {
+                task_store_replay_record(store, line);
+                store->journal_records++;
+            }
+            line = newline_pos + 1;
+        }
+        store->replaying = FALSE;
+    }
+    g_free(contents);
+    g_free(header);
+    return replay;
+}
+
+/**
+ * @brief Loads tasks from the task file into the store and starts
+ * persisting them there.
+ *
+ * @param store A pointer to the TaskStore.
+ */
+void load_tasks_from_file(TaskStore *store) {
+    gboolean reseal = FALSE;
+
+    store->cipher = file_cipher_new_from_env();
+    gboolean replay = read_tasks_from_file(store, &reseal);
+
+    // A read-only store has no writer; its writer is another process.
+    if (!store->read_only) {
+        gchar *header = snapshot_journal_header(TASKS_FILE);
+        store->writer = task_writer_new(JOURNAL_FILE, replay ? NULL : header, store->cipher);
+        g_free(header);
+    }
+
+    if (reseal && !store->read_only) {
+        // Seal what is still plain. The writer does this before anything
+        // else is appended to the journal.
+        save_tasks_to_file(store);
+    }
+}
+
+/**
+ * @brief Appends a committed transaction to the journal, and folds the
+ * journal into the task file once it has grown large enough.
+ */
+static void file_backend_commit(TaskStore *store, guint position, guint removed, guint added) {
+    task_writer_append(store->writer, store->txn_records->str, store->txn_records->len);
+
+    store->journal_records++;
+    if (store->journal_records >= JOURNAL_COMPACT_THRESHOLD) {
+        save_tasks_to_file(store);
+    }
+}
+
+/**
+ * @brief Stops the writer. If the store is now exactly what the task file
+ * holds, which a clean shutdown ensures, it also leaves an image of it for
+ * the next launch.
+ */
+static void file_backend_close(TaskStore *store) {
+    if (store->writer) {
+        gboolean saved = task_writer_free(store->writer);
+        store->writer = NULL;
+        if (store->cipher) {
+            unlink(IMAGE_FILE);
+        } else if (saved && store->journal_records == 0) {
+            warm_image_save(store);
+        }
+    }
+    file_cipher_free(store->cipher);
+    store->cipher = NULL;
+}
+
+// The task file with its journal; the default backend.
+static const TaskBackend file_backend = {
+    "file", load_tasks_from_file, file_backend_commit, save_tasks_to_file, file_backend_close,
+};
+
+// --- SQLite Backend ---
+
+/*
+ * With PROJECT_TRACKER_BACKEND=sqlite the store is kept in SQLITE_FILE
+ * instead, one row per task, keyed by the task's id. The store still holds
+ * every task in memory; the database is only written to, except on start.
+ *
+ * Each commit is turned into row operations by diffing TaskStamps, so a
+ * toggle is one UPDATE rather than a rewrite. Operations go to a writer
+ * thread, which runs everything queued in one transaction with cached
+ * prepared statements, the same group commit the journal gets. The
+ * database runs in WAL mode, so other processes can query it while the
+ * tracker writes; the indexes cover the completion, tag and due queries
+ * they are likely to run, for example
+ *
+ *   SELECT task_id FROM task_tags WHERE tag = 'work' AND done = 0;
+ *
+ * On first use an existing TASKS_FILE is imported.
+ */
+
+#ifdef PROJECT_TRACKER_WITH_SQLITE
+
+// Bumped when the schema changes.
+#define SQLITE_SCHEMA_VERSION 2
+
+static const gchar sqlite_schema[] =
+    "CREATE TABLE IF NOT EXISTS tasks ("
+    " id INTEGER PRIMARY KEY, done INTEGER NOT NULL, status INTEGER NOT NULL, due INTEGER, text TEXT NOT NULL,"
+    " reopen_status INTEGER NOT NULL DEFAULT 0);"
+    "CREATE INDEX IF NOT EXISTS tasks_by_done ON tasks(done, id);"
+    "CREATE INDEX IF NOT EXISTS tasks_by_due ON tasks(due, done, id) WHERE due IS NOT NULL;"
+    "CREATE TABLE IF NOT EXISTS task_tags ("
+    " tag TEXT NOT NULL, task_id INTEGER NOT NULL, done INTEGER NOT NULL,"
+    " PRIMARY KEY (tag, task_id)) WITHOUT ROWID;"
+    "CREATE INDEX IF NOT EXISTS task_tags_by_task ON task_tags(task_id);";
+
+typedef enum {
+    SQLITE_STMT_PUT,
+    SQLITE_STMT_SET_STATUS,
+    SQLITE_STMT_SET_TAGS_DONE,
+    SQLITE_STMT_DELETE,
+    SQLITE_STMT_DELETE_TAGS,
+    SQLITE_STMT_INSERT_TAG,
+    SQLITE_STMT_BEGIN,
+    SQLITE_STMT_COMMIT,
+    SQLITE_N_STMTS
+} SqliteStmt;
+
+static const gchar *const sqlite_statements[SQLITE_N_STMTS] = {
+    [SQLITE_STMT_PUT] = "INSERT INTO tasks (id, done, status, due, text, reopen_status) VALUES (?1, ?2, ?3, ?4, ?5, ?6)"
+                        " ON CONFLICT (id) DO UPDATE SET done = ?2, status = ?3, due = ?4, text = ?5, reopen_status = ?6",
+    [SQLITE_STMT_SET_STATUS] = "UPDATE tasks SET done = ?2, status = ?3, reopen_status = ?4 WHERE id = ?1",
+    [SQLITE_STMT_SET_TAGS_DONE] = "UPDATE task_tags SET done = ?2 WHERE task_id = ?1",
+    [SQLITE_STMT_DELETE] = "DELETE FROM tasks WHERE id = ?1",
+    [SQLITE_STMT_DELETE_TAGS] = "DELETE FROM task_tags WHERE task_id = ?1",
+    [SQLITE_STMT_INSERT_TAG] = "INSERT INTO task_tags (tag, task_id, done) VALUES (?1, ?2, ?3)",
+    [SQLITE_STMT_BEGIN] = "BEGIN",
+    [SQLITE_STMT_COMMIT] = "COMMIT",
+};
+
+typedef enum {
+    SQLITE_OP_PUT,           // Insert or replace a task and its tags.
+    SQLITE_OP_SET_STATUS,
+    SQLITE_OP_DELETE,
+    SQLITE_OP_QUIT           // Flush and stop the thread.
+} SqliteOpType;
+
+typedef struct {
+    SqliteOpType type;
+    guint id;
+    gboolean is_completed;
+    guint8 status;
+    guint8 reopen_status;
+    guint32 due;
+    gchar *text;             // For SQLITE_OP_PUT.
+} SqliteOp;
+
+typedef struct {
+    sqlite3 *db;
+    sqlite3_stmt *statements[SQLITE_N_STMTS];
+    GArray *stamps;          // TaskStamp per task, as last written.
+    GThread *thread;
+    GAsyncQueue *queue;
+    GMutex lock;
+
+    // Counters, updated by the writer thread under @lock.
+    guint64 op_count;
+    guint64 transaction_count;
+    gint64 transaction_total_us;
+    gint64 transaction_max_us;
+} SqliteBackend;
+
+static gboolean sqlite_exec(sqlite3 *db, const gchar *sql) {
+    gchar *message = NULL;
+
+    if (sqlite3_exec(db, sql, NULL, NULL, &message) != SQLITE_OK) {
+        g_warning("Could not run '%s' on '%s': %s", sql, SQLITE_FILE, message);
+        sqlite3_free(message);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Runs a cached statement once and resets it for the next use.
+ */
+static void sqlite_step(SqliteBackend *backend, SqliteStmt which) {
+    sqlite3_stmt *statement = backend->statements[which];
+
+    if (sqlite3_step(statement) != SQLITE_DONE) {
+        g_warning("Could not write '%s': %s", SQLITE_FILE, sqlite3_errmsg(backend->db));
+    }
+    sqlite3_reset(statement);
+}
+
+/**
+ * @brief Writes a task's row and its tag rows.
+ */
+static void sqlite_put_task(SqliteBackend *backend, guint id, gboolean is_completed, guint status,
+                            guint reopen_status, guint32 due, const gchar *text) {
+    sqlite3_stmt *put = backend->statements[SQLITE_STMT_PUT];
+    sqlite3_stmt *delete_tags = backend->statements[SQLITE_STMT_DELETE_TAGS];
+    sqlite3_stmt *insert_tag = backend->statements[SQLITE_STMT_INSERT_TAG];
+    GHashTable *tags = extract_tags(text);
+    GHashTableIter iter;
+    gpointer tag;
+
+    sqlite3_bind_int64(put, 1, id);
+    sqlite3_bind_int(put, 2, is_completed);
+    sqlite3_bind_int(put, 3, status);
+    if (due) {
+        sqlite3_bind_int64(put, 4, due);
+    } else {
+        sqlite3_bind_null(put, 4);
+    }
+    sqlite3_bind_text(put, 5, text, -1, SQLITE_STATIC);
+    sqlite3_bind_int(put, 6, reopen_status);
+    sqlite_step(backend, SQLITE_STMT_PUT);
+
+    sqlite3_bind_int64(delete_tags, 1, id);
+    sqlite_step(backend, SQLITE_STMT_DELETE_TAGS);
+    g_hash_table_iter_init(&iter, tags);
+    while (g_hash_table_iter_next(&iter, &tag, NULL)) {
+        sqlite3_bind_text(insert_tag, 1, tag, -1, SQLITE_STATIC);
+        sqlite3_bind_int64(insert_tag, 2, id);
+        sqlite3_bind_int(insert_tag, 3, is_completed);
+        sqlite_step(backend, SQLITE_STMT_INSERT_TAG);
+    }
+    g_hash_table_unref(tags);
+}
+
+/**
+ * @brief Applies one queued operation. Runs on the writer thread.
+ */
+static void sqlite_apply(SqliteBackend *backend, SqliteOp *op) {
+    sqlite3_stmt *statement;
+
+    switch (op->type) {
+    case SQLITE_OP_PUT:
+        sqlite_put_task(backend, op->id, op->is_completed, op->status, op->reopen_status, op->due, op->text);
+        break;
+    case SQLITE_OP_SET_STATUS:
+        statement = backend->statements[SQLITE_STMT_SET_STATUS];
+        sqlite3_bind_int64(statement, 1, op->id);
+        sqlite3_bind_int(statement, 2, op->is_completed);
+        sqlite3_bind_int(statement, 3, op->status);
+        sqlite3_bind_int(statement, 4, op->reopen_status);
+        sqlite_step(backend, SQLITE_STMT_SET_STATUS);
+        statement = backend->statements[SQLITE_STMT_SET_TAGS_DONE];
+        sqlite3_bind_int64(statement, 1, op->id);
+        sqlite3_bind_int(statement, 2, op->is_completed);
+        sqlite_step(backend, SQLITE_STMT_SET_TAGS_DONE);
+        break;
+    case SQLITE_OP_DELETE:
+        statement = backend->statements[SQLITE_STMT_DELETE];
+        sqlite3_bind_int64(statement, 1, op->id);
+        sqlite_step(backend, SQLITE_STMT_DELETE);
+        statement = backend->statements[SQLITE_STMT_DELETE_TAGS];
+        sqlite3_bind_int64(statement, 1, op->id);
+        sqlite_step(backend, SQLITE_STMT_DELETE_TAGS);
+        break;
+    case SQLITE_OP_QUIT:
+        break;
+    }
+}
+
+/**
+ * @brief Body of the SQLite writer thread.
+ */
+static gpointer sqlite_writer_thread(gpointer data) {
+    SqliteBackend *backend = data;
+    gboolean quit = FALSE;
+
+    while (!quit) {
+        SqliteOp *op = g_async_queue_pop(backend->queue);
+        gint64 start = g_get_monotonic_time();
+        guint n_ops = 0;
+
+        if (op->type == SQLITE_OP_QUIT) {
+            g_free(op);
+            break;
+        }
+        // Group commit: everything already queued goes into one transaction.
+        sqlite_step(backend, SQLITE_STMT_BEGIN);
+        do {
+            quit = op->type == SQLITE_OP_QUIT;
+            sqlite_apply(backend, op);
+            n_ops += !quit;
+            g_free(op->text);
+            g_free(op);
+        } while (!quit && (op = g_async_queue_try_pop(backend->queue)) != NULL);
+        sqlite_step(backend, SQLITE_STMT_COMMIT);
+
+        gint64 elapsed = g_get_monotonic_time() - start;
+        g_mutex_lock(&backend->lock);
+        backend->op_count += n_ops;
+        backend->transaction_count++;
+        backend->transaction_total_us += elapsed;
+        backend->transaction_max_us = MAX(backend->transaction_max_us, elapsed);
+        g_mutex_unlock(&backend->lock);
+    }
+    return NULL;
+}
+
+static void sqlite_queue(SqliteBackend *backend, SqliteOpType type, guint id, const Task *task) {
+    SqliteOp *op = g_new0(SqliteOp, 1);
+
+    op->type = type;
+    op->id = id;
+    if (task) {
+        op->is_completed = task->is_completed;
+        op->status = task->status;
+        op->reopen_status = task->reopen_status;
+        op->due = task->due;
+        op->text = type == SQLITE_OP_PUT ? g_strdup(task->text) : NULL;
+    }
+    g_async_queue_push(backend->queue, op);
+}
+
+static void sqlite_queue_change(TaskChange change, guint id, const Task *task, gpointer user_data) {
+    switch (change) {
+    case TASK_CHANGE_ADDED:
+    case TASK_CHANGE_TEXT:
+        sqlite_queue(user_data, SQLITE_OP_PUT, id, task);
+        break;
+    case TASK_CHANGE_STATUS:
+        sqlite_queue(user_data, SQLITE_OP_SET_STATUS, id, task);
+        break;
+    case TASK_CHANGE_REMOVED:
+        sqlite_queue(user_data, SQLITE_OP_DELETE, id, NULL);
+        break;
+    }
+}
+
+static void sqlite_backend_commit(TaskStore *store, guint position, guint removed, guint added) {
+    SqliteBackend *backend = store->backend_data;
+    task_stamps_update(backend->stamps, store, position, removed, added, sqlite_queue_change, backend);
+}
+
+/**
+ * @brief Copies every task of the store into the empty database, in one
+ * transaction.
+ */
+static void sqlite_import_store(SqliteBackend *backend, TaskStore *store) {
+    sqlite_step(backend, SQLITE_STMT_BEGIN);
+    for (guint i = 0; i < store->tasks->len; i++) {
+        Task *task = task_store_get(store, i);
+        sqlite_put_task(backend, task->id, task->is_completed, task->status, task->reopen_status, task->due,
+                        task->text);
+    }
+    sqlite_step(backend, SQLITE_STMT_COMMIT);
+}
+
+/**
+ * @brief Reads every task from the database into the store, in id order.
+ *
+ * @return FALSE if the database could not be read.
+ */
+static gboolean sqlite_load_store(SqliteBackend *backend, TaskStore *store) {
+    sqlite3_stmt *select;
+    int result;
+
+    if (sqlite3_prepare_v2(backend->db, "SELECT id, done, status, text, reopen_status FROM tasks ORDER BY id", -1,
+                           &select, NULL) != SQLITE_OK) {
+        g_warning("Could not read '%s': %s", SQLITE_FILE, sqlite3_errmsg(backend->db));
+        return FALSE;
+    }
+    while ((result = sqlite3_step(select)) == SQLITE_ROW) {
+        Task *task = g_new0(Task, 1);
+        const gchar *text = (const gchar *)sqlite3_column_text(select, 3);
+
+        task->id = sqlite3_column_int64(select, 0);
+        task->is_completed = sqlite3_column_int(select, 1) == 1;
+        task->status = task_status_for_completion(task->is_completed);
+        guint status = sqlite3_column_int(select, 2);
+        if (!task->is_completed && status < store->statuses->len && status != TASK_STATUS_DONE) {
+            task->status = status;
+        }
+        guint reopen_status = sqlite3_column_int(select, 4);
+        if (task->is_completed && reopen_status < store->statuses->len && reopen_status != TASK_STATUS_DONE) {
+            task->reopen_status = reopen_status;
+        }
+        task->text = g_utf8_make_valid(text ? text : "", -1);
+        task_parse_fields(task);
+        tag_index_task(store->tag_index, task, TRUE);
+        g_ptr_array_add(store->tasks, task);
+        store->next_id = MAX(store->next_id, task->id);
+    }
+    if (result != SQLITE_DONE) {
+        g_warning("Could not read '%s': %s", SQLITE_FILE, sqlite3_errmsg(backend->db));
+    }
+    sqlite3_finalize(select);
+    return result == SQLITE_DONE;
+}
+
+/**
+ * @brief Reads SQLITE_FILE without writing anything, for a read-only
+ * store. A database that has not been created yet is read from the task
+ * file instead.
+ */
+static void sqlite_backend_load_read_only(TaskStore *store) {
+    SqliteBackend backend = { NULL };
+    sqlite3_stmt *version;
+    gint user_version = 0;
+
+    if (sqlite3_open_v2(SQLITE_FILE, &backend.db, SQLITE_OPEN_READONLY, NULL) == SQLITE_OK &&
+        sqlite3_prepare_v2(backend.db, "PRAGMA user_version", -1, &version, NULL) == SQLITE_OK) {
+        if (sqlite3_step(version) == SQLITE_ROW) {
+            user_version = sqlite3_column_int(version, 0);
+        }
+        sqlite3_finalize(version);
+    }
+    if (user_version == SQLITE_SCHEMA_VERSION) {
+        load_task_statuses(store);
+        sqlite_load_store(&backend, store);
+    } else {
+        load_tasks_from_file(store);
+    }
+    sqlite3_close(backend.db);
+}
+
+/**
+ * @brief Empties a store that was partly loaded, so that it can be loaded
+ * again from elsewhere. Only called before anything listens to the store.
+ */
+static void task_store_clear(TaskStore *store) {
+    g_ptr_array_set_size(store->tasks, 0);
+    g_hash_table_remove_all(store->tag_index);
+    g_ptr_array_set_size(store->statuses, TASK_STATUS_N_BUILTIN);
+    store->next_id = 0;
+}
+
+/**
+ * @brief Opens SQLITE_FILE, creating or importing it on first use, and
+ * starts the writer thread. Falls back to the task file if the database
+ * cannot be opened.
+ *
+ * @param store A pointer to the TaskStore.
+ */
+static void sqlite_backend_load(TaskStore *store) {
+    SqliteBackend *backend;
+    gint64 start_time = g_get_monotonic_time();
+    sqlite3_stmt *version;
+    gint user_version = -1;
+    gboolean ok;
+
+    if (store->read_only) {
+        sqlite_backend_load_read_only(store);
+        return;
+    }
+    backend = g_new0(SqliteBackend, 1);
+    ok = sqlite3_open(SQLITE_FILE, &backend->db) == SQLITE_OK &&
+         // Every group commit is synced, as the journal's are.
+         sqlite_exec(backend->db, "PRAGMA journal_mode = WAL; PRAGMA synchronous = FULL;") &&
+         sqlite_exec(backend->db, sqlite_schema);
+    if (ok && sqlite3_prepare_v2(backend->db, "PRAGMA user_version", -1, &version, NULL) == SQLITE_OK) {
+        if (sqlite3_step(version) == SQLITE_ROW) {
+            user_version = sqlite3_column_int(version, 0);
+        }
+        sqlite3_finalize(version);
+    }
+    if (user_version == 1) {
+        // Version 1 did not remember the status a completed task reopens to.
+        ok = sqlite_exec(backend->db, "ALTER TABLE tasks ADD COLUMN reopen_status INTEGER NOT NULL DEFAULT 0;"
+                                      "PRAGMA user_version = " G_STRINGIFY(SQLITE_SCHEMA_VERSION));
+        user_version = SQLITE_SCHEMA_VERSION;
+    }
+    for (guint i = 0; ok && i < SQLITE_N_STMTS; i++) {
+        ok = sqlite3_prepare_v3(backend->db, sqlite_statements[i], -1, SQLITE_PREPARE_PERSISTENT,
+                                &backend->statements[i], NULL) == SQLITE_OK;
+    }
+    if (!ok) {
+        // Nothing has been read yet.
+    } else if (user_version == 0) {
+        // A new database: start from the task file, if there is one. It is
+        // only read; the file backend never starts.
+        gboolean reseal = FALSE;
+        store->cipher = file_cipher_new_from_env();
+        read_tasks_from_file(store, &reseal);
+        file_cipher_free(store->cipher);
+        store->cipher = NULL;
+        sqlite_import_store(backend, store);
+        sqlite_exec(backend->db, "PRAGMA user_version = " G_STRINGIFY(SQLITE_SCHEMA_VERSION));
+        g_print("Imported %u tasks into '%s'.\n", store->tasks->len, SQLITE_FILE);
+    } else if (user_version == SQLITE_SCHEMA_VERSION) {
+        load_task_statuses(store);
+        ok = sqlite_load_store(backend, store);
+    } else {
+        ok = FALSE;
+    }
+
+    if (!ok) {
+        g_warning("Could not open '%s': %s. Using '%s' instead.", SQLITE_FILE,
+                  user_version > SQLITE_SCHEMA_VERSION ? "written by a newer version" : sqlite3_errmsg(backend->db),
+                  TASKS_FILE);
+        for (guint i = 0; i < SQLITE_N_STMTS; i++) {
+            sqlite3_finalize(backend->statements[i]);
+        }
+        sqlite3_close(backend->db);
+        g_free(backend);
+        // Drops whatever the database gave before it failed.
+        task_store_clear(store);
+        store->backend = &file_backend;
+        load_tasks_from_file(store);
+        return;
+    }
+
+    g_debug("Loaded %u tasks from '%s' in %" G_GINT64_FORMAT " us.", store->tasks->len, SQLITE_FILE,
+            g_get_monotonic_time() - start_time);
+
+    backend->stamps = g_array_sized_new(FALSE, FALSE, sizeof(TaskStamp), store->tasks->len);
+    task_stamps_init(backend->stamps, store);
+    g_mutex_init(&backend->lock);
+    backend->queue = g_async_queue_new();
+    backend->thread = g_thread_new("sqlite-writer", sqlite_writer_thread, backend);
+    store->backend_data = backend;
+}
+
+/**
+ * @brief Writes out everything still queued, stops the writer thread, logs
+ * its counters at debug level and closes the database.
+ */
+static void sqlite_backend_close(TaskStore *store) {
+    SqliteBackend *backend = store->backend_data;
+
+    if (!backend) {
+        // Read-only; only the task file's cipher may be left.
+        file_backend_close(store);
+        return;
+    }
+    sqlite_queue(backend, SQLITE_OP_QUIT, 0, NULL);
+    g_thread_join(backend->thread);
+
+    g_debug("SQLite writer: %" G_GUINT64_FORMAT " row operations in %" G_GUINT64_FORMAT
+            " transactions, avg %" G_GINT64_FORMAT " us, max %" G_GINT64_FORMAT " us.",
+            backend->op_count, backend->transaction_count,
+            backend->transaction_count ? backend->transaction_total_us / (gint64)backend->transaction_count : 0,
+            backend->transaction_max_us);
+
+    for (guint i = 0; i < SQLITE_N_STMTS; i++) {
+        sqlite3_finalize(backend->statements[i]);
+    }
+    sqlite3_close(backend->db);
+    g_async_queue_unref(backend->queue);
+    g_mutex_clear(&backend->lock);
+    g_array_free(backend->stamps, TRUE);
+    g_free(backend);
+    store->backend_data = NULL;
+}
+
+// Rows are written as they change, so there is nothing to save on exit.
+static const TaskBackend sqlite_backend = {
+    "sqlite", sqlite_backend_load, sqlite_backend_commit, NULL, sqlite_backend_close,
+};
+
+#endif
+
+/**
+ * @brief Loads the store with the backend named by PROJECT_TRACKER_BACKEND,
+ * "file" (the default) or "sqlite".
+ *
+ * @param store A pointer to the TaskStore.
+ */
+static void task_store_open(TaskStore *store) {
+    const gchar *name = g_getenv("PROJECT_TRACKER_BACKEND");
+
+    store->backend = &file_backend;
+#ifdef PROJECT_TRACKER_WITH_SQLITE
+    if (g_strcmp0(name, sqlite_backend.name) == 0) {
+        store->backend = &sqlite_backend;
+    }
+#endif
+    if (name && g_strcmp0(name, store->backend->name) != 0) {
+        g_warning("Unknown or unavailable storage backend '%s'. Using '%s'.", name, store->backend->name);
+    }
+    store->backend->load(store);
+    // Columns taken from a warm-start image are already current.
+    if (store->columns.length != store->tasks->len) {
+        task_columns_rebuild(&store->columns, store->tasks);
+    }
+}
+
+// --- Bulk Import ---
+
+// Lines parsed between cancellation checks.
+#define IMPORT_CHUNK_LINES 4096
+
+/**
+ * @brief Splits pasted or dropped text into tasks.
+ *
+ * Each non-empty line becomes one task. Common list markers ("- ", "* ",
+ * "+ ") are dropped, and Markdown checkboxes ("[ ] " and "[x] ") set the
+ * completion status. The cancellable is polled once per chunk of lines.
+ *
+ * @param text The text to parse.
+ * @param length The length of @text in bytes.
+ * @param cancellable A GCancellable, or NULL.
+ * @return A GPtrArray of Task pointers, or NULL if the parse was cancelled.
+ */
+static GPtrArray *parse_task_lines(const gchar *text, gsize length, GCancellable *cancellable) {
+    GPtrArray *tasks = g_ptr_array_new_with_free_func(task_free);
+    const gchar *end = text + length;
+    const gchar *line = text;
+    guint lines_in_chunk = 0;
+
+    while (line < end) {
+        const gchar *line_end = memchr(line, '\n', end - line);
+        if (!line_end) {
+            line_end = end;
+        }
+
+        if (++lines_in_chunk == IMPORT_CHUNK_LINES) {
+            lines_in_chunk = 0;
+            if (g_cancellable_is_cancelled(cancellable)) {
+                g_ptr_array_unref(tasks);
+                return NULL;
+            }
+        }
+
+        const gchar *start = line;
+        const gchar *stop = line_end;
+        line = line_end + 1;
+
+        // Trim surrounding whitespace, including the '\r' of CRLF line endings.
+        while (start < stop && g_ascii_isspace(*start)) {
+            start++;
+        }
+        while (stop > start && g_ascii_isspace(stop[-1])) {
+            stop--;
+        }
+
+        if (stop - start >= 2 && strchr("-*+", start[0]) && start[1] == ' ') {
+            start += 2;
+        }
+
+        gboolean is_completed = FALSE;
+        if (stop - start >= 3 && start[0] == '[' && start[2] == ']' && strchr(" xX", start[1])) {
+            is_completed = start[1] != ' ';
+            start += 3;
+            while (start < stop && g_ascii_isspace(*start)) {
+                start++;
+            }
+        }
+
+        if (start == stop) {
+            continue;
+        }
+
+        Task *task = g_new0(Task, 1);
+        task->text = g_strndup(start, stop - start);
+        task->is_completed = is_completed;
+        g_ptr_array_add(tasks, task);
+    }
+
+    return tasks;
+}
+
+/**
+ * @brief Worker thread body for import_text_async().
+ */
+static void import_text_thread(GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable) {
+    const gchar *text = task_data;
+    GPtrArray *tasks = parse_task_lines(text, strlen(text), cancellable);
+
+    if (!tasks) {
+        g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "Import cancelled");
+        return;
+    }
+    g_task_return_pointer(task, tasks, (GDestroyNotify)g_ptr_array_unref);
+}
+
+/**
+ * @brief Pulses the entry's progress bar while an import is running.
+ */
+static gboolean on_import_pulse(gpointer user_data) {
+    gtk_entry_progress_pulse(GTK_ENTRY(user_data));
+    return G_SOURCE_CONTINUE;
+}
+
+/**
+ * @brief Stops the import progress indicator on a window.
+ */
+static void import_finish_progress(GtkWidget *window) {
+    GtkWidget *entry = g_object_get_data(G_OBJECT(window), "entry");
+    guint pulse_id = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(window), "import_pulse_id"));
+
+    if (pulse_id) {
+        g_source_remove(pulse_id);
+        g_object_set_data(G_OBJECT(window), "import_pulse_id", NULL);
+    }
+    gtk_entry_set_progress_fraction(GTK_ENTRY(entry), 0.0);
+}
+
+/**
+ * @brief Completion callback for import_text_async(). Inserts all parsed
+ * tasks through a single store transaction.
+ */
+static void on_import_parsed(GObject *source_object, GAsyncResult *result, gpointer user_data) {
+    GtkWidget *window = GTK_WIDGET(source_object);
+    GPtrArray *tasks = g_task_propagate_pointer(G_TASK(result), NULL);
+
+    if (!tasks) {
+        // Cancelled, either from the keyboard or because the window closed.
+        return;
+    }
+
+    import_finish_progress(window);
+    g_object_set_data(G_OBJECT(window), "import_cancellable", NULL);
+    task_store_append_tasks(g_object_get_data(G_OBJECT(window), "store"), tasks);
+    g_ptr_array_unref(tasks);
+}
+
+/**
+ * @brief Cancels the import running for a window, if any.
+ *
+ * @param window The GtkApplicationWindow.
+ */
+static void import_cancel(GtkWidget *window) {
+    GCancellable *cancellable = g_object_get_data(G_OBJECT(window), "import_cancellable");
+
+    if (cancellable) {
+        g_cancellable_cancel(cancellable);
+        import_finish_progress(window);
+        g_object_set_data(G_OBJECT(window), "import_cancellable", NULL);
+    }
+}
+
+/**
+ * @brief Parses multi-line text into tasks on a worker thread, then adds them
+ * to the store in one batch. Starting a new import cancels the previous one.
+ *
+ * @param window The GtkApplicationWindow the text was pasted or dropped into.
+ * @param text The text to import.
+ */
+static void import_text_async(GtkWidget *window, const gchar *text) {
+    GtkWidget *entry = g_object_get_data(G_OBJECT(window), "entry");
+    GCancellable *cancellable = g_cancellable_new();
+
+    import_cancel(window);
+    g_object_set_data_full(G_OBJECT(window), "import_cancellable", cancellable, g_object_unref);
+
+    gtk_entry_set_progress_pulse_step(GTK_ENTRY(entry), 0.1);
+    g_object_set_data(G_OBJECT(window), "import_pulse_id",
+                      GUINT_TO_POINTER(g_timeout_add(100, on_import_pulse, entry)));
+
+    GTask *task = g_task_new(window, cancellable, on_import_parsed, NULL);
+    g_task_set_task_data(task, g_strdup(text), g_free);
+    g_task_run_in_thread(task, import_text_thread);
+    g_object_unref(task);
+}
+
+/**
+ * @brief Receives clipboard text requested by on_entry_paste_clipboard().
+ *
+ * Single-line text is pasted into the entry as usual; anything with a
+ * newline is imported as a batch of tasks.
+ */
+static void on_clipboard_text_received(GtkClipboard *clipboard, const gchar *text, gpointer user_data) {
+    GtkWidget *window = GTK_WIDGET(user_data);
+    GtkWidget *entry = g_object_get_data(G_OBJECT(window), "entry");
+
+    if (text && gtk_widget_get_realized(window)) {
+        if (strchr(text, '\n')) {
+            import_text_async(window, text);
+        } else {
+            gint position;
+            gtk_editable_delete_selection(GTK_EDITABLE(entry));
+            position = gtk_editable_get_position(GTK_EDITABLE(entry));
+            gtk_editable_insert_text(GTK_EDITABLE(entry), text, -1, &position);
+            gtk_editable_set_position(GTK_EDITABLE(entry), position);
+        }
+    }
+    g_object_unref(window);
+}
+
+/**
+ * @brief Callback for the entry's "paste-clipboard" signal.
+ *
+ * Replaces the default paste so that multi-line clipboard contents can be
+ * split into tasks instead of becoming a single task.
+ *
+ * @param widget A pointer to the GtkEntry.
+ * @param user_data A pointer to the GtkApplicationWindow instance.
+ */
+static void on_entry_paste_clipboard(GtkWidget *widget, gpointer user_data) {
+    GtkClipboard *clipboard = gtk_widget_get_clipboard(widget, GDK_SELECTION_CLIPBOARD);
+
+    g_signal_stop_emission_by_name(widget, "paste-clipboard");
+    gtk_clipboard_request_text(clipboard, on_clipboard_text_received, g_object_ref(user_data));
+}
+
+/**
+ * @brief Callback for the entry's "key-press-event". Escape cancels a
+ * running import.
+ */
+static gboolean on_entry_key_press(GtkWidget *widget, GdkEventKey *event, gpointer user_data) {
+    if (event->keyval == GDK_KEY_Escape && g_object_get_data(G_OBJECT(user_data), "import_cancellable")) {
+        import_cancel(GTK_WIDGET(user_data));
+        return GDK_EVENT_STOP;
+    }
+    return GDK_EVENT_PROPAGATE;
+}
+
+/**
+ * @brief Callback for text dropped onto the task list.
+ *
+ * @param user_data A pointer to the GtkApplicationWindow instance.
+ */
+static void on_list_drag_data_received(GtkWidget *widget, GdkDragContext *context, gint x, gint y,
+                                       GtkSelectionData *selection_data, guint info, guint time,
+                                       gpointer user_data) {
+    gchar *text = (gchar *)gtk_selection_data_get_text(selection_data);
+
+    if (text) {
+        import_text_async(GTK_WIDGET(user_data), text);
+        g_free(text);
+    }
+}
+
+// --- Autocompletion ---
+
+/*
+ * The add-task entry suggests earlier task texts and tags. Every text and
+ * tag ever added is a key in a sorted array, so the keys sharing a prefix
+ * form one contiguous range found by binary search. A segment tree over
+ * that array holds, for each node, the key with the highest rank below
+ * it, so the best suggestions in a range come out in O(k log n) however
+ * many keys share the prefix.
+ *
+ * A key's rank combines frequency and recency: each use adds one to a
+ * count that halves every COMPLETION_HALF_LIFE added tasks. The rank is
+ * kept as log2 of that count plus the time of the last update in
+ * half-lives, which orders keys the same way at any later time, so ranks
+ * never need to be decayed.
+ */
+
+// Suggestions shown at most.
+#define COMPLETION_MAX_SUGGESTIONS 8
+// Tasks added after which a past use counts half as much.
+#define COMPLETION_HALF_LIFE 500.0
+// New keys held in the small level before it is merged into the main one.
+#define COMPLETION_RECENT_MAX 4096
+
+// Where a completion entry lives: one of the two levels, or not yet merged.
+enum {
+    COMPLETION_MAIN,
+    COMPLETION_RECENT,
+    COMPLETION_FRESH
+};
+
+typedef struct {
+    gchar *key;                  // Case-folded text; the sort key.
+    gchar *text;                 // The text as most recently entered.
+    gdouble rank;
+    guint8 level;                // COMPLETION_MAIN, COMPLETION_RECENT or COMPLETION_FRESH.
+} CompletionEntry;
+
+/**
+ * @brief A sorted run of entries with its segment tree.
+ */
+typedef struct {
+    GPtrArray *sorted;           // Entries, sorted by key.
+    guint *tree;                 // Segment tree of the best index per node.
+    guint n_leaves;              // A power of two >= sorted->len.
+} CompletionLevel;
+
+/*
+ * New keys go to a small recent level, so adding a task re-sorts a few
+ * thousand keys rather than all of them; once the recent level outgrows
+ * COMPLETION_RECENT_MAX it is merged into the main level in one pass.
+ * Lookups take the best keys of both levels.
+ */
+typedef struct {
+    GHashTable *entries;         // Key -> CompletionEntry.
+    CompletionLevel levels[2];   // Indexed by COMPLETION_MAIN and COMPLETION_RECENT.
+    GPtrArray *fresh;            // New entries not yet merged into a level.
+} CompletionTable;
+
+/**
+ * @brief The completion index shared by all windows.
+ */
+typedef struct {
+    TaskStore *store;
+    CompletionTable *table;      // NULL until the first build finishes.
+    GArray *pending;             // TaskText copies of tasks added during the build.
+    guint last_id;               // Highest task id seen; newer tasks are additions.
+} CompletionIndex;
+
+static void completion_entry_free(gpointer data) {
+    CompletionEntry *entry = data;
+    g_free(entry->key);
+    g_free(entry->text);
+    g_free(entry);
+}
+
+/**
+ * @brief Returns the better of two sorted indices by rank. G_MAXUINT is
+ * an empty slot.
+ */
+static inline guint completion_level_better(CompletionLevel *level, guint a, guint b) {
+    if (a == G_MAXUINT) {
+        return b;
+    }
+    if (b == G_MAXUINT) {
+        return a;
+    }
+    CompletionEntry *entry_a = g_ptr_array_index(level->sorted, a);
+    CompletionEntry *entry_b = g_ptr_array_index(level->sorted, b);
+    return entry_b->rank > entry_a->rank ? b : a;
+}
+
+/**
+ * @brief Recomputes the segment tree nodes above one leaf.
+ */
+static void completion_level_update_leaf(CompletionLevel *level, guint index) {
+    for (guint node = (index + level->n_leaves) / 2; node > 0; node /= 2) {
+        level->tree[node] = completion_level_better(level, level->tree[2 * node], level->tree[2 * node + 1]);
+    }
+}
+
+/**
+ * @brief Rebuilds the segment tree of a level from its sorted entries.
+ */
+static void completion_level_rebuild(CompletionLevel *level) {
+    level->n_leaves = 1;
+    while (level->n_leaves < level->sorted->len) {
+        level->n_leaves *= 2;
+    }
+    g_free(level->tree);
+    level->tree = g_new(guint, 2 * level->n_leaves);
+    for (guint leaf = 0; leaf < level->n_leaves; leaf++) {
+        level->tree[level->n_leaves + leaf] = leaf < level->sorted->len ? leaf : G_MAXUINT;
+    }
+    for (guint node = level->n_leaves - 1; node > 0; node--) {
+        level->tree[node] = completion_level_better(level, level->tree[2 * node], level->tree[2 * node + 1]);
+    }
+}
+
+static gint completion_entry_compare(gconstpointer a, gconstpointer b) {
+    return strcmp((*(CompletionEntry *const *)a)->key, (*(CompletionEntry *const *)b)->key);
+}
+
+/**
+ * @brief Merges a sorted batch of entries into a level. The caller
+ * rebuilds the level's tree.
+ *
+ * @param level The level to merge into.
+ * @param batch Entries sorted by key; left untouched.
+ * @param which COMPLETION_MAIN or COMPLETION_RECENT, recorded in each entry.
+ */
+static void completion_level_merge(CompletionLevel *level, GPtrArray *batch, guint8 which) {
+    GPtrArray *merged = g_ptr_array_sized_new(level->sorted->len + batch->len);
+    guint i = 0, j = 0;
+
+    while (i < level->sorted->len || j < batch->len) {
+        if (j == batch->len ||
+            (i < level->sorted->len &&
+             completion_entry_compare(&level->sorted->pdata[i], &batch->pdata[j]) < 0)) {
+            g_ptr_array_add(merged, level->sorted->pdata[i++]);
+        } else {
+            CompletionEntry *entry = batch->pdata[j++];
+            entry->level = which;
+            g_ptr_array_add(merged, entry);
+        }
+    }
+    g_ptr_array_unref(level->sorted);
+    level->sorted = merged;
+}
+
+/**
+ * @brief Returns the index of the first key in a level that is not less
+ * than @key, or with @past_prefix, the first that does not start with
+ * @key and sorts after it.
+ */
+static guint completion_level_bound(CompletionLevel *level, const gchar *key, gboolean past_prefix) {
+    gsize length = strlen(key);
+    guint low = 0, high = level->sorted->len;
+
+    while (low < high) {
+        guint middle = low + (high - low) / 2;
+        const gchar *candidate = ((CompletionEntry *)g_ptr_array_index(level->sorted, middle))->key;
+        gint cmp = past_prefix ? strncmp(candidate, key, length) : strcmp(candidate, key);
+        if (past_prefix ? cmp <= 0 : cmp < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Returns the best index in [low, high) of a level, or G_MAXUINT.
+ */
+static guint completion_level_best(CompletionLevel *level, guint low, guint high) {
+    guint best = G_MAXUINT;
+
+    for (guint l = low + level->n_leaves, r = high + level->n_leaves; l < r; l /= 2, r /= 2) {
+        if (l & 1) {
+            best = completion_level_better(level, best, level->tree[l++]);
+        }
+        if (r & 1) {
+            best = completion_level_better(level, best, level->tree[--r]);
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Collects the best-ranked entries of a level whose keys start
+ * with @key, best first, leaving out @key itself.
+ *
+ * @return The number of entries stored in @out.
+ */
+static guint completion_level_top(CompletionLevel *level, const gchar *key, CompletionEntry **out) {
+    // Candidate ranges, each with its best index; popping one splits it in two.
+    struct { guint low, high, best; } ranges[2 * COMPLETION_MAX_SUGGESTIONS + 2];
+    guint n_ranges = 0, n_out = 0;
+    guint low = completion_level_bound(level, key, FALSE);
+    guint high = completion_level_bound(level, key, TRUE);
+
+    while (n_out < COMPLETION_MAX_SUGGESTIONS) {
+        if (low < high) {
+            ranges[n_ranges].low = low;
+            ranges[n_ranges].high = high;
+            ranges[n_ranges].best = completion_level_best(level, low, high);
+            n_ranges++;
+        }
+        if (n_ranges == 0) {
+            break;
+        }
+
+        guint pick = 0;
+        for (guint i = 1; i < n_ranges; i++) {
+            if (completion_level_better(level, ranges[pick].best, ranges[i].best) != ranges[pick].best) {
+                pick = i;
+            }
+        }
+        guint best = ranges[pick].best;
+        CompletionEntry *entry = g_ptr_array_index(level->sorted, best);
+        // Don't suggest exactly what was typed.
+        if (strcmp(entry->key, key) != 0) {
+            out[n_out++] = entry;
+        }
+
+        // The left part goes back in the picked slot; the right part is
+        // added at the top of the next iteration.
+        low = best + 1;
+        high = ranges[pick].high;
+        ranges[pick].high = best;
+        if (ranges[pick].low < best) {
+            ranges[pick].best = completion_level_best(level, ranges[pick].low, best);
+        } else {
+            ranges[pick] = ranges[--n_ranges];
+        }
+    }
+    return n_out;
+}
+
+static CompletionTable *completion_table_new(void) {
+    CompletionTable *table = g_new0(CompletionTable, 1);
+    table->entries = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, completion_entry_free);
+    for (guint i = 0; i < G_N_ELEMENTS(table->levels); i++) {
+        table->levels[i].sorted = g_ptr_array_new();
+        completion_level_rebuild(&table->levels[i]);
+    }
+    table->fresh = g_ptr_array_new();
+    return table;
+}
+
+static void completion_table_free(CompletionTable *table) {
+    for (guint i = 0; i < G_N_ELEMENTS(table->levels); i++) {
+        g_ptr_array_unref(table->levels[i].sorted);
+        g_free(table->levels[i].tree);
+    }
+    g_ptr_array_unref(table->fresh);
+    g_hash_table_unref(table->entries);
+    g_free(table);
+}
+
+/**
+ * @brief Merges the fresh entries into the recent level, and the recent
+ * level into the main one once it is full. Runs once per store
+ * transaction rather than once per key.
+ */
+static void completion_table_commit(CompletionTable *table) {
+    CompletionLevel *main_level = &table->levels[COMPLETION_MAIN];
+    CompletionLevel *recent = &table->levels[COMPLETION_RECENT];
+
+    if (table->fresh->len == 0) {
+        return;
+    }
+
+    g_ptr_array_sort(table->fresh, completion_entry_compare);
+    completion_level_merge(recent, table->fresh, COMPLETION_RECENT);
+    g_ptr_array_set_size(table->fresh, 0);
+
+    if (recent->sorted->len > COMPLETION_RECENT_MAX) {
+        completion_level_merge(main_level, recent->sorted, COMPLETION_MAIN);
+        completion_level_rebuild(main_level);
+        g_ptr_array_set_size(recent->sorted, 0);
+    }
+    completion_level_rebuild(recent);
+}
+
+/**
+ * @brief Records one use of a text.
+ *
+ * @param table The completion table.
+ * @param text The text, as entered.
+ * @param id The id of the task the use came from, which serves as its time.
+ */
+static void completion_table_use(CompletionTable *table, const gchar *text, guint id) {
+    gchar *key = g_utf8_casefold(text, -1);
+    CompletionEntry *entry = g_hash_table_lookup(table->entries, key);
+    gdouble now = id / COMPLETION_HALF_LIFE;
+
+    if (!entry) {
+        entry = g_new0(CompletionEntry, 1);
+        entry->key = key;
+        entry->text = g_strdup(text);
+        entry->rank = now;
+        entry->level = COMPLETION_FRESH;
+        g_hash_table_insert(table->entries, entry->key, entry);
+        g_ptr_array_add(table->fresh, entry);
+        return;
+    }
+    g_free(key);
+
+    // log2(2^rank + 2^now), without overflowing.
+    gdouble high = MAX(entry->rank, now);
+    entry->rank = high + log2(1.0 + exp2(-fabs(entry->rank - now)));
+    if (g_strcmp0(entry->text, text) != 0) {
+        g_free(entry->text);
+        entry->text = g_strdup(text);
+    }
+    if (entry->level != COMPLETION_FRESH) {
+        // Fresh entries get their leaf when they are merged.
+        CompletionLevel *level = &table->levels[entry->level];
+        completion_level_update_leaf(level, completion_level_bound(level, entry->key, FALSE));
+    }
+}
+
+/**
+ * @brief Records the text of a new task and each of its tags.
+ */
+static void completion_table_add_task(CompletionTable *table, const gchar *text, guint id) {
+    GHashTable *tags = extract_tags(text);
+    GHashTableIter iter;
+    gpointer tag;
+    gchar *trimmed = g_strstrip(g_strdup(text));
+
+    if (*trimmed) {
+        completion_table_use(table, trimmed, id);
+    }
+    g_free(trimmed);
+
+    g_hash_table_iter_init(&iter, tags);
+    while (g_hash_table_iter_next(&iter, &tag, NULL)) {
+        gchar *hashtag = g_strconcat("#", tag, NULL);
+        completion_table_use(table, hashtag, id);
+        g_free(hashtag);
+    }
+    g_hash_table_unref(tags);
+}
+
+/**
+ * @brief Finds the best-ranked keys starting with a prefix.
+ *
+ * @param table The completion table.
+ * @param prefix The typed text.
+ * @param suggestions A GPtrArray that receives the texts (not copied),
+ * best first.
+ */
+static void completion_table_lookup(CompletionTable *table, const gchar *prefix, GPtrArray *suggestions) {
+    gchar *key = g_utf8_casefold(prefix, -1);
+    CompletionEntry *main_top[COMPLETION_MAX_SUGGESTIONS];
+    CompletionEntry *recent_top[COMPLETION_MAX_SUGGESTIONS];
+    guint n_main = completion_level_top(&table->levels[COMPLETION_MAIN], key, main_top);
+    guint n_recent = completion_level_top(&table->levels[COMPLETION_RECENT], key, recent_top);
+    guint i = 0, j = 0;
+
+    g_ptr_array_set_size(suggestions, 0);
+    while (suggestions->len < COMPLETION_MAX_SUGGESTIONS && (i < n_main || j < n_recent)) {
+        if (j == n_recent || (i < n_main && main_top[i]->rank >= recent_top[j]->rank)) {
+            g_ptr_array_add(suggestions, main_top[i++]->text);
+        } else {
+            g_ptr_array_add(suggestions, recent_top[j++]->text);
+        }
+    }
+    g_free(key);
+}
+
+/**
+ * @brief Builds a completion table from a snapshot of task texts. Runs on
+ * a worker thread.
+ */
+static void completion_build_thread(GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable) {
+    GArray *uses = task_data;
+    CompletionTable *table = completion_table_new();
+
+    for (guint i = 0; i < uses->len; i++) {
+        TaskText *use = &g_array_index(uses, TaskText, i);
+        completion_table_add_task(table, use->text, use->id);
+    }
+    completion_table_commit(table);
+    g_task_return_pointer(task, table, (GDestroyNotify)completion_table_free);
+}
+
+/**
+ * @brief Completion callback for the build. Installs the table and
+ * applies the tasks added in the meantime.
+ */
+static void on_completion_built(GObject *source_object, GAsyncResult *result, gpointer user_data) {
+    CompletionIndex *index = user_data;
+
+    index->table = g_task_propagate_pointer(G_TASK(result), NULL);
+    for (guint i = 0; i < index->pending->len; i++) {
+        TaskText *use = &g_array_index(index->pending, TaskText, i);
+        completion_table_add_task(index->table, use->text, use->id);
+    }
+    completion_table_commit(index->table);
+    g_array_set_size(index->pending, 0);
+}
+
+/**
+ * @brief Store listener. Tasks with ids above any seen so far were just
+ * added; edits and toggles are not uses.
+ */
+static void on_completion_store_changed(TaskStore *store, guint position, guint removed, guint added,
+                                        gpointer user_data) {
+    CompletionIndex *index = user_data;
+
+    for (guint i = position; i < position + added; i++) {
+        Task *task = task_store_get(store, i);
+        if (task->id <= index->last_id) {
+            continue;
+        }
+        index->last_id = task->id;
+        if (index->table) {
+            completion_table_add_task(index->table, task->text, task->id);
+        } else {
+            TaskText use = { g_strdup(task->text), task->id };
+            g_array_append_val(index->pending, use);
+        }
+    }
+    if (index->table) {
+        completion_table_commit(index->table);
+    }
+}
+
+/**
+ * @brief Creates the completion index for a store and starts building it
+ * from the store's tasks in the background.
+ *
+ * @param store The loaded task store.
+ * @return A new CompletionIndex. It lives as long as the store.
+ */
+static CompletionIndex *completion_index_new(TaskStore *store) {
+    CompletionIndex *index = g_new0(CompletionIndex, 1);
+    GArray *uses = task_store_snapshot_texts(store);
+
+    index->store = store;
+    index->pending = g_array_new(FALSE, FALSE, sizeof(TaskText));
+    g_array_set_clear_func(index->pending, task_text_clear);
+    if (store->tasks->len > 0) {
+        index->last_id = task_store_get(store, store->tasks->len - 1)->id;
+    }
+    task_store_add_listener(store, on_completion_store_changed, index);
+
+    GTask *task = g_task_new(NULL, NULL, on_completion_built, index);
+    g_task_set_task_data(task, uses, (GDestroyNotify)g_array_unref);
+    g_task_run_in_thread(task, completion_build_thread);
+    g_object_unref(task);
+    return index;
+}
+
+/**
+ * @brief Finds where the word being completed starts: at the last "#tag"
+ * if the text ends in one, otherwise at the start of the text.
+ */
+static const gchar *completion_word_start(const gchar *text) {
+    const gchar *word = text + strlen(text);
+
+    while (word > text && !g_ascii_isspace(word[-1])) {
+        word--;
+    }
+    if (word[0] == '#' && word[1]) {
+        return word;
+    }
+    while (g_ascii_isspace(*text)) {
+        text++;
+    }
+    return text;
+}
+
+/**
+ * @brief Callback for the add-task entry's "changed" signal. Refills the
+ * completion model with the best suggestions for what was typed.
+ *
+ * @param widget The GtkEntry.
+ * @param user_data A pointer to the main window.
+ */
+static void on_entry_changed_complete(GtkWidget *widget, gpointer user_data) {
+    CompletionIndex *index = g_object_get_data(G_OBJECT(user_data), "completion_index");
+    GtkListStore *model = g_object_get_data(G_OBJECT(user_data), "completion_model");
+    const gchar *text = gtk_entry_get_text(GTK_ENTRY(widget));
+    const gchar *word = completion_word_start(text);
+
+    gtk_list_store_clear(model);
+    if (!index->table || *word == '\0') {
+        return;
+    }
+
+    GPtrArray *suggestions = g_ptr_array_new();
+    completion_table_lookup(index->table, word, suggestions);
+    for (guint i = 0; i < suggestions->len; i++) {
+        gtk_list_store_insert_with_values(model, NULL, -1, 0, g_ptr_array_index(suggestions, i), -1);
+    }
+    g_ptr_array_unref(suggestions);
+}
+
+/**
+ * @brief Match function for the entry completion. The model only ever
+ * holds matching suggestions, so every row matches.
+ */
+static gboolean completion_match_all(GtkEntryCompletion *completion, const gchar *key, GtkTreeIter *iter,
+                                     gpointer user_data) {
+    return TRUE;
+}
+
+/**
+ * @brief Callback for the completion's "match-selected" signal. Replaces
+ * only the word being completed, so a tag can be completed mid-task.
+ */
+static gboolean on_completion_match_selected(GtkEntryCompletion *completion, GtkTreeModel *model,
+                                             GtkTreeIter *iter, gpointer user_data) {
+    GtkWidget *entry = gtk_entry_completion_get_entry(completion);
+    const gchar *text = gtk_entry_get_text(GTK_ENTRY(entry));
+    gchar *suggestion;
+    gchar *completed;
+
+    gtk_tree_model_get(model, iter, 0, &suggestion, -1);
+    completed = g_strdup_printf("%.*s%s%s", (int)(completion_word_start(text) - text), text, suggestion,
+                                suggestion[0] == '#' ? " " : "");
+    gtk_entry_set_text(GTK_ENTRY(entry), completed);
+    gtk_editable_set_position(GTK_EDITABLE(entry), -1);
+    g_free(completed);
+    g_free(suggestion);
+    return TRUE;
+}
+
+// --- Duplicate Detection ---
+
+/*
+ * A new task is checked for near duplicates with MinHash locality-sensitive
+ * hashing. A text is reduced to the set of its character trigrams, with
+ * ASCII case folded and each run of spaces and punctuation read as one
+ * space. DUPLICATE_BANDS * DUPLICATE_ROWS min-hashes are taken of that set,
+ * and every band of DUPLICATE_ROWS of them is hashed into one key. Two
+ * texts whose trigram sets have Jaccard similarity J share at least one
+ * band key with probability 1 - (1 - J^ROWS)^BANDS: about 0.9 at J = 0.7
+ * but 0.00005 at J = 0.05. Only the tasks sharing a band key with the new
+ * text get their real similarity computed.
+ *
+ * Band keys are kept as (key << 32 | task id) in sorted arrays, split the
+ * same way as the completion table into a main level and a small recent
+ * one. Entries are never removed one at a time. A candidate that is gone is
+ * skipped, and one whose text changed is compared by its current text. The
+ * index is rebuilt in the background once stale entries outnumber live ones.
+ */
+
+// Bands and min-hashes per band; see above for how they trade recall for speed.
+#define DUPLICATE_BANDS 8
+#define DUPLICATE_ROWS 4
+// Trigram similarity from which two texts count as duplicates.
+#define DUPLICATE_MIN_SIMILARITY 0.6
+// Entries held in the recent level before it is merged into the main one.
+#define DUPLICATE_RECENT_MAX 16384
+// Candidates checked at most per lookup, e.g. when a text was added many times.
+#define DUPLICATE_MAX_CANDIDATES 64
+// In-place changes up to this many tasks are checked for edited texts.
+#define DUPLICATE_RESIGN_MAX 64
+// Entries sharing a band key that the report compares each entry with.
+#define DUPLICATE_RUN_WINDOW 8
+// Groups listed at most in the duplicates report.
+#define DUPLICATE_REPORT_MAX_GROUPS 200
+
+typedef struct {
+    GArray *main;                // guint64 entries (band key << 32 | task id), sorted.
+    GArray *recent;              // Entries added since the last merge, sorted.
+} DuplicateTable;
+
+/**
+ * @brief The duplicate index shared by all windows.
+ */
+typedef struct {
+    TaskStore *store;
+    DuplicateTable *table;       // NULL until the first build finishes.
+    GArray *pending;             // TaskText copies of tasks changed during a build.
+    guint last_id;               // Highest task id seen; newer tasks are additions.
+    guint stale;                 // Entries left behind by removed or edited tasks.
+    gboolean building;
+} DuplicateIndex;
+
+/**
+ * @brief A slice of a text snapshot, signed on a worker thread.
+ */
+typedef struct {
+    const TaskText *texts;
+    guint n_texts;
+    guint base;                  // Snapshot index of texts[0].
+    gboolean by_index;           // Tag entries with snapshot indices, not task ids.
+    GArray *entries;             // The band entries produced.
+} DuplicateChunk;
+
+/**
+ * @brief A range of sorted entries that the report scans for similar pairs.
+ */
+typedef struct {
+    GArray *texts;
+    GArray *entries;
+    guint start;                 // Both ends fall on band key boundaries.
+    guint end;
+    guint *parents;              // Union-find forest over snapshot indices, shared by all scans.
+} DuplicateScan;
+
+static inline guint64 duplicate_mix(guint64 x) {
+    // The splitmix64 finalizer.
+    x ^= x >> 30;
+    x *= G_GUINT64_CONSTANT(0xbf58476d1ce4e5b9);
+    x ^= x >> 27;
+    x *= G_GUINT64_CONSTANT(0x94d049bb133111eb);
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Collects the distinct character trigrams of a text.
+ *
+ * ASCII letters are folded to lower case, other non-ASCII bytes are kept
+ * and every run of anything else reads as one space, so "Fix: login" and
+ * "fix login" give the same set. Safe to call from worker threads.
+ *
+ * @param text The task text.
+ * @param shingles A GArray of guint32 that receives the trigrams, sorted.
+ */
+static void duplicate_shingles(const gchar *text, GArray *shingles) {
+    guint32 window = ' ';
+    guint n_chars = 1;
+    gboolean space = TRUE;
+
+    g_array_set_size(shingles, 0);
+    for (const guchar *p = (const guchar *)text; ; p++) {
+        guchar c;
+        if (*p >= 0x80 || g_ascii_isalnum(*p)) {
+            c = g_ascii_tolower(*p);
+            space = FALSE;
+        } else if (!space || *p == '\0') {
+            c = ' ';
+            space = TRUE;
+        } else {
+            continue;
+        }
+        // A text ending in punctuation already closed its last word.
+        if (*p == '\0' && (window & 0xFF) == ' ') {
+            break;
+        }
+        window = (window << 8 | c) & 0xFFFFFF;
+        if (++n_chars >= 3) {
+            // Task texts are short, so insertion keeps the set sorted cheaply.
+            guint i = shingles->len;
+            while (i > 0 && g_array_index(shingles, guint32, i - 1) > window) {
+                i--;
+            }
+            if (i == 0 || g_array_index(shingles, guint32, i - 1) != window) {
+                g_array_insert_val(shingles, i, window);
+            }
+        }
+        if (*p == '\0') {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Computes the band keys of a trigram set.
+ *
+ * @param shingles The trigrams, from duplicate_shingles().
+ * @param keys Return location for DUPLICATE_BANDS keys.
+ * @return FALSE if the set is empty and there is nothing to compare.
+ */
+static gboolean duplicate_signature(const GArray *shingles, guint32 *keys) {
+    guint64 multipliers[DUPLICATE_BANDS * DUPLICATE_ROWS];
+    guint32 minima[DUPLICATE_BANDS * DUPLICATE_ROWS];
+
+    if (shingles->len == 0) {
+        return FALSE;
+    }
+    for (guint i = 0; i < G_N_ELEMENTS(minima); i++) {
+        multipliers[i] = duplicate_mix(i + 1) | 1;
+        minima[i] = G_MAXUINT32;
+    }
+    for (guint s = 0; s < shingles->len; s++) {
+        guint64 x = duplicate_mix(g_array_index(shingles, guint32, s));
+        // Multiply-shift hashing: one multiplication per hash function.
+        for (guint i = 0; i < G_N_ELEMENTS(minima); i++) {
+            minima[i] = MIN(minima[i], (guint32)((x * multipliers[i]) >> 32));
+        }
+    }
+    for (guint band = 0; band < DUPLICATE_BANDS; band++) {
+        guint64 hash = band;
+        for (guint row = 0; row < DUPLICATE_ROWS; row++) {
+            hash = duplicate_mix(hash ^ ((guint64)minima[band * DUPLICATE_ROWS + row] << 16));
+        }
+        keys[band] = hash >> 32;
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Returns the Jaccard similarity of two sorted trigram sets.
+ */
+static gdouble duplicate_similarity(const GArray *a, const GArray *b) {
+    guint i = 0, j = 0, shared = 0;
+
+    while (i < a->len && j < b->len) {
+        guint32 va = g_array_index(a, guint32, i);
+        guint32 vb = g_array_index(b, guint32, j);
+        shared += va == vb;
+        i += va <= vb;
+        j += vb <= va;
+    }
+    return a->len + b->len > shared ? (gdouble)shared / (a->len + b->len - shared) : 0.0;
+}
+
+/**
+ * @brief Returns the index of the first entry not less than @value.
+ */
+static guint duplicate_entries_lower_bound(GArray *entries, guint64 value) {
+    guint low = 0, high = entries->len;
+
+    while (low < high) {
+        guint middle = low + (high - low) / 2;
+        if (g_array_index(entries, guint64, middle) < value) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Sorts band entries by key. Stable, so entries that arrive in tag
+ * order come out fully sorted.
+ */
+static void duplicate_sort_entries(GArray *entries) {
+    guint64 *data = (guint64 *)entries->data;
+    guint64 *scratch = g_new(guint64, entries->len);
+    guint *counts = g_new(guint, 0x10001);
+
+    // Two 16-bit radix passes over the key; the second moves the data back.
+    for (guint shift = 32; shift < 64; shift += 16) {
+        memset(counts, 0, 0x10001 * sizeof(guint));
+        for (guint i = 0; i < entries->len; i++) {
+            counts[((data[i] >> shift) & 0xFFFF) + 1]++;
+        }
+        for (guint digit = 1; digit <= 0xFFFF; digit++) {
+            counts[digit] += counts[digit - 1];
+        }
+        for (guint i = 0; i < entries->len; i++) {
+            scratch[counts[(data[i] >> shift) & 0xFFFF]++] = data[i];
+        }
+        guint64 *swap = data;
+        data = scratch;
+        scratch = swap;
+    }
+    g_free(scratch);
+    g_free(counts);
+}
+
+static DuplicateTable *duplicate_table_new(GArray *entries) {
+    DuplicateTable *table = g_new0(DuplicateTable, 1);
+    table->main = entries;
+    table->recent = g_array_new(FALSE, FALSE, sizeof(guint64));
+    return table;
+}
+
+static void duplicate_table_free(DuplicateTable *table) {
+    g_array_unref(table->main);
+    g_array_unref(table->recent);
+    g_free(table);
+}
+
+/**
+ * @brief Merges the recent level into the main one.
+ */
+static void duplicate_table_merge(DuplicateTable *table) {
+    GArray *merged = g_array_sized_new(FALSE, FALSE, sizeof(guint64), table->main->len + table->recent->len);
+    guint i = 0, j = 0;
+
+    while (i < table->main->len || j < table->recent->len) {
+        if (j == table->recent->len ||
+            (i < table->main->len &&
+             g_array_index(table->main, guint64, i) < g_array_index(table->recent, guint64, j))) {
+            g_array_append_val(merged, g_array_index(table->main, guint64, i));
+            i++;
+        } else {
+            g_array_append_val(merged, g_array_index(table->recent, guint64, j));
+            j++;
+        }
+    }
+    g_array_unref(table->main);
+    table->main = merged;
+    g_array_set_size(table->recent, 0);
+}
+
+/**
+ * @brief Adds the band entries of one task, skipping any already present.
+ *
+ * @return The number of entries added.
+ */
+static guint duplicate_table_add(DuplicateTable *table, const guint32 *keys, guint id) {
+    guint added = 0;
+
+    for (guint band = 0; band < DUPLICATE_BANDS; band++) {
+        guint64 entry = (guint64)keys[band] << 32 | id;
+        guint i = duplicate_entries_lower_bound(table->main, entry);
+        if (i < table->main->len && g_array_index(table->main, guint64, i) == entry) {
+            continue;
+        }
+        i = duplicate_entries_lower_bound(table->recent, entry);
+        if (i < table->recent->len && g_array_index(table->recent, guint64, i) == entry) {
+            continue;
+        }
+        g_array_insert_val(table->recent, i, entry);
+        added++;
+    }
+    if (table->recent->len > DUPLICATE_RECENT_MAX) {
+        duplicate_table_merge(table);
+    }
+    return added;
+}
+
+/**
+ * @brief Collects the ids of the tasks sharing a band key with @keys.
+ *
+ * @param ids A GArray of guint that receives the ids, sorted and distinct.
+ */
+static void duplicate_table_candidates(DuplicateTable *table, const guint32 *keys, GArray *ids) {
+    GArray *levels[] = { table->main, table->recent };
+
+    g_array_set_size(ids, 0);
+    for (guint band = 0; band < DUPLICATE_BANDS; band++) {
+        for (guint l = 0; l < G_N_ELEMENTS(levels); l++) {
+            GArray *entries = levels[l];
+            for (guint i = duplicate_entries_lower_bound(entries, (guint64)keys[band] << 32);
+                 i < entries->len && (g_array_index(entries, guint64, i) >> 32) == keys[band] &&
+                 ids->len < DUPLICATE_MAX_CANDIDATES;
+                 i++) {
+                guint id = (guint32)g_array_index(entries, guint64, i);
+                g_array_append_val(ids, id);
+            }
+        }
+    }
+
+    g_array_sort(ids, compare_guint32);
+    guint kept = 0;
+    for (guint i = 0; i < ids->len; i++) {
+        guint id = g_array_index(ids, guint, i);
+        if (kept == 0 || g_array_index(ids, guint, kept - 1) != id) {
+            g_array_index(ids, guint, kept++) = id;
+        }
+    }
+    g_array_set_size(ids, kept);
+}
+
+/**
+ * @brief Thread pool function that signs one chunk of a snapshot.
+ */
+static void duplicate_sign_chunk(gpointer data, gpointer user_data) {
+    DuplicateChunk *chunk = data;
+    GArray *shingles = g_array_new(FALSE, FALSE, sizeof(guint32));
+    guint32 keys[DUPLICATE_BANDS];
+
+    for (guint i = 0; i < chunk->n_texts; i++) {
+        duplicate_shingles(chunk->texts[i].text, shingles);
+        if (!duplicate_signature(shingles, keys)) {
+            continue;
+        }
+        guint tag = chunk->by_index ? chunk->base + i : chunk->texts[i].id;
+        for (guint band = 0; band < DUPLICATE_BANDS; band++) {
+            guint64 entry = (guint64)keys[band] << 32 | tag;
+            g_array_append_val(chunk->entries, entry);
+        }
+    }
+    g_array_unref(shingles);
+}
+
+/**
+ * @brief Computes the band entries of a whole snapshot on a thread pool.
+ *
+ * @param texts A GArray of TaskText.
+ * @param by_index Whether entries carry snapshot indices instead of ids.
+ * @return A GArray of guint64 entries, sorted and distinct.
+ */
+static GArray *duplicate_sign_all(GArray *texts, gboolean by_index) {
+    guint n_threads = get_load_thread_count();
+    guint n_chunks = MAX(MIN(n_threads * PARALLEL_LOAD_CHUNKS_PER_THREAD, texts->len), 1);
+    guint chunk_size = (texts->len + n_chunks - 1) / MAX(n_chunks, 1);
+    DuplicateChunk *chunks = g_new0(DuplicateChunk, n_chunks);
+    GArray *entries = g_array_sized_new(FALSE, FALSE, sizeof(guint64), texts->len * DUPLICATE_BANDS);
+
+    for (guint i = 0; i < n_chunks; i++) {
+        chunks[i].base = MIN(i * chunk_size, texts->len);
+        chunks[i].n_texts = MIN(chunk_size, texts->len - chunks[i].base);
+        chunks[i].texts = &g_array_index(texts, TaskText, 0) + chunks[i].base;
+        chunks[i].by_index = by_index;
+        chunks[i].entries = g_array_new(FALSE, FALSE, sizeof(guint64));
+    }
+    if (n_chunks == 1 || n_threads == 1) {
+        for (guint i = 0; i < n_chunks; i++) {
+            duplicate_sign_chunk(&chunks[i], NULL);
+        }
+    } else {
+        GThreadPool *pool = g_thread_pool_new(duplicate_sign_chunk, NULL, n_threads, FALSE, NULL);
+        for (guint i = 0; i < n_chunks; i++) {
+            g_thread_pool_push(pool, &chunks[i], NULL);
+        }
+        g_thread_pool_free(pool, FALSE, TRUE);
+    }
+
+    // Chunks are in snapshot order, so each key's entries arrive in tag order.
+    for (guint i = 0; i < n_chunks; i++) {
+        g_array_append_vals(entries, chunks[i].entries->data, chunks[i].entries->len);
+        g_array_unref(chunks[i].entries);
+    }
+    g_free(chunks);
+
+    duplicate_sort_entries(entries);
+    guint kept = 0;
+    for (guint i = 0; i < entries->len; i++) {
+        guint64 entry = g_array_index(entries, guint64, i);
+        if (kept == 0 || g_array_index(entries, guint64, kept - 1) != entry) {
+            g_array_index(entries, guint64, kept++) = entry;
+        }
+    }
+    g_array_set_size(entries, kept);
+    return entries;
+}
+
+/**
+ * @brief Builds a duplicate table from a snapshot. Runs on a worker thread.
+ */
+static void duplicate_build_thread(GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable) {
+    g_task_return_pointer(task, duplicate_table_new(duplicate_sign_all(task_data, FALSE)),
+                          (GDestroyNotify)duplicate_table_free);
+}
+
+/**
+ * @brief Adds one task to the index, or queues it while a build runs.
+ *
+ * @param index The duplicate index.
+ * @param task The task that was added or may have been edited.
+ * @param edited Whether the task was indexed before, so that entries it
+ * replaces become stale.
+ */
+static void duplicate_index_add(DuplicateIndex *index, Task *task, gboolean edited) {
+    GArray *shingles;
+    guint32 keys[DUPLICATE_BANDS];
+
+    if (index->building) {
+        TaskText copy = { g_strdup(task->text), task->id };
+        g_array_append_val(index->pending, copy);
+    }
+    if (!index->table) {
+        return;
+    }
+    shingles = g_array_new(FALSE, FALSE, sizeof(guint32));
+    duplicate_shingles(task->text, shingles);
+    if (duplicate_signature(shingles, keys)) {
+        guint added = duplicate_table_add(index->table, keys, task->id);
+        if (edited) {
+            index->stale += added;
+        }
+    }
+    g_array_unref(shingles);
+}
+
+/**
+ * @brief Completion callback for the build. Installs the table and adds
+ * the tasks that changed in the meantime.
+ */
+static void on_duplicate_built(GObject *source_object, GAsyncResult *result, gpointer user_data) {
+    DuplicateIndex *index = user_data;
+    GArray *shingles = g_array_new(FALSE, FALSE, sizeof(guint32));
+    guint32 keys[DUPLICATE_BANDS];
+
+    if (index->table) {
+        duplicate_table_free(index->table);
+    }
+    index->table = g_task_propagate_pointer(G_TASK(result), NULL);
+    index->building = FALSE;
+    index->stale = 0;
+    for (guint i = 0; i < index->pending->len; i++) {
+        TaskText *copy = &g_array_index(index->pending, TaskText, i);
+        duplicate_shingles(copy->text, shingles);
+        if (duplicate_signature(shingles, keys)) {
+            duplicate_table_add(index->table, keys, copy->id);
+        }
+    }
+    g_array_set_size(index->pending, 0);
+    g_array_unref(shingles);
+}
+
+/**
+ * @brief Starts building a fresh table from the store's tasks in the
+ * background. The old table, if any, keeps answering until it is done.
+ */
+static void duplicate_index_build(DuplicateIndex *index) {
+    GTask *task = g_task_new(NULL, NULL, on_duplicate_built, index);
+
+    index->building = TRUE;
+    g_task_set_task_data(task, task_store_snapshot_texts(index->store), (GDestroyNotify)g_array_unref);
+    g_task_run_in_thread(task, duplicate_build_thread);
+    g_object_unref(task);
+}
+
+/**
+ * @brief Store listener. New tasks are added; small in-place changes may be
+ * text edits and are signed again, which adds nothing if the text is the
+ * same. Bulk changes only toggle completion.
+ */
+static void on_duplicate_store_changed(TaskStore *store, guint position, guint removed, guint added,
+                                       gpointer user_data) {
+    DuplicateIndex *index = user_data;
+
+    if (removed > added) {
+        index->stale += (removed - added) * DUPLICATE_BANDS;
+    }
+    for (guint i = position; i < position + added; i++) {
+        Task *task = task_store_get(store, i);
+        if (task->id > index->last_id) {
+            index->last_id = task->id;
+            duplicate_index_add(index, task, FALSE);
+        } else if (removed == added && added <= DUPLICATE_RESIGN_MAX) {
+            duplicate_index_add(index, task, TRUE);
+        }
+    }
+    if (index->table && !index->building && index->stale > store->tasks->len * DUPLICATE_BANDS) {
+        duplicate_index_build(index);
+    }
+}
+
+/**
+ * @brief Creates the duplicate index for a store and starts building it
+ * from the store's tasks in the background.
+ *
+ * @param store The loaded task store.
+ * @return A new DuplicateIndex. It lives as long as the store.
+ */
+static DuplicateIndex *duplicate_index_new(TaskStore *store) {
+    DuplicateIndex *index = g_new0(DuplicateIndex, 1);
+
+    index->store = store;
+    index->pending = g_array_new(FALSE, FALSE, sizeof(TaskText));
+    g_array_set_clear_func(index->pending, task_text_clear);
+    if (store->tasks->len > 0) {
+        index->last_id = task_store_get(store, store->tasks->len - 1)->id;
+    }
+    task_store_add_listener(store, on_duplicate_store_changed, index);
+    duplicate_index_build(index);
+    return index;
+}
+
+/**
+ * @brief Finds the existing task most similar to a text.
+ *
+ * @param index The duplicate index.
+ * @param text The text about to be added.
+ * @param similarity Return location for the trigram similarity.
+ * @return The task, or NULL if none is similar enough or the index is
+ * still being built.
+ */
+static Task *duplicate_index_find(DuplicateIndex *index, const gchar *text, gdouble *similarity) {
+    GArray *shingles, *other, *ids;
+    guint32 keys[DUPLICATE_BANDS];
+    Task *best = NULL;
+
+    *similarity = 0.0;
+    if (!index->table) {
+        return NULL;
+    }
+    shingles = g_array_new(FALSE, FALSE, sizeof(guint32));
+    other = g_array_new(FALSE, FALSE, sizeof(guint32));
+    ids = g_array_new(FALSE, FALSE, sizeof(guint));
+    duplicate_shingles(text, shingles);
+    if (duplicate_signature(shingles, keys)) {
+        duplicate_table_candidates(index->table, keys, ids);
+    }
+    for (guint i = 0; i < ids->len; i++) {
+        guint position;
+        if (!task_store_find(index->store, g_array_index(ids, guint, i), &position)) {
+            continue;
+        }
+        Task *task = task_store_get(index->store, position);
+        duplicate_shingles(task->text, other);
+        gdouble candidate = duplicate_similarity(shingles, other);
+        if (candidate >= DUPLICATE_MIN_SIMILARITY && candidate > *similarity) {
+            *similarity = candidate;
+            best = task;
+        }
+    }
+    g_array_unref(shingles);
+    g_array_unref(other);
+    g_array_unref(ids);
+    return best;
+}
+
+/**
+ * @brief Checks the text about to be added for a near duplicate, and flags
+ * it below the entry if there is one. Adding the same text again goes
+ * ahead.
+ *
+ * @param window The main window.
+ * @param text The text in the add-task entry.
+ * @return TRUE if the text was flagged and should not be added yet.
+ */
+static gboolean duplicate_check_entry(GtkWidget *window, const gchar *text) {
+    DuplicateIndex *index = g_object_get_data(G_OBJECT(window), "duplicate_index");
+    GtkWidget *entry = g_object_get_data(G_OBJECT(window), "entry");
+    GtkWidget *label = g_object_get_data(G_OBJECT(window), "duplicate_label");
+    const gchar *flagged = g_object_get_data(G_OBJECT(window), "duplicate_flagged");
+    gdouble similarity;
+    Task *task;
+
+    if (g_strcmp0(flagged, text) == 0) {
+        return FALSE;
+    }
+    task = duplicate_index_find(index, text, &similarity);
+    if (!task) {
+        return FALSE;
+    }
+
+    gchar *message = g_strdup_printf("Looks like a duplicate of \"%s\" (%d%% alike). Press Add again to add it anyway.",
+                                     task->text, (int)(similarity * 100));
+    gtk_label_set_text(GTK_LABEL(label), message);
+    gtk_widget_show(label);
+    gtk_style_context_add_class(gtk_widget_get_style_context(entry), "warning");
+    g_object_set_data_full(G_OBJECT(window), "duplicate_flagged", g_strdup(text), g_free);
+    g_free(message);
+    return TRUE;
+}
+
+/**
+ * @brief Callback for the add-task entry's "changed" signal. Editing the
+ * text clears a duplicate flag.
+ *
+ * @param widget The GtkEntry.
+ * @param user_data A pointer to the main window.
+ */
+static void on_entry_changed_duplicate(GtkWidget *widget, gpointer user_data) {
+    if (!g_object_get_data(G_OBJECT(user_data), "duplicate_flagged")) {
+        return;
+    }
+    gtk_widget_hide(g_object_get_data(G_OBJECT(user_data), "duplicate_label"));
+    gtk_style_context_remove_class(gtk_widget_get_style_context(widget), "warning");
+    g_object_set_data(G_OBJECT(user_data), "duplicate_flagged", NULL);
+}
+
+/**
+ * @brief Returns the root of an element's group, halving the path on the
+ * way. Safe to run concurrently with duplicate_union().
+ */
+static guint duplicate_find_root(guint *parents, guint i) {
+    guint parent;
+
+    while ((parent = g_atomic_int_get((gint *)&parents[i])) != i) {
+        guint grandparent = g_atomic_int_get((gint *)&parents[parent]);
+        g_atomic_int_compare_and_exchange((gint *)&parents[i], parent, grandparent);
+        i = grandparent;
+    }
+    return i;
+}
+
+/**
+ * @brief Joins the groups of two elements. The higher root is linked under
+ * the lower, so every root is the lowest index of its group. Lock-free; a
+ * lost race is retried from the new roots.
+ */
+static void duplicate_union(guint *parents, guint a, guint b) {
+    for (;;) {
+        a = duplicate_find_root(parents, a);
+        b = duplicate_find_root(parents, b);
+        if (a == b ||
+            g_atomic_int_compare_and_exchange((gint *)&parents[MAX(a, b)], MAX(a, b), MIN(a, b))) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Thread pool function that joins the similar tasks in one range of
+ * sorted entries. Each entry is compared with a few entries before it that
+ * share its band key, skipping pairs already found through another band.
+ */
+static void duplicate_scan_range(gpointer data, gpointer user_data) {
+    DuplicateScan *scan = data;
+    // Trigrams of the last few entries of the current run, computed on demand.
+    GArray *shingles[DUPLICATE_RUN_WINDOW + 1];
+    gboolean ready[DUPLICATE_RUN_WINDOW + 1];
+    guint run = 0;
+
+    for (guint k = 0; k < G_N_ELEMENTS(shingles); k++) {
+        shingles[k] = g_array_new(FALSE, FALSE, sizeof(guint32));
+    }
+    for (guint i = scan->start; i < scan->end; i++) {
+        guint64 entry = g_array_index(scan->entries, guint64, i);
+        guint a = (guint32)entry;
+
+        if (i == scan->start || g_array_index(scan->entries, guint64, i - 1) >> 32 != entry >> 32) {
+            run = 0;
+        } else {
+            run++;
+        }
+        guint slot = run % G_N_ELEMENTS(shingles);
+        ready[slot] = FALSE;
+
+        for (guint back = 1; back <= MIN(run, DUPLICATE_RUN_WINDOW); back++) {
+            guint b = (guint32)g_array_index(scan->entries, guint64, i - back);
+            guint other = (run - back) % G_N_ELEMENTS(shingles);
+            if (duplicate_find_root(scan->parents, a) == duplicate_find_root(scan->parents, b)) {
+                continue;
+            }
+            if (!ready[slot]) {
+                duplicate_shingles(g_array_index(scan->texts, TaskText, a).text, shingles[slot]);
+                ready[slot] = TRUE;
+            }
+            if (!ready[other]) {
+                duplicate_shingles(g_array_index(scan->texts, TaskText, b).text, shingles[other]);
+                ready[other] = TRUE;
+            }
+            if (duplicate_similarity(shingles[slot], shingles[other]) >= DUPLICATE_MIN_SIMILARITY) {
+                duplicate_union(scan->parents, a, b);
+            }
+        }
+    }
+    for (guint k = 0; k < G_N_ELEMENTS(shingles); k++) {
+        g_array_unref(shingles[k]);
+    }
+}
+
+static gint compare_groups_by_size(gconstpointer a, gconstpointer b) {
+    GArray *group_a = *(GArray *const *)a;
+    GArray *group_b = *(GArray *const *)b;
+    return (group_a->len < group_b->len) - (group_a->len > group_b->len);
+}
+
+/**
+ * @brief Finds every group of near duplicates in a snapshot and writes a
+ * report of them. Runs on a worker thread and fans out to a thread pool.
+ */
+static void duplicate_report_thread(GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable) {
+    GArray *texts = task_data;
+    GArray *entries = duplicate_sign_all(texts, TRUE);
+    guint n_threads = get_load_thread_count();
+    guint n_scans = MAX(MIN(n_threads * PARALLEL_LOAD_CHUNKS_PER_THREAD, entries->len), 1);
+    DuplicateScan *scans = g_new0(DuplicateScan, n_scans);
+    guint *parents = g_new(guint, MAX(texts->len, 1));
+    GPtrArray *groups;
+    GString *report;
+
+    if (g_task_return_error_if_cancelled(task)) {
+        g_array_unref(entries);
+        g_free(scans);
+        g_free(parents);
+        return;
+    }
+    for (guint i = 0; i < texts->len; i++) {
+        parents[i] = i;
+    }
+
+    // Split at key boundaries so that no run of equal keys spans two scans.
+    guint start = 0;
+    for (guint i = 0; i < n_scans; i++) {
+        guint end = i == n_scans - 1 ? entries->len : MAX(start, (guint)((guint64)entries->len * (i + 1) / n_scans));
+        while (end > start && end < entries->len &&
+               g_array_index(entries, guint64, end) >> 32 == g_array_index(entries, guint64, end - 1) >> 32) {
+            end++;
+        }
+        scans[i].texts = texts;
+        scans[i].entries = entries;
+        scans[i].start = start;
+        scans[i].end = end;
+        scans[i].parents = parents;
+        start = end;
+    }
+    if (n_scans == 1 || n_threads == 1) {
+        for (guint i = 0; i < n_scans; i++) {
+            duplicate_scan_range(&scans[i], NULL);
+        }
+    } else {
+        GThreadPool *pool = g_thread_pool_new(duplicate_scan_range, NULL, n_threads, FALSE, NULL);
+        for (guint i = 0; i < n_scans; i++) {
+            g_thread_pool_push(pool, &scans[i], NULL);
+        }
+        g_thread_pool_free(pool, FALSE, TRUE);
+    }
+    g_array_unref(entries);
+    g_free(scans);
+
+    // Roots are the lowest index in their group, so each group is created
+    // at its root and filled in index order.
+    guint *sizes = g_new0(guint, MAX(texts->len, 1));
+    for (guint i = 0; i < texts->len; i++) {
+        sizes[duplicate_find_root(parents, i)]++;
+    }
+    GHashTable *by_root = g_hash_table_new(g_direct_hash, g_direct_equal);
+    groups = g_ptr_array_new_with_free_func((GDestroyNotify)g_array_unref);
+    for (guint i = 0; i < texts->len; i++) {
+        guint root = duplicate_find_root(parents, i);
+        GArray *group;
+        if (sizes[root] < 2) {
+            continue;
+        }
+        if (root == i) {
+            group = g_array_sized_new(FALSE, FALSE, sizeof(guint), sizes[root]);
+            g_hash_table_insert(by_root, GUINT_TO_POINTER(root), group);
+            g_ptr_array_add(groups, group);
+        } else {
+            group = g_hash_table_lookup(by_root, GUINT_TO_POINTER(root));
+        }
+        g_array_append_val(group, i);
+    }
+    g_hash_table_unref(by_root);
+    g_free(sizes);
+    g_free(parents);
+    g_ptr_array_sort(groups, compare_groups_by_size);
+
+    guint n_groups = groups->len;
+    report = g_string_new(NULL);
+    if (n_groups == 0) {
+        g_string_append_printf(report, "No likely duplicates among %u tasks.\n", texts->len);
+    } else {
+        g_string_append_printf(report, "%u group(s) of likely duplicates among %u tasks:\n", n_groups, texts->len);
+        for (guint g = 0; g < MIN(n_groups, DUPLICATE_REPORT_MAX_GROUPS); g++) {
+            GArray *group = g_ptr_array_index(groups, g);
+            g_string_append_c(report, '\n');
+            for (guint i = 0; i < group->len; i++) {
+                g_string_append_printf(report, "  %s\n", g_array_index(texts, TaskText, g_array_index(group, guint, i)).text);
+            }
+        }
+        if (n_groups > DUPLICATE_REPORT_MAX_GROUPS) {
+            g_string_append_printf(report, "\n...and %u more group(s).\n", n_groups - DUPLICATE_REPORT_MAX_GROUPS);
+        }
+    }
+    g_ptr_array_unref(groups);
+    g_task_return_pointer(task, g_string_free(report, FALSE), g_free);
+}
+
+/**
+ * @brief Completion callback for the duplicates report. Shows the report
+ * in a dialog.
+ */
+static void on_duplicate_report_done(GObject *source_object, GAsyncResult *result, gpointer user_data) {
+    GtkWidget *window = GTK_WIDGET(source_object);
+    gchar *report = g_task_propagate_pointer(G_TASK(result), NULL);
+    GtkWidget *dialog;
+    GtkWidget *scrolled;
+    GtkWidget *text_view;
+
+    if (!report) {
+        // Cancelled, because the window closed or a newer report started.
+        return;
+    }
+    g_object_set_data(G_OBJECT(window), "duplicate_report_cancellable", NULL);
+
+    dialog = gtk_dialog_new_with_buttons("Duplicates", GTK_WINDOW(window), GTK_DIALOG_DESTROY_WITH_PARENT,
+                                         "_Close", GTK_RESPONSE_CLOSE, NULL);
+    gtk_window_set_default_size(GTK_WINDOW(dialog), 520, 420);
+    scrolled = gtk_scrolled_window_new(NULL, NULL);
+    gtk_widget_set_vexpand(scrolled, TRUE);
+    text_view = gtk_text_view_new();
+    gtk_text_view_set_editable(GTK_TEXT_VIEW(text_view), FALSE);
+    gtk_text_view_set_cursor_visible(GTK_TEXT_VIEW(text_view), FALSE);
+    gtk_text_view_set_wrap_mode(GTK_TEXT_VIEW(text_view), GTK_WRAP_WORD_CHAR);
+    gtk_text_buffer_set_text(gtk_text_view_get_buffer(GTK_TEXT_VIEW(text_view)), report, -1);
+    gtk_container_add(GTK_CONTAINER(scrolled), text_view);
+    gtk_container_add(GTK_CONTAINER(gtk_dialog_get_content_area(GTK_DIALOG(dialog))), scrolled);
+    g_signal_connect(dialog, "response", G_CALLBACK(gtk_widget_destroy), NULL);
+    gtk_widget_show_all(dialog);
+    g_free(report);
+}
+
+/**
+ * @brief Cancels the duplicates report running for a window, if any.
+ *
+ * @param window The GtkApplicationWindow.
+ */
+static void duplicate_report_cancel(GtkWidget *window) {
+    GCancellable *cancellable = g_object_get_data(G_OBJECT(window), "duplicate_report_cancellable");
+
+    if (cancellable) {
+        g_cancellable_cancel(cancellable);
+        g_object_set_data(G_OBJECT(window), "duplicate_report_cancellable", NULL);
+    }
+}
+
+/**
+ * @brief Action handler for "win.find-duplicates". Finds every group of
+ * near duplicates in the background and shows them when done.
+ */
+static void on_find_duplicates_action(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    GtkWidget *window = user_data;
+    TaskStore *store = g_object_get_data(G_OBJECT(window), "store");
+    GCancellable *cancellable = g_cancellable_new();
+
+    duplicate_report_cancel(window);
+    g_object_set_data_full(G_OBJECT(window), "duplicate_report_cancellable", cancellable, g_object_unref);
+
+    GTask *task = g_task_new(window, cancellable, on_duplicate_report_done, NULL);
+    g_task_set_task_data(task, task_store_snapshot_texts(store), (GDestroyNotify)g_array_unref);
+    g_task_run_in_thread(task, duplicate_report_thread);
+    g_object_unref(task);
+}
+
+// --- Saved Views ---
+
+/**
+ * @brief A named query whose result is kept up to date in the background,
+ * so switching to it costs nothing.
+ */
+typedef struct {
+    gchar *name;
+    QueryResult *result;
+} SavedView;
+
+static void saved_view_free(gpointer data) {
+    SavedView *saved = data;
+    g_free(saved->name);
+    query_result_free(saved->result);
+    g_free(saved);
+}
+
+/**
+ * @brief Returns the application's saved views.
+ */
+static GPtrArray *get_saved_views(GtkApplication *app) {
+    return g_object_get_data(G_OBJECT(app), "saved_views");
+}
+
+/**
+ * @brief Finds a saved view by name.
+ */
+static SavedView *find_saved_view(GPtrArray *views, const gchar *name) {
+    for (guint i = 0; i < views->len; i++) {
+        SavedView *saved = g_ptr_array_index(views, i);
+        if (g_strcmp0(saved->name, name) == 0) {
+            return saved;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Loads the saved views from VIEWS_FILE. Each line is
+ * "name<TAB>query".
+ *
+ * @param views The array to fill.
+ * @param store The task store the views are materialized over.
+ */
+static void load_saved_views(GPtrArray *views, TaskStore *store) {
+    gchar *contents = NULL;
+    gchar **lines;
+
+    if (!g_file_get_contents(VIEWS_FILE, &contents, NULL, NULL)) {
+        return;
+    }
+    lines = g_strsplit(contents, "\n", -1);
+    for (guint i = 0; lines[i]; i++) {
+        gchar *tab = strchr(lines[i], '\t');
+        GError *error = NULL;
+        Query *query;
+
+        if (!tab) {
+            continue;
+        }
+        *tab = '\0';
+        query = query_compile(tab + 1, &error);
+        if (!query) {
+            g_warning("Skipping saved view '%s': %s", lines[i], error->message);
+            g_error_free(error);
+            continue;
+        }
+        SavedView *saved = g_new0(SavedView, 1);
+        saved->name = g_strdup(lines[i]);
+        saved->result = query_result_new(store, query);
+        g_ptr_array_add(views, saved);
+    }
+    g_strfreev(lines);
+    g_free(contents);
+}
+
+/**
+ * @brief Writes the saved views to VIEWS_FILE, unless the store is
+ * read-only.
+ */
+static void save_saved_views(GPtrArray *views, TaskStore *store) {
+    GString *contents;
+    GError *error = NULL;
+
+    if (store->read_only) {
+        return;
+    }
+    contents = g_string_new(NULL);
+    for (guint i = 0; i < views->len; i++) {
+        SavedView *saved = g_ptr_array_index(views, i);
+        g_string_append_printf(contents, "%s\t%s\n", saved->name, saved->result->query->source);
+    }
+    if (!g_file_set_contents(VIEWS_FILE, contents->str, contents->len, &error)) {
+        g_warning("Could not save views: %s", error->message);
+        g_error_free(error);
+    }
+    g_string_free(contents, TRUE);
+}
+
+static void on_view_combo_changed(GtkComboBox *combo, gpointer user_data);
+
+/**
+ * @brief Rebuilds a window's view switcher and selects what its list shows:
+ * "All Tasks", a saved view, or nothing for an ad hoc filter.
+ *
+ * @param window The main window.
+ */
+static void refresh_view_combo(GtkWidget *window) {
+    GtkComboBoxText *combo = g_object_get_data(G_OBJECT(window), "view_combo");
+    TaskListView *view = g_object_get_data(G_OBJECT(window), "view");
+    GPtrArray *views = get_saved_views(gtk_window_get_application(GTK_WINDOW(window)));
+    const gchar *active_id = view->filter ? NULL : "";
+
+    g_signal_handlers_block_by_func(combo, on_view_combo_changed, window);
+    gtk_combo_box_text_remove_all(combo);
+    gtk_combo_box_text_append(combo, "", "All Tasks");
+    for (guint i = 0; i < views->len; i++) {
+        SavedView *saved = g_ptr_array_index(views, i);
+        gtk_combo_box_text_append(combo, saved->name, saved->name);
+        if (view->filter == saved->result) {
+            active_id = saved->name;
+        }
+    }
+    if (active_id) {
+        gtk_combo_box_set_active_id(GTK_COMBO_BOX(combo), active_id);
+    } else {
+        gtk_combo_box_set_active(GTK_COMBO_BOX(combo), -1);
+    }
+    g_signal_handlers_unblock_by_func(combo, on_view_combo_changed, window);
+}
+
+/**
+ * @brief Refreshes the view switchers of every open window, after the set
+ * of saved views changed. Windows showing a view that is gone fall back
+ * to @replacement.
+ *
+ * @param app The application.
+ * @param removed A result that is about to be freed, or NULL.
+ * @param replacement What windows showing @removed show instead, or NULL.
+ */
+static void refresh_all_view_combos(GtkApplication *app, QueryResult *removed, QueryResult *replacement) {
+    for (GList *l = gtk_application_get_windows(app); l; l = l->next) {
+        TaskListView *view = g_object_get_data(G_OBJECT(l->data), "view");
+        if (!view) {
+            continue;
+        }
+        if (removed && view->filter == removed) {
+            task_list_view_set_filter(view, replacement, FALSE);
+            gtk_entry_set_text(GTK_ENTRY(g_object_get_data(G_OBJECT(l->data), "filter_entry")),
+                               replacement ? replacement->query->source : "");
+        }
+        refresh_view_combo(l->data);
+    }
+}
+
+/**
+ * @brief Callback for the view switcher's "changed" signal.
+ *
+ * @param combo The GtkComboBoxText.
+ * @param user_data A pointer to the main window.
+ */
+static void on_view_combo_changed(GtkComboBox *combo, gpointer user_data) {
+    TaskListView *view = g_object_get_data(G_OBJECT(user_data), "view");
+    GtkWidget *filter_entry = g_object_get_data(G_OBJECT(user_data), "filter_entry");
+    const gchar *id = gtk_combo_box_get_active_id(combo);
+    SavedView *saved;
+
+    if (!id) {
+        return;
+    }
+    saved = find_saved_view(get_saved_views(gtk_window_get_application(GTK_WINDOW(user_data))), id);
+    // The saved result is already current, so this is just a pointer swap.
+    task_list_view_set_filter(view, saved ? saved->result : NULL, FALSE);
+    gtk_entry_set_text(GTK_ENTRY(filter_entry), saved ? saved->result->query->source : "");
+}
+
+/**
+ * @brief Action handler for "win.save-view". Saves the ad hoc filter under
+ * a name; the view's result becomes the saved view's, so nothing is rerun.
+ */
+static void on_save_view_action(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    GtkWidget *window = user_data;
+    GtkApplication *app = gtk_window_get_application(GTK_WINDOW(window));
+    TaskListView *view = g_object_get_data(G_OBJECT(window), "view");
+    GPtrArray *views = get_saved_views(app);
+    GtkWidget *dialog;
+    GtkWidget *name_entry;
+
+    if (!view->filter || !view->owns_filter) {
+        gtk_widget_error_bell(window);
+        return;
+    }
+
+    dialog = gtk_dialog_new_with_buttons("Save View", GTK_WINDOW(window),
+                                         GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+                                         "_Cancel", GTK_RESPONSE_CANCEL, "_Save", GTK_RESPONSE_ACCEPT, NULL);
+    gtk_dialog_set_default_response(GTK_DIALOG(dialog), GTK_RESPONSE_ACCEPT);
+    name_entry = gtk_entry_new();
+    gtk_entry_set_placeholder_text(GTK_ENTRY(name_entry), "View name");
+    gtk_entry_set_activates_default(GTK_ENTRY(name_entry), TRUE);
+    gtk_container_add(GTK_CONTAINER(gtk_dialog_get_content_area(GTK_DIALOG(dialog))), name_entry);
+    gtk_widget_show_all(dialog);
+
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+        gchar *name = g_strstrip(g_strdup(gtk_entry_get_text(GTK_ENTRY(name_entry))));
+        // Names are stored one per line, before a tab.
+        g_strdelimit(name, "\t\n\r", ' ');
+        if (*name && view->filter && view->owns_filter) {
+            SavedView *saved = find_saved_view(views, name);
+            QueryResult *old = NULL;
+            if (!saved) {
+                saved = g_new0(SavedView, 1);
+                saved->name = g_strdup(name);
+                g_ptr_array_add(views, saved);
+            } else {
+                old = saved->result;
+            }
+            saved->result = view->filter;
+            view->owns_filter = FALSE;
+            refresh_all_view_combos(app, old, saved->result);
+            if (old) {
+                query_result_free(old);
+            }
+            save_saved_views(views, view->store);
+        }
+        g_free(name);
+    }
+    gtk_widget_destroy(dialog);
+}
+
+/**
+ * @brief Action handler for "win.delete-view". Deletes the saved view the
+ * window shows.
+ */
+static void on_delete_view_action(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    GtkWidget *window = user_data;
+    GtkApplication *app = gtk_window_get_application(GTK_WINDOW(window));
+    TaskListView *view = g_object_get_data(G_OBJECT(window), "view");
+    GPtrArray *views = get_saved_views(app);
+
+    for (guint i = 0; i < views->len; i++) {
+        SavedView *saved = g_ptr_array_index(views, i);
+        if (view->filter == saved->result) {
+            // Take the view out without freeing it until no window shows it.
+            g_ptr_array_set_free_func(views, NULL);
+            g_ptr_array_remove_index(views, i);
+            g_ptr_array_set_free_func(views, saved_view_free);
+            refresh_all_view_combos(app, saved->result, NULL);
+            saved_view_free(saved);
+            save_saved_views(views, view->store);
+            return;
+        }
+    }
+    gtk_widget_error_bell(window);
+}
+
+// --- Task Board ---
+
+/**
+ * @brief One column of the board: a virtualized list of the tasks in one
+ * status.
+ */
+typedef struct {
+    guint8 status;
+    TaskListView *view;
+    GtkWidget *label;            // The column heading, with its task count.
+    guint count;                 // The count the heading shows.
+} TaskBoardColumn;
+
+/**
+ * @brief A board with one column per status.
+ *
+ * Every column is a TaskListView over the shared store, filtered by a
+ * "status:NAME" query whose result is updated in place on each commit.
+ * Dropping a card on a column is a single task_store_set_status(), which
+ * costs each column one binary search however many cards it holds, and
+ * only the rows in view exist.
+ */
+typedef struct {
+    TaskStore *store;
+    GtkWidget *widget;           // The box holding the columns.
+    GArray *columns;             // TaskBoardColumn entries, in display order.
+} TaskBoard;
+
+/**
+ * @brief Updates the column headings whose task count changed.
+ */
+static void task_board_update_counts(TaskBoard *board) {
+    for (guint i = 0; i < board->columns->len; i++) {
+        TaskBoardColumn *column = &g_array_index(board->columns, TaskBoardColumn, i);
+        guint count = column->view->filter->positions->len;
+        if (count != column->count || !*gtk_label_get_text(GTK_LABEL(column->label))) {
+            gchar *heading = g_strdup_printf("%s (%u)",
+                                             (const gchar *)g_ptr_array_index(board->store->statuses, column->status),
+                                             count);
+            gtk_label_set_text(GTK_LABEL(column->label), heading);
+            g_free(heading);
+            column->count = count;
+        }
+    }
+}
+
+/**
+ * @brief Store listener for the board. Runs after the column results were
+ * updated.
+ */
+static void on_board_store_changed(TaskStore *store, guint position, guint removed, guint added, gpointer user_data) {
+    task_board_update_counts(user_data);
+}
+
+/**
+ * @brief Callback for a card dropped on a column.
+ *
+ * @param widget The column's layout.
+ * @param user_data A pointer to the TaskBoard.
+ */
+static void on_board_drag_data_received(GtkWidget *widget, GdkDragContext *context, gint x, gint y,
+                                        GtkSelectionData *selection_data, guint info, guint time,
+                                        gpointer user_data) {
+    TaskBoard *board = user_data;
+    guint status = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(widget), "status"));
+    gint length;
+    const guchar *data = gtk_selection_data_get_data_with_length(selection_data, &length);
+    gchar *text;
+    guint position;
+
+    if (!data || length <= 0) {
+        return;
+    }
+    text = g_strndup((const gchar *)data, length);
+    if (task_store_find(board->store, strtoul(text, NULL, 10), &position)) {
+        task_store_set_status(board->store, position, status);
+    }
+    g_free(text);
+}
+
+/**
+ * @brief Adds a column for one status.
+ */
+static void task_board_add_column(TaskBoard *board, guint8 status) {
+    const gchar *name = g_ptr_array_index(board->store->statuses, status);
+    GString *source = g_string_new("status:\"");
+    TaskBoardColumn column = { status, NULL, NULL, 0 };
+    GtkWidget *box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 10);
+
+    // Quote the name so spaces and operators in it are taken literally.
+    for (const gchar *p = name; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            g_string_append_c(source, '\\');
+        }
+        g_string_append_c(source, *p);
+    }
+    g_string_append_c(source, '"');
+
+    gtk_box_pack_start(GTK_BOX(board->widget), box, TRUE, TRUE, 0);
+    column.label = gtk_label_new(NULL);
+    gtk_label_set_xalign(GTK_LABEL(column.label), 0.0);
+    gtk_label_set_ellipsize(GTK_LABEL(column.label), PANGO_ELLIPSIZE_END);
+    gtk_style_context_add_class(gtk_widget_get_style_context(column.label), "board-column-title");
+    gtk_box_pack_start(GTK_BOX(box), column.label, FALSE, FALSE, 0);
+
+    column.view = task_list_view_new_full(board->store, box,
+                                          query_result_new(board->store, query_compile(source->str, NULL)), TRUE);
+    g_object_set_data(G_OBJECT(column.view->layout), "status", GUINT_TO_POINTER(status));
+    gtk_drag_dest_set(column.view->layout, GTK_DEST_DEFAULT_ALL, task_drag_targets, G_N_ELEMENTS(task_drag_targets),
+                      GDK_ACTION_MOVE);
+    g_signal_connect(column.view->layout, "drag-data-received", G_CALLBACK(on_board_drag_data_received), board);
+
+    g_array_append_val(board->columns, column);
+    g_string_free(source, TRUE);
+}
+
+/**
+ * @brief Builds one column per status: "To Do", "In Progress", the custom
+ * statuses and "Done" last.
+ */
+static void task_board_rebuild(TaskBoard *board) {
+    GList *children = gtk_container_get_children(GTK_CONTAINER(board->widget));
+
+    for (GList *l = children; l; l = l->next) {
+        gtk_widget_destroy(l->data);
+    }
+    g_list_free(children);
+    g_array_set_size(board->columns, 0);
+
+    task_board_add_column(board, TASK_STATUS_TODO);
+    task_board_add_column(board, TASK_STATUS_IN_PROGRESS);
+    for (guint status = TASK_STATUS_N_BUILTIN; status < board->store->statuses->len; status++) {
+        task_board_add_column(board, status);
+    }
+    task_board_add_column(board, TASK_STATUS_DONE);
+    gtk_widget_show_all(board->widget);
+    task_board_update_counts(board);
+}
+
+/**
+ * @brief Frees the board when its widget is destroyed. The column views
+ * free themselves.
+ */
+static void on_board_destroy(GtkWidget *widget, gpointer user_data) {
+    TaskBoard *board = user_data;
+
+    task_store_remove_listener(board->store, board);
+    g_array_free(board->columns, TRUE);
+    g_free(board);
+}
+
+/**
+ * @brief Creates a board over the store.
+ *
+ * @param store The task store to show.
+ * @param parent The GtkBox to pack the board into, for the same reason as
+ * in task_list_view_new_full().
+ * @return The new board. It is freed when its widget is destroyed.
+ */
+static TaskBoard *task_board_new(TaskStore *store, GtkWidget *parent) {
+    TaskBoard *board = g_new0(TaskBoard, 1);
+
+    board->store = store;
+    board->columns = g_array_new(FALSE, FALSE, sizeof(TaskBoardColumn));
+    board->widget = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 15);
+    gtk_box_set_homogeneous(GTK_BOX(board->widget), TRUE);
+    gtk_box_pack_start(GTK_BOX(parent), board->widget, TRUE, TRUE, 0);
+    g_signal_connect(board->widget, "destroy", G_CALLBACK(on_board_destroy), board);
+
+    task_board_rebuild(board);
+    task_store_add_listener(store, on_board_store_changed, board);
+    return board;
+}
+
+/**
+ * @brief Returns the current positions of the cards selected in any column
+ * and clears the selections.
+ *
+ * @param board The board.
+ * @param n_positions Return location for the number of positions.
+ * @return A newly allocated array of positions.
+ */
+static guint *task_board_take_selected_positions(TaskBoard *board, guint *n_positions) {
+    GArray *positions = g_array_new(FALSE, FALSE, sizeof(guint));
+
+    for (guint i = 0; i < board->columns->len; i++) {
+        TaskListView *view = g_array_index(board->columns, TaskBoardColumn, i).view;
+        guint n;
+        guint *selected;
+
+        if (g_hash_table_size(view->selected) == 0) {
+            continue;
+        }
+        selected = task_list_view_get_selected_positions(view, &n);
+        g_array_append_vals(positions, selected, n);
+        g_hash_table_remove_all(view->selected);
+        g_free(selected);
+    }
+    *n_positions = positions->len;
+    return (guint *)g_array_free(positions, FALSE);
+}
+
+/**
+ * @brief Action handler for "win.add-status". Adds a custom status, which
+ * every open board shows as a new column before "Done".
+ */
+static void on_add_status_action(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    GtkWidget *window = user_data;
+    GtkApplication *app = gtk_window_get_application(GTK_WINDOW(window));
+    TaskStore *store = g_object_get_data(G_OBJECT(window), "store");
+    GtkWidget *dialog;
+    GtkWidget *name_entry;
+
+    dialog = gtk_dialog_new_with_buttons("Add Column", GTK_WINDOW(window),
+                                         GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+                                         "_Cancel", GTK_RESPONSE_CANCEL, "_Add", GTK_RESPONSE_ACCEPT, NULL);
+    gtk_dialog_set_default_response(GTK_DIALOG(dialog), GTK_RESPONSE_ACCEPT);
+    name_entry = gtk_entry_new();
+    gtk_entry_set_placeholder_text(GTK_ENTRY(name_entry), "Status name, e.g. Review");
+    gtk_entry_set_activates_default(GTK_ENTRY(name_entry), TRUE);
+    gtk_container_add(GTK_CONTAINER(gtk_dialog_get_content_area(GTK_DIALOG(dialog))), name_entry);
+    gtk_widget_show_all(dialog);
+
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+        gchar *name = g_strstrip(g_strdup(gtk_entry_get_text(GTK_ENTRY(name_entry))));
+        // Names are stored one per line.
+        g_strdelimit(name, "\n\r", ' ');
+        if (!*name || task_store_add_status(store, name) < 0) {
+            gtk_widget_error_bell(window);
+        } else {
+            for (GList *l = gtk_application_get_windows(app); l; l = l->next) {
+                TaskBoard *board = g_object_get_data(G_OBJECT(l->data), "board");
+                if (board) {
+                    task_board_rebuild(board);
+                }
+            }
+        }
+        g_free(name);
+    }
+    gtk_widget_destroy(dialog);
+}
+
+// --- Timeline ---
+
+// Side of a cached tile, in pixels.
+#define TIMELINE_TILE_SIZE 256
+// Tiles kept per timeline; the least recently drawn are dropped first.
+#define TIMELINE_MAX_TILES 128
+// Height of one lane, in pixels.
+#define TIMELINE_LANE_HEIGHT 28
+// Height of the date axis along the top.
+#define TIMELINE_AXIS_HEIGHT 32
+// Zoom levels: a day is 2^zoom pixels wide.
+#define TIMELINE_MIN_ZOOM -3
+#define TIMELINE_MAX_ZOOM 6
+#define TIMELINE_DEFAULT_ZOOM 3
+
+/**
+ * @brief A rendered square of the timeline at one zoom level.
+ */
+typedef struct {
+    gint64 key;              // See timeline_tile_key().
+    gint zoom;
+    gint64 column;           // Tile position along the days, in tiles.
+    gint64 row;              // Tile position along the lanes, in tiles.
+    cairo_surface_t *surface;
+    guint64 last_used;
+} TimelineTile;
+
+/**
+ * @brief A zoomable, pannable chart of the task spans, one bar per span.
+ *
+ * The chart is drawn from tiles that are rendered once per zoom level and
+ * then only copied, so panning costs one blit per visible tile. When a
+ * commit changes spans, only the cached tiles under their old and new bars
+ * are dropped.
+ */
+typedef struct {
+    SpanIndex *index;
+    GtkWidget *area;
+    gint zoom;
+    gdouble x;               // Left edge of the view, in pixels at the current zoom.
+    gdouble y;               // Top edge of the lanes in view, in pixels.
+    GHashTable *tiles;       // Tile key -> TimelineTile.
+    guint64 clock;           // Counts draws, for picking tiles to drop.
+    GPtrArray *query;        // Reused for span queries.
+    gboolean dragging;
+    gdouble drag_x;          // Pointer position of the last motion while dragging.
+    gdouble drag_y;
+} TimelineView;
+
+static gdouble timeline_day_width(gint zoom) {
+    return ldexp(1.0, zoom);
+}
+
+static gint64 timeline_tile_key(gint zoom, gint64 column, gint64 row) {
+    return ((gint64)(zoom - TIMELINE_MIN_ZOOM) << 56) | ((row & 0xFFFFFF) << 32) | (column & 0xFFFFFFFF);
+}
+
+static void timeline_tile_free(gpointer data) {
+    TimelineTile *tile = data;
+    cairo_surface_destroy(tile->surface);
+    g_free(tile);
+}
+
+/**
+ * @brief Sets the colour of a bar for its task.
+ */
+static void timeline_set_bar_color(cairo_t *cr, const Task *task) {
+    if (task->is_completed) {
+        cairo_set_source_rgb(cr, 0.61, 0.64, 0.69);
+    } else if (task->status == TASK_STATUS_IN_PROGRESS) {
+        cairo_set_source_rgb(cr, 0.96, 0.62, 0.04);
+    } else {
+        cairo_set_source_rgb(cr, 0.23, 0.51, 0.96);
+    }
+}
+
+/**
+ * @brief Renders one tile: the parts of every bar that fall inside it.
+ */
+static TimelineTile *timeline_render_tile(TimelineView *view, gint zoom, gint64 column, gint64 row) {
+    TimelineTile *tile = g_new0(TimelineTile, 1);
+    gdouble day_width = timeline_day_width(zoom);
+    gdouble left = (gdouble)column * TIMELINE_TILE_SIZE;
+    gdouble top = (gdouble)row * TIMELINE_TILE_SIZE;
+    guint first_lane = top / TIMELINE_LANE_HEIGHT;
+    guint last_lane = (top + TIMELINE_TILE_SIZE - 1) / TIMELINE_LANE_HEIGHT;
+    PangoLayout *layout;
+    cairo_t *cr;
+
+    tile->zoom = zoom;
+    tile->column = column;
+    tile->row = row;
+    tile->key = timeline_tile_key(zoom, column, row);
+    tile->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, TIMELINE_TILE_SIZE, TIMELINE_TILE_SIZE);
+    cr = cairo_create(tile->surface);
+    cairo_translate(cr, -left, -top);
+    layout = gtk_widget_create_pango_layout(view->area, NULL);
+    pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_END);
+
+    span_index_query(view->index, floor(left / day_width), ceil((left + TIMELINE_TILE_SIZE) / day_width) + 1,
+                     view->query);
+    for (guint i = 0; i < view->query->len; i++) {
+        TaskSpan *span = g_ptr_array_index(view->query, i);
+        gdouble x, width, y;
+
+        if (span->lane < first_lane || span->lane > last_lane) {
+            continue;
+        }
+        x = span->begin * day_width;
+        width = MAX((span->end - span->begin) * day_width - 1, 2.0);
+        y = (gdouble)span->lane * TIMELINE_LANE_HEIGHT + 3;
+        timeline_set_bar_color(cr, span->task);
+        cairo_rectangle(cr, x, y, width, TIMELINE_LANE_HEIGHT - 6);
+        cairo_fill(cr);
+
+        if (width > 24) {
+            // Every tile a label crosses draws all of it at the same place,
+            // clipped to the tile, so labels join up across tiles.
+            gint text_height;
+            cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+            pango_layout_set_text(layout, span->task->text, -1);
+            pango_layout_set_width(layout, (width - 8) * PANGO_SCALE);
+            pango_layout_get_pixel_size(layout, NULL, &text_height);
+            cairo_move_to(cr, x + 4, y + (TIMELINE_LANE_HEIGHT - 6 - text_height) / 2.0);
+            pango_cairo_show_layout(cr, layout);
+        }
+    }
+
+    g_object_unref(layout);
+    cairo_destroy(cr);
+    return tile;
+}
+
+/**
+ * @brief Returns a tile from the cache, rendering it if needed.
+ */
+static TimelineTile *timeline_get_tile(TimelineView *view, gint64 column, gint64 row) {
+    gint64 key = timeline_tile_key(view->zoom, column, row);
+    TimelineTile *tile = g_hash_table_lookup(view->tiles, &key);
+
+    if (!tile) {
+        tile = timeline_render_tile(view, view->zoom, column, row);
+        g_hash_table_insert(view->tiles, &tile->key, tile);
+    }
+    tile->last_used = view->clock;
+    return tile;
+}
+
+/**
+ * @brief Drops the least recently drawn tiles beyond TIMELINE_MAX_TILES.
+ * Tiles drawn this frame are never dropped.
+ */
+static void timeline_trim_tiles(TimelineView *view) {
+    while (g_hash_table_size(view->tiles) > TIMELINE_MAX_TILES) {
+        GHashTableIter iter;
+        gpointer value;
+        TimelineTile *oldest = NULL;
+
+        g_hash_table_iter_init(&iter, view->tiles);
+        while (g_hash_table_iter_next(&iter, NULL, &value)) {
+            TimelineTile *tile = value;
+            if (!oldest || tile->last_used < oldest->last_used) {
+                oldest = tile;
+            }
+        }
+        if (oldest->last_used == view->clock) {
+            return;
+        }
+        g_hash_table_remove(view->tiles, &oldest->key);
+    }
+}
+
+/**
+ * @brief Draws the date axis: a tick and label per month, or per year
+ * when months would be too narrow to label.
+ */
+static void timeline_draw_axis(TimelineView *view, cairo_t *cr, gint width) {
+    gdouble day_width = timeline_day_width(view->zoom);
+    gboolean years = day_width * 30 < 64;
+    gint32 first_day = floor(view->x / day_width);
+    gint32 last_day = ceil((view->x + width) / day_width);
+    PangoLayout *layout = gtk_widget_create_pango_layout(view->area, NULL);
+    GDate date;
+
+    cairo_set_source_rgb(cr, 0.88, 0.90, 0.93);
+    cairo_rectangle(cr, 0, 0, width, TIMELINE_AXIS_HEIGHT);
+    cairo_fill(cr);
+
+    g_date_clear(&date, 1);
+    g_date_set_julian(&date, MAX(first_day, 1));
+    g_date_set_day(&date, 1);
+    if (years) {
+        g_date_set_month(&date, G_DATE_JANUARY);
+    }
+    while ((gint32)g_date_get_julian(&date) <= last_day) {
+        gdouble x = floor(g_date_get_julian(&date) * day_width - view->x) + 0.5;
+        gchar label[32];
+
+        g_date_strftime(label, sizeof(label), years ? "%Y" : "%b %Y", &date);
+        cairo_set_source_rgb(cr, 0.82, 0.84, 0.86);
+        cairo_move_to(cr, x, TIMELINE_AXIS_HEIGHT);
+        cairo_line_to(cr, x, gtk_widget_get_allocated_height(view->area));
+        cairo_stroke(cr);
+        cairo_set_source_rgb(cr, 0.29, 0.33, 0.39);
+        pango_layout_set_text(layout, label, -1);
+        cairo_move_to(cr, x + 4, 6);
+        pango_cairo_show_layout(cr, layout);
+
+        if (years) {
+            g_date_add_years(&date, 1);
+        } else {
+            g_date_add_months(&date, 1);
+        }
+    }
+    g_object_unref(layout);
+}
+
+/**
+ * @brief Callback for the drawing area's "draw" signal.
+ */
+static gboolean on_timeline_draw(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
+    TimelineView *view = user_data;
+    gint width = gtk_widget_get_allocated_width(widget);
+    gint height = gtk_widget_get_allocated_height(widget);
+    gdouble day_width = timeline_day_width(view->zoom);
+    gint64 first_column = floor(view->x / TIMELINE_TILE_SIZE);
+    gint64 last_column = floor((view->x + width - 1) / TIMELINE_TILE_SIZE);
+    gint64 first_row = floor(view->y / TIMELINE_TILE_SIZE);
+    gint64 last_row = floor((view->y + height - TIMELINE_AXIS_HEIGHT - 1) / TIMELINE_TILE_SIZE);
+    gdouble today = query_today() * day_width - view->x;
+
+    view->clock++;
+    cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+    cairo_paint(cr);
+    timeline_draw_axis(view, cr, width);
+
+    cairo_save(cr);
+    cairo_rectangle(cr, 0, TIMELINE_AXIS_HEIGHT, width, height - TIMELINE_AXIS_HEIGHT);
+    cairo_clip(cr);
+    for (gint64 row = first_row; row <= last_row; row++) {
+        for (gint64 column = first_column; column <= last_column; column++) {
+            TimelineTile *tile = timeline_get_tile(view, column, row);
+            // Tiles sit on whole pixels, so copying them never resamples.
+            cairo_set_source_surface(cr, tile->surface, column * TIMELINE_TILE_SIZE - floor(view->x),
+                                     TIMELINE_AXIS_HEIGHT + row * TIMELINE_TILE_SIZE - floor(view->y));
+            cairo_paint(cr);
+        }
+    }
+    cairo_set_source_rgb(cr, 0.94, 0.27, 0.27);
+    cairo_move_to(cr, floor(today) + 0.5, TIMELINE_AXIS_HEIGHT);
+    cairo_line_to(cr, floor(today) + 0.5, height);
+    cairo_stroke(cr);
+    cairo_restore(cr);
+
+    timeline_trim_tiles(view);
+    return GDK_EVENT_STOP;
+}
+
+/**
+ * @brief Moves the view, keeping the lanes inside the chart.
+ */
+static void timeline_scroll_to(TimelineView *view, gdouble x, gdouble y) {
+    gint height = gtk_widget_get_allocated_height(view->area) - TIMELINE_AXIS_HEIGHT;
+    gdouble max_y = MAX((gdouble)span_index_get_n_lanes(view->index) * TIMELINE_LANE_HEIGHT - height, 0.0);
+
+    view->x = x;
+    view->y = CLAMP(y, 0.0, max_y);
+    gtk_widget_queue_draw(view->area);
+}
+
+/**
+ * @brief Switches to another zoom level, keeping the day under @anchor_x
+ * where it is.
+ */
+static void timeline_set_zoom(TimelineView *view, gint zoom, gdouble anchor_x) {
+    zoom = CLAMP(zoom, TIMELINE_MIN_ZOOM, TIMELINE_MAX_ZOOM);
+    if (zoom == view->zoom) {
+        return;
+    }
+    gdouble day = (view->x + anchor_x) / timeline_day_width(view->zoom);
+    view->zoom = zoom;
+    timeline_scroll_to(view, day * timeline_day_width(zoom) - anchor_x, view->y);
+}
+
+/**
+ * @brief Callback for "scroll-event": the wheel pans the lanes, Shift+wheel
+ * pans the days and Ctrl+wheel zooms around the pointer.
+ */
+static gboolean on_timeline_scroll(GtkWidget *widget, GdkEventScroll *event, gpointer user_data) {
+    TimelineView *view = user_data;
+    gdouble delta_x = 0, delta_y = 0;
+
+    if (!gdk_event_get_scroll_deltas((GdkEvent *)event, &delta_x, &delta_y)) {
+        if (event->direction == GDK_SCROLL_UP || event->direction == GDK_SCROLL_DOWN) {
+            delta_y = event->direction == GDK_SCROLL_UP ? -1 : 1;
+        } else if (event->direction == GDK_SCROLL_LEFT || event->direction == GDK_SCROLL_RIGHT) {
+            delta_x = event->direction == GDK_SCROLL_LEFT ? -1 : 1;
+        } else {
+            return GDK_EVENT_PROPAGATE;
+        }
+    }
+    if (event->state & GDK_CONTROL_MASK) {
+        if (delta_y != 0) {
+            timeline_set_zoom(view, view->zoom + (delta_y < 0 ? 1 : -1), event->x);
+        }
+    } else if (event->state & GDK_SHIFT_MASK) {
+        timeline_scroll_to(view, view->x + (delta_x + delta_y) * TIMELINE_TILE_SIZE / 4, view->y);
+    } else {
+        timeline_scroll_to(view, view->x + delta_x * TIMELINE_TILE_SIZE / 4,
+                           view->y + delta_y * TIMELINE_LANE_HEIGHT * 3);
+    }
+    return GDK_EVENT_STOP;
+}
+
+/**
+ * @brief Callback for "button-press-event": dragging with the first button
+ * pans the chart.
+ */
+static gboolean on_timeline_button_press(GtkWidget *widget, GdkEventButton *event, gpointer user_data) {
+    TimelineView *view = user_data;
+
+    if (event->button != 1 || event->type != GDK_BUTTON_PRESS) {
+        return GDK_EVENT_PROPAGATE;
+    }
+    view->dragging = TRUE;
+    view->drag_x = event->x;
+    view->drag_y = event->y;
+    return GDK_EVENT_STOP;
+}
+
+static gboolean on_timeline_button_release(GtkWidget *widget, GdkEventButton *event, gpointer user_data) {
+    ((TimelineView *)user_data)->dragging = FALSE;
+    return GDK_EVENT_PROPAGATE;
+}
+
+static gboolean on_timeline_motion(GtkWidget *widget, GdkEventMotion *event, gpointer user_data) {
+    TimelineView *view = user_data;
+
+    if (!view->dragging) {
+        return GDK_EVENT_PROPAGATE;
+    }
+    timeline_scroll_to(view, view->x - (event->x - view->drag_x), view->y - (event->y - view->drag_y));
+    view->drag_x = event->x;
+    view->drag_y = event->y;
+    return GDK_EVENT_STOP;
+}
+
+/**
+ * @brief Callback for "query-tooltip": names the task under the pointer
+ * and its dates.
+ */
+static gboolean on_timeline_query_tooltip(GtkWidget *widget, gint x, gint y, gboolean keyboard_mode,
+                                          GtkTooltip *tooltip, gpointer user_data) {
+    TimelineView *view = user_data;
+    gint32 day;
+    guint lane;
+
+    if (keyboard_mode || y < TIMELINE_AXIS_HEIGHT) {
+        return FALSE;
+    }
+    day = floor((view->x + x) / timeline_day_width(view->zoom));
+    lane = (view->y + y - TIMELINE_AXIS_HEIGHT) / TIMELINE_LANE_HEIGHT;
+    span_index_query(view->index, day, day + 1, view->query);
+    for (guint i = 0; i < view->query->len; i++) {
+        TaskSpan *span = g_ptr_array_index(view->query, i);
+        if (span->lane == lane) {
+            GDate first, last;
+            gchar first_text[32], last_text[32];
+            gchar *text;
+            g_date_clear(&first, 1);
+            g_date_clear(&last, 1);
+            g_date_set_julian(&first, span->begin);
+            g_date_set_julian(&last, span->end - 1);
+            g_date_strftime(first_text, sizeof(first_text), "%Y-%m-%d", &first);
+            g_date_strftime(last_text, sizeof(last_text), "%Y-%m-%d", &last);
+            text = g_strdup_printf("%s\n%s – %s", span->task->text, first_text, last_text);
+            gtk_tooltip_set_text(tooltip, text);
+            g_free(text);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/**
+ * @brief Whether a cached tile shows any part of a span's bar.
+ */
+static gboolean timeline_tile_intersects(const TimelineTile *tile, const SpanRect *rect) {
+    gdouble day_width = timeline_day_width(tile->zoom);
+    gdouble left = (gdouble)tile->column * TIMELINE_TILE_SIZE;
+    gdouble top = (gdouble)tile->row * TIMELINE_TILE_SIZE;
+    gdouble bar_top = (gdouble)rect->lane * TIMELINE_LANE_HEIGHT;
+
+    // Labels never reach past their bar, and bars are at least 2 pixels wide.
+    return rect->begin * day_width < left + TIMELINE_TILE_SIZE &&
+           MAX(rect->end * day_width, rect->begin * day_width + 2) > left &&
+           bar_top < top + TIMELINE_TILE_SIZE && bar_top + TIMELINE_LANE_HEIGHT > top;
+}
+
+/**
+ * @brief Store listener for the timeline. Runs after the span index has
+ * recorded which bars the commit changed, and drops the tiles under them.
+ */
+static void on_timeline_store_changed(TaskStore *store, guint position, guint removed, guint added,
+                                      gpointer user_data) {
+    TimelineView *view = user_data;
+    GArray *dirty = view->index->dirty;
+    GHashTableIter iter;
+    gpointer value;
+
+    if (dirty->len == 0 && !view->index->repacked) {
+        return;
+    }
+    if (view->index->repacked || dirty->len > TIMELINE_MAX_TILES * 4) {
+        // Cheaper to start over than to test every tile against every bar.
+        g_hash_table_remove_all(view->tiles);
+    } else {
+        g_hash_table_iter_init(&iter, view->tiles);
+        while (g_hash_table_iter_next(&iter, NULL, &value)) {
+            for (guint i = 0; i < dirty->len; i++) {
+                if (timeline_tile_intersects(value, &g_array_index(dirty, SpanRect, i))) {
+                    g_hash_table_iter_remove(&iter);
+                    break;
+                }
+            }
+        }
+    }
+    gtk_widget_queue_draw(view->area);
+}
+
+/**
+ * @brief Frees the timeline when its drawing area is destroyed.
+ */
+static void on_timeline_destroy(GtkWidget *widget, gpointer user_data) {
+    TimelineView *view = user_data;
+
+    task_store_remove_listener(view->index->store, view);
+    g_hash_table_unref(view->tiles);
+    g_ptr_array_free(view->query, TRUE);
+    g_free(view);
+}
+
+/**
+ * @brief Creates a timeline of the spans in an index, starting a week
+ * before today.
+ *
+ * @param index The span index, shared by all windows.
+ * @return The new timeline. It is freed when its drawing area is destroyed.
+ */
+static TimelineView *timeline_view_new(SpanIndex *index) {
+    TimelineView *view = g_new0(TimelineView, 1);
+
+    view->index = index;
+    view->zoom = TIMELINE_DEFAULT_ZOOM;
+    view->x = (query_today() - 7) * timeline_day_width(view->zoom);
+    view->tiles = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL, timeline_tile_free);
+    view->query = g_ptr_array_new();
+
+    view->area = gtk_drawing_area_new();
+    gtk_widget_add_events(view->area, GDK_SCROLL_MASK | GDK_SMOOTH_SCROLL_MASK | GDK_BUTTON_PRESS_MASK |
+                                          GDK_BUTTON_RELEASE_MASK | GDK_BUTTON1_MOTION_MASK);
+    gtk_widget_set_has_tooltip(view->area, TRUE);
+    g_signal_connect(view->area, "draw", G_CALLBACK(on_timeline_draw), view);
+    g_signal_connect(view->area, "scroll-event", G_CALLBACK(on_timeline_scroll), view);
+    g_signal_connect(view->area, "button-press-event", G_CALLBACK(on_timeline_button_press), view);
+    g_signal_connect(view->area, "button-release-event", G_CALLBACK(on_timeline_button_release), view);
+    g_signal_connect(view->area, "motion-notify-event", G_CALLBACK(on_timeline_motion), view);
+    g_signal_connect(view->area, "query-tooltip", G_CALLBACK(on_timeline_query_tooltip), view);
+    g_signal_connect(view->area, "destroy", G_CALLBACK(on_timeline_destroy), view);
+
+    task_store_add_listener(index->store, on_timeline_store_changed, view);
+    return view;
+}
+
+// --- Calendar ---
+
+// Height of the row of weekday names.
+#define CALENDAR_HEADER_HEIGHT 24
+// Height of the day number at the top of each cell.
+#define CALENDAR_DAY_HEIGHT 22
+// Height of one bar, and the gap below it.
+#define CALENDAR_BAR_HEIGHT 18
+#define CALENDAR_BAR_GAP 2
+
+/**
+ * @brief Where a bar, or a "+N more" label, was last drawn, for tooltips.
+ */
+typedef struct {
+    gdouble x, y, width, height;
+    TaskSpan *span;          // NULL for a "+N more" label.
+    gint32 day;              // The day of a "+N more" label.
+} CalendarBar;
+
+/**
+ * @brief A month or week calendar of the task spans.
+ *
+ * Each week row asks the span index for the spans overlapping its seven
+ * days and stacks them in slots of its own, so drawing a month costs six
+ * interval queries no matter how many tasks the store holds.
+ */
+typedef struct {
+    SpanIndex *index;
+    GtkWidget *widget;       // The page: toolbar and drawing area.
+    GtkWidget *area;
+    GtkWidget *title;
+    gboolean week_mode;
+    gint32 anchor;           // A day in view: the 1st of the month in month mode.
+    GPtrArray *query;        // Reused for span queries.
+    GArray *slot_ends;       // gint32 per slot: the day after its last bar, for the week being drawn.
+    GArray *bars;            // CalendarBars of the last draw.
+} CalendarView;
+
+/**
+ * @brief Returns the Monday on or before a day.
+ */
+static gint32 calendar_week_start(gint32 day) {
+    GDate date;
+
+    g_date_clear(&date, 1);
+    g_date_set_julian(&date, day);
+    return day - (g_date_get_weekday(&date) - G_DATE_MONDAY);
+}
+
+/**
+ * @brief Works out the days in view.
+ *
+ * @param first Receives the first day drawn, a Monday.
+ * @return The number of week rows.
+ */
+static guint calendar_get_range(CalendarView *view, gint32 *first) {
+    GDate date;
+
+    *first = calendar_week_start(view->anchor);
+    if (view->week_mode) {
+        return 1;
+    }
+    g_date_clear(&date, 1);
+    g_date_set_julian(&date, view->anchor);
+    return (view->anchor - *first + g_date_get_days_in_month(g_date_get_month(&date), g_date_get_year(&date)) + 6) / 7;
+}
+
+static void calendar_update_title(CalendarView *view) {
+    GDate date;
+    gchar text[64];
+
+    g_date_clear(&date, 1);
+    g_date_set_julian(&date, view->anchor);
+    if (view->week_mode) {
+        gchar last[32];
+        g_date_set_julian(&date, calendar_week_start(view->anchor) + 6);
+        g_date_strftime(last, sizeof(last), "%b %d, %Y", &date);
+        g_date_subtract_days(&date, 6);
+        g_date_strftime(text, sizeof(text), "%b %d", &date);
+        g_strlcat(text, " – ", sizeof(text));
+        g_strlcat(text, last, sizeof(text));
+    } else {
+        g_date_strftime(text, sizeof(text), "%B %Y", &date);
+    }
+    gtk_label_set_text(GTK_LABEL(view->title), text);
+}
+
+/**
+ * @brief Moves the view to the month or week containing a day.
+ */
+static void calendar_show_day(CalendarView *view, gint32 day) {
+    if (view->week_mode) {
+        view->anchor = day;
+    } else {
+        GDate date;
+        g_date_clear(&date, 1);
+        g_date_set_julian(&date, day);
+        g_date_set_day(&date, 1);
+        view->anchor = g_date_get_julian(&date);
+    }
+    calendar_update_title(view);
+    gtk_widget_queue_draw(view->area);
+}
+
+/**
+ * @brief Moves the view a number of months, or weeks in week mode.
+ */
+static void calendar_step(CalendarView *view, gint steps) {
+    GDate date;
+
+    if (view->week_mode) {
+        calendar_show_day(view, view->anchor + steps * 7);
+        return;
+    }
+    g_date_clear(&date, 1);
+    g_date_set_julian(&date, view->anchor);
+    if (steps < 0) {
+        g_date_subtract_months(&date, -steps);
+    } else {
+        g_date_add_months(&date, steps);
+    }
+    calendar_show_day(view, g_date_get_julian(&date));
+}
+
+/**
+ * @brief Draws the bars of one week row.
+ *
+ * Spans come from the index in order of their first day, so giving each
+ * the lowest slot free on its first day in the week packs them into as few
+ * slots as possible. When they need more slots than fit, the last slot
+ * shows how many bars each day is missing instead.
+ */
+static void calendar_draw_week(CalendarView *view, cairo_t *cr, PangoLayout *layout, gint32 week, gdouble top,
+                               gdouble cell_width, gdouble row_height) {
+    guint max_slots = MAX((row_height - CALENDAR_DAY_HEIGHT) / (CALENDAR_BAR_HEIGHT + CALENDAR_BAR_GAP), 1.0);
+    guint hidden[7] = {0};
+    gboolean overflow = FALSE;
+
+    span_index_query(view->index, week, week + 7, view->query);
+    // A first pass finds out whether a slot has to be given up for counts.
+    for (guint pass = 0; pass < 2; pass++) {
+        guint n_slots = overflow ? max_slots - 1 : max_slots;
+
+        g_array_set_size(view->slot_ends, 0);
+        for (guint i = 0; i < view->query->len; i++) {
+            TaskSpan *span = g_ptr_array_index(view->query, i);
+            gint32 begin = MAX(span->begin, week);
+            gint32 end = MIN(span->end, week + 7);
+            guint slot = 0;
+
+            while (slot < view->slot_ends->len && g_array_index(view->slot_ends, gint32, slot) > begin) {
+                slot++;
+            }
+            if (slot >= n_slots) {
+                overflow = TRUE;
+                if (pass == 1) {
+                    for (gint32 day = begin; day < end; day++) {
+                        hidden[day - week]++;
+                    }
+                }
+                continue;
+            }
+            if (slot == view->slot_ends->len) {
+                g_array_append_val(view->slot_ends, end);
+            } else {
+                g_array_index(view->slot_ends, gint32, slot) = end;
+            }
+            if (pass == 1) {
+                CalendarBar bar = {
+                    .x = (begin - week) * cell_width + 2,
+                    .y = top + CALENDAR_DAY_HEIGHT + slot * (CALENDAR_BAR_HEIGHT + CALENDAR_BAR_GAP),
+                    .width = (end - begin) * cell_width - 4,
+                    .height = CALENDAR_BAR_HEIGHT,
+                    .span = span,
+                };
+                timeline_set_bar_color(cr, span->task);
+                cairo_rectangle(cr, bar.x, bar.y, bar.width, bar.height);
+                cairo_fill(cr);
+                cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+                pango_layout_set_width(layout, MAX(bar.width - 8, 1) * PANGO_SCALE);
+                pango_layout_set_text(layout, span->task->text, -1);
+                cairo_move_to(cr, bar.x + 4, bar.y + 1);
+                pango_cairo_show_layout(cr, layout);
+                g_array_append_val(view->bars, bar);
+            }
+        }
+    }
+
+    cairo_set_source_rgb(cr, 0.29, 0.33, 0.39);
+    pango_layout_set_width(layout, MAX(cell_width - 8, 1) * PANGO_SCALE);
+    for (guint i = 0; i < 7; i++) {
+        CalendarBar bar = {
+            .x = i * cell_width + 2,
+            .y = top + CALENDAR_DAY_HEIGHT + (max_slots - 1) * (CALENDAR_BAR_HEIGHT + CALENDAR_BAR_GAP),
+            .width = cell_width - 4,
+            .height = CALENDAR_BAR_HEIGHT,
+            .day = week + i,
+        };
+        gchar text[32];
+
+        if (!hidden[i]) {
+            continue;
+        }
+        g_snprintf(text, sizeof(text), "+%u more", hidden[i]);
+        pango_layout_set_text(layout, text, -1);
+        cairo_move_to(cr, bar.x + 4, bar.y + 1);
+        pango_cairo_show_layout(cr, layout);
+        g_array_append_val(view->bars, bar);
+    }
+}
+
+/**
+ * @brief Callback for the drawing area's "draw" signal.
+ */
+static gboolean on_calendar_draw(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
+    CalendarView *view = user_data;
+    gint width = gtk_widget_get_allocated_width(widget);
+    gint height = gtk_widget_get_allocated_height(widget);
+    gint32 today = query_today();
+    gint32 first;
+    guint n_weeks = calendar_get_range(view, &first);
+    gdouble cell_width = width / 7.0;
+    gdouble row_height = (gdouble)(height - CALENDAR_HEADER_HEIGHT) / n_weeks;
+    PangoLayout *layout = gtk_widget_create_pango_layout(widget, NULL);
+    GDate date;
+
+    g_array_set_size(view->bars, 0);
+    cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+    cairo_paint(cr);
+    pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_END);
+    g_date_clear(&date, 1);
+
+    for (guint i = 0; i < 7; i++) {
+        gchar text[32];
+        g_date_set_julian(&date, first + i);
+        g_date_strftime(text, sizeof(text), "%a", &date);
+        cairo_set_source_rgb(cr, 0.29, 0.33, 0.39);
+        pango_layout_set_width(layout, MAX(cell_width - 8, 1) * PANGO_SCALE);
+        pango_layout_set_text(layout, text, -1);
+        cairo_move_to(cr, i * cell_width + 6, 4);
+        pango_cairo_show_layout(cr, layout);
+    }
+
+    for (guint week = 0; week < n_weeks; week++) {
+        gdouble top = CALENDAR_HEADER_HEIGHT + week * row_height;
+
+        for (guint i = 0; i < 7; i++) {
+            gint32 day = first + week * 7 + i;
+            gchar text[8];
+
+            g_date_set_julian(&date, day);
+            if (day == today) {
+                cairo_set_source_rgb(cr, 0.86, 0.92, 1.0);
+                cairo_rectangle(cr, i * cell_width, top, cell_width, row_height);
+                cairo_fill(cr);
+            }
+            // Days of the neighbouring months are dimmed.
+            if (!view->week_mode && g_date_get_day(&date) != day - view->anchor + 1) {
+                cairo_set_source_rgb(cr, 0.61, 0.64, 0.69);
+            } else {
+                cairo_set_source_rgb(cr, 0.12, 0.16, 0.22);
+            }
+            g_snprintf(text, sizeof(text), "%u", g_date_get_day(&date));
+            pango_layout_set_text(layout, text, -1);
+            cairo_move_to(cr, i * cell_width + 6, top + 2);
+            pango_cairo_show_layout(cr, layout);
+        }
+        calendar_draw_week(view, cr, layout, first + week * 7, top, cell_width, row_height);
+    }
+
+    cairo_set_source_rgb(cr, 0.82, 0.84, 0.86);
+    cairo_set_line_width(cr, 1);
+    for (guint week = 0; week <= n_weeks; week++) {
+        gdouble y = floor(CALENDAR_HEADER_HEIGHT + week * row_height) + 0.5;
+        cairo_move_to(cr, 0, y);
+        cairo_line_to(cr, width, y);
+    }
+    for (guint i = 1; i < 7; i++) {
+        gdouble x = floor(i * cell_width) + 0.5;
+        cairo_move_to(cr, x, CALENDAR_HEADER_HEIGHT);
+        cairo_line_to(cr, x, height);
+    }
+    cairo_stroke(cr);
+
+    g_object_unref(layout);
+    return GDK_EVENT_STOP;
+}
+
+/**
+ * @brief Callback for "query-tooltip": names the task under the pointer and
+ * its dates, or lists the tasks behind a "+N more" label.
+ */
+static gboolean on_calendar_query_tooltip(GtkWidget *widget, gint x, gint y, gboolean keyboard_mode,
+                                          GtkTooltip *tooltip, gpointer user_data) {
+    CalendarView *view = user_data;
+
+    if (keyboard_mode) {
+        return FALSE;
+    }
+    for (guint i = 0; i < view->bars->len; i++) {
+        CalendarBar *bar = &g_array_index(view->bars, CalendarBar, i);
+        GString *text;
+
+        if (x < bar->x || x >= bar->x + bar->width || y < bar->y || y >= bar->y + bar->height) {
+            continue;
+        }
+        text = g_string_new(NULL);
+        if (bar->span) {
+            GDate first, last;
+            gchar first_text[32], last_text[32];
+            g_date_clear(&first, 1);
+            g_date_clear(&last, 1);
+            g_date_set_julian(&first, bar->span->begin);
+            g_date_set_julian(&last, bar->span->end - 1);
+            g_date_strftime(first_text, sizeof(first_text), "%Y-%m-%d", &first);
+            g_date_strftime(last_text, sizeof(last_text), "%Y-%m-%d", &last);
+            g_string_printf(text, "%s\n%s – %s", bar->span->task->text, first_text, last_text);
+        } else {
+            guint shown = 0;
+            span_index_query(view->index, bar->day, bar->day + 1, view->query);
+            for (guint j = 0; j < view->query->len && shown < 20; j++, shown++) {
+                TaskSpan *span = g_ptr_array_index(view->query, j);
+                g_string_append_printf(text, "%s%s", shown ? "\n" : "", span->task->text);
+            }
+            if (view->query->len > shown) {
+                g_string_append_printf(text, "\n… and %u more", view->query->len - shown);
+            }
+        }
+        gtk_tooltip_set_text(tooltip, text->str);
+        g_string_free(text, TRUE);
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/**
+ * @brief Callback for "scroll-event": the wheel moves a month, or a week in
+ * week mode.
+ */
+static gboolean on_calendar_scroll(GtkWidget *widget, GdkEventScroll *event, gpointer user_data) {
+    CalendarView *view = user_data;
+
+    if (event->direction == GDK_SCROLL_UP) {
+        calendar_step(view, -1);
+    } else if (event->direction == GDK_SCROLL_DOWN) {
+        calendar_step(view, 1);
+    } else {
+        return GDK_EVENT_PROPAGATE;
+    }
+    return GDK_EVENT_STOP;
+}
+
+static void on_calendar_previous(GtkWidget *widget, gpointer user_data) {
+    calendar_step(user_data, -1);
+}
+
+static void on_calendar_next(GtkWidget *widget, gpointer user_data) {
+    calendar_step(user_data, 1);
+}
+
+static void on_calendar_today(GtkWidget *widget, gpointer user_data) {
+    calendar_show_day(user_data, query_today());
+}
+
+/**
+ * @brief Callback for the week toggle: switches between a month and the
+ * week that holds the day in view, today's if it is in the month.
+ */
+static void on_calendar_week_toggled(GtkToggleButton *button, gpointer user_data) {
+    CalendarView *view = user_data;
+    gint32 today = query_today();
+    gint32 first;
+    guint n_weeks = calendar_get_range(view, &first);
+    gint32 day = today >= first && today < first + (gint32)n_weeks * 7 ? today : view->anchor;
+
+    view->week_mode = gtk_toggle_button_get_active(button);
+    calendar_show_day(view, day);
+}
+
+/**
+ * @brief Store listener for the calendar. The bars of the last draw may
+ * point at spans the commit freed, so they are dropped with the redraw.
+ */
+static void on_calendar_store_changed(TaskStore *store, guint position, guint removed, guint added,
+                                      gpointer user_data) {
+    CalendarView *view = user_data;
+
+    g_array_set_size(view->bars, 0);
+    gtk_widget_queue_draw(view->area);
+}
+
+/**
+ * @brief Frees the calendar when its page is destroyed.
+ */
+static void on_calendar_destroy(GtkWidget *widget, gpointer user_data) {
+    CalendarView *view = user_data;
+
+    task_store_remove_listener(view->index->store, view);
+    g_ptr_array_free(view->query, TRUE);
+    g_array_free(view->slot_ends, TRUE);
+    g_array_free(view->bars, TRUE);
+    g_free(view);
+}
+
+/**
+ * @brief Creates a calendar of the spans in an index, showing this month.
+ *
+ * @param index The span index, shared by all windows.
+ * @return The new calendar. It is freed when its page is destroyed.
+ */
+static CalendarView *calendar_view_new(SpanIndex *index) {
+    CalendarView *view = g_new0(CalendarView, 1);
+    GtkWidget *toolbar;
+    GtkWidget *button;
+
+    view->index = index;
+    view->query = g_ptr_array_new();
+    view->slot_ends = g_array_new(FALSE, FALSE, sizeof(gint32));
+    view->bars = g_array_new(FALSE, FALSE, sizeof(CalendarBar));
+
+    view->widget = gtk_box_new(GTK_ORIENTATION_VERTICAL, 10);
+    toolbar = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 6);
+    gtk_box_pack_start(GTK_BOX(view->widget), toolbar, FALSE, FALSE, 0);
+
+    button = gtk_button_new_from_icon_name("go-previous-symbolic", GTK_ICON_SIZE_BUTTON);
+    gtk_widget_set_tooltip_text(button, "Previous");
+    g_signal_connect(button, "clicked", G_CALLBACK(on_calendar_previous), view);
+    gtk_box_pack_start(GTK_BOX(toolbar), button, FALSE, FALSE, 0);
+    button = gtk_button_new_with_label("Today");
+    g_signal_connect(button, "clicked", G_CALLBACK(on_calendar_today), view);
+    gtk_box_pack_start(GTK_BOX(toolbar), button, FALSE, FALSE, 0);
+    button = gtk_button_new_from_icon_name("go-next-symbolic", GTK_ICON_SIZE_BUTTON);
+    gtk_widget_set_tooltip_text(button, "Next");
+    g_signal_connect(button, "clicked", G_CALLBACK(on_calendar_next), view);
+    gtk_box_pack_start(GTK_BOX(toolbar), button, FALSE, FALSE, 0);
+
+    view->title = gtk_label_new(NULL);
+    gtk_style_context_add_class(gtk_widget_get_style_context(view->title), "calendar-title");
+    gtk_box_pack_start(GTK_BOX(toolbar), view->title, TRUE, TRUE, 0);
+
+    button = gtk_toggle_button_new_with_label("Week");
+    gtk_widget_set_tooltip_text(button, "Show one week instead of the whole month");
+    g_signal_connect(button, "toggled", G_CALLBACK(on_calendar_week_toggled), view);
+    gtk_box_pack_end(GTK_BOX(toolbar), button, FALSE, FALSE, 0);
+
+    view->area = gtk_drawing_area_new();
+    gtk_widget_add_events(view->area, GDK_SCROLL_MASK);
+    gtk_widget_set_has_tooltip(view->area, TRUE);
+    g_signal_connect(view->area, "draw", G_CALLBACK(on_calendar_draw), view);
+    g_signal_connect(view->area, "scroll-event", G_CALLBACK(on_calendar_scroll), view);
+    g_signal_connect(view->area, "query-tooltip", G_CALLBACK(on_calendar_query_tooltip), view);
+    gtk_box_pack_start(GTK_BOX(view->widget), view->area, TRUE, TRUE, 0);
+    g_signal_connect(view->widget, "destroy", G_CALLBACK(on_calendar_destroy), view);
+
+    calendar_show_day(view, query_today());
+    task_store_add_listener(index->store, on_calendar_store_changed, view);
+    return view;
+}
+
+// --- Reports ---
+
+/*
+ * A status report lists every task grouped by project (the first "+name"
+ * token of its text) and then by tag, with how many are done in each
+ * group. It is written on a worker thread from a copy of the store, and
+ * streamed: HTML goes out in REPORT_FLUSH_BYTES pieces and PDF a page at a
+ * time through cairo's PDF surface, so the document itself is never held
+ * in memory.
+ */
+
+// HTML is written whenever this much is waiting.
+#define REPORT_FLUSH_BYTES (64 * 1024)
+// Entries written between checks for cancellation.
+#define REPORT_CANCEL_INTERVAL 1024
+// A4, in points.
+#define REPORT_PAGE_WIDTH 595.0
+#define REPORT_PAGE_HEIGHT 842.0
+#define REPORT_MARGIN 48.0
+// A task text longer than this many lines is cut short in the PDF.
+#define REPORT_MAX_TASK_LINES 5
+// Rank of the "No project" and "Untagged" groups, which come last.
+#define REPORT_NONE G_MAXUINT32
+
+typedef enum {
+    REPORT_FORMAT_HTML,
+    REPORT_FORMAT_PDF,
+} ReportFormat;
+
+typedef enum {
+    REPORT_FONT_TITLE,
+    REPORT_FONT_PROJECT,
+    REPORT_FONT_TAG,
+    REPORT_FONT_TASK,
+    REPORT_N_FONTS,
+} ReportFont;
+
+/**
+ * @brief A copy of what the report needs of a task.
+ */
+typedef struct {
+    gchar *text;
+    gboolean is_completed;
+} ReportTask;
+
+/**
+ * @brief One line of the report: a task under one of its tags.
+ */
+typedef struct {
+    guint32 project;         // Rank of the project name, or REPORT_NONE.
+    guint32 tag;             // Rank of the tag name, or REPORT_NONE.
+    guint32 task;            // Index into the ReportTasks.
+} ReportEntry;
+
+/**
+ * @brief What report_thread() works from.
+ */
+typedef struct {
+    GFile *file;
+    ReportFormat format;
+    GArray *tasks;           // ReportTask, in store order.
+    gint32 today;
+} ReportJob;
+
+/**
+ * @brief Streams a report to a file in either format.
+ */
+typedef struct {
+    ReportFormat format;
+    GOutputStream *stream;
+    GCancellable *cancellable;
+    GError *error;           // The first failed write; nothing is written after it.
+    GString *buffer;         // HTML waiting to be written.
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    PangoLayout *layout;
+    PangoFontDescription *fonts[REPORT_N_FONTS];
+    gdouble y;               // Top of the next line on the PDF page.
+    guint page;
+} ReportWriter;
+
+static void report_task_clear(gpointer data) {
+    g_free(((ReportTask *)data)->text);
+}
+
+/**
+ * @brief Copies what the report needs of every task, for handing to a
+ * worker thread.
+ *
+ * @return A GArray of ReportTask, in store order.
+ */
+static GArray *report_snapshot_tasks(TaskStore *store) {
+    GArray *tasks = g_array_sized_new(FALSE, FALSE, sizeof(ReportTask), store->tasks->len);
+
+    g_array_set_clear_func(tasks, report_task_clear);
+    for (guint i = 0; i < store->tasks->len; i++) {
+        Task *task = task_store_get(store, i);
+        ReportTask copy = { g_strdup(task->text), task->is_completed };
+        g_array_append_val(tasks, copy);
+    }
+    return tasks;
+}
+
+static void report_job_free(ReportJob *job) {
+    g_object_unref(job->file);
+    g_array_unref(job->tasks);
+    g_free(job);
+}
+
+/**
+ * @brief Finds the project of a task text: its first "+name" token.
+ *
+ * @return The lower-cased name without the '+', or NULL if there is none.
+ */
+static gchar *extract_project(const gchar *text) {
+    for (const gchar *p = text; (p = strchr(p, '+')) != NULL; ) {
+        const gchar *start = ++p;
+        while (g_ascii_isalnum(*p) || *p == '-' || *p == '_') {
+            p++;
+        }
+        if (p > start && (start - 1 == text || g_ascii_isspace(start[-2]))) {
+            return g_ascii_strdown(start, p - start);
+        }
+    }
+    return NULL;
+}
+
+static gboolean report_write(ReportWriter *writer, const gchar *data, gsize length) {
+    if (!writer->error) {
+        g_output_stream_write_all(writer->stream, data, length, NULL, writer->cancellable, &writer->error);
+    }
+    return writer->error == NULL;
+}
+
+static cairo_status_t report_write_pdf(void *closure, const unsigned char *data, unsigned int length) {
+    return report_write(closure, (const gchar *)data, length) ? CAIRO_STATUS_SUCCESS : CAIRO_STATUS_WRITE_ERROR;
+}
+
+static void report_flush_html(ReportWriter *writer, gboolean all) {
+    if (all || writer->buffer->len >= REPORT_FLUSH_BYTES) {
+        report_write(writer, writer->buffer->str, writer->buffer->len);
+        g_string_truncate(writer->buffer, 0);
+    }
+}
+
+static void report_append_html_escaped(ReportWriter *writer, const gchar *text) {
+    gchar *escaped = g_markup_escape_text(text, -1);
+    g_string_append(writer->buffer, escaped);
+    g_free(escaped);
+}
+
+static void report_format_stats(gchar *out, gsize size, guint done, guint total) {
+    g_snprintf(out, size, "%u of %u done (%u%%)", done, total, total ? (guint)((guint64)done * 100 / total) : 0);
+}
+
+/**
+ * @brief Finishes the PDF page being written and starts the next one.
+ */
+static void report_pdf_next_page(ReportWriter *writer) {
+    gchar number[16];
+    gint width;
+
+    g_snprintf(number, sizeof(number), "%u", writer->page);
+    pango_layout_set_font_description(writer->layout, writer->fonts[REPORT_FONT_TASK]);
+    pango_layout_set_text(writer->layout, number, -1);
+    pango_layout_get_pixel_size(writer->layout, &width, NULL);
+    cairo_set_source_rgb(writer->cr, 0.42, 0.45, 0.50);
+    cairo_move_to(writer->cr, (REPORT_PAGE_WIDTH - width) / 2, REPORT_PAGE_HEIGHT - REPORT_MARGIN / 2 - 6);
+    pango_cairo_show_layout(writer->cr, writer->layout);
+
+    cairo_show_page(writer->cr);
+    writer->page++;
+    writer->y = REPORT_MARGIN;
+}
+
+/**
+ * @brief Writes a line of text to the PDF, starting a new page first if it
+ * would not fit along with @keep more points below it.
+ *
+ * @return Where the top of the text went.
+ */
+static gdouble report_pdf_text(ReportWriter *writer, ReportFont font, const gchar *text, gdouble indent,
+                            gdouble space_before, gdouble keep) {
+    gint height;
+
+    pango_layout_set_font_description(writer->layout, writer->fonts[font]);
+    pango_layout_set_width(writer->layout, (REPORT_PAGE_WIDTH - 2 * REPORT_MARGIN - indent) * PANGO_SCALE);
+    pango_layout_set_text(writer->layout, text, -1);
+    pango_layout_get_pixel_size(writer->layout, NULL, &height);
+
+    if (writer->y > REPORT_MARGIN) {
+        writer->y += space_before;
+    }
+    if (writer->y + height + keep > REPORT_PAGE_HEIGHT - REPORT_MARGIN && writer->y > REPORT_MARGIN) {
+        report_pdf_next_page(writer);
+    }
+    cairo_move_to(writer->cr, REPORT_MARGIN + indent, writer->y);
+    pango_cairo_show_layout(writer->cr, writer->layout);
+    writer->y += height;
+    return writer->y - height;
+}
+
+static void report_begin(ReportWriter *writer, gint32 today, guint done, guint total) {
+    GDate date;
+    gchar date_text[32];
+    gchar stats[64];
+
+    g_date_clear(&date, 1);
+    g_date_set_julian(&date, today);
+    g_date_strftime(date_text, sizeof(date_text), "%Y-%m-%d", &date);
+    report_format_stats(stats, sizeof(stats), done, total);
+
+    if (writer->format == REPORT_FORMAT_HTML) {
+        g_string_append_printf(writer->buffer,
+                               "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\"><title>Status Report %s</title>\n"
+                               "<style>body{font-family:sans-serif;color:#1f2937;margin:2em}"
+                               ".stats{color:#6b7280;font-weight:normal;font-size:0.8em}"
+                               "li.done{color:#9ca3af;text-decoration:line-through}</style></head><body>\n"
+                               "<h1>Status Report</h1>\n<p class=\"stats\">%s &middot; %s</p>\n",
+                               date_text, date_text, stats);
+    } else {
+        gchar *line = g_strdup_printf("%s · %s", date_text, stats);
+        cairo_set_source_rgb(writer->cr, 0.12, 0.16, 0.22);
+        report_pdf_text(writer, REPORT_FONT_TITLE, "Status Report", 0, 0, 0);
+        cairo_set_source_rgb(writer->cr, 0.42, 0.45, 0.50);
+        report_pdf_text(writer, REPORT_FONT_TASK, line, 0, 4, 0);
+        g_free(line);
+    }
+}
+
+/**
+ * @brief Writes the heading of a project (@level 0) or of a tag within it
+ * (@level 1).
+ */
+static void report_heading(ReportWriter *writer, guint level, const gchar *name, guint done, guint total) {
+    gchar stats[64];
+
+    report_format_stats(stats, sizeof(stats), done, total);
+    if (writer->format == REPORT_FORMAT_HTML) {
+        g_string_append_printf(writer->buffer, "<h%u>", level + 2);
+        report_append_html_escaped(writer, name);
+        g_string_append_printf(writer->buffer, " <span class=\"stats\">%s</span></h%u>\n%s", stats, level + 2,
+                               level == 1 ? "<ul>\n" : "");
+    } else {
+        gchar *line = g_strdup_printf("%s — %s", name, stats);
+        cairo_set_source_rgb(writer->cr, 0.12, 0.16, 0.22);
+        // A heading is kept on the page of its first task.
+        report_pdf_text(writer, level == 0 ? REPORT_FONT_PROJECT : REPORT_FONT_TAG, line, level * 12,
+                        level == 0 ? 18 : 10, 16);
+        g_free(line);
+    }
+}
+
+static void report_task(ReportWriter *writer, const ReportTask *task) {
+    if (writer->format == REPORT_FORMAT_HTML) {
+        g_string_append(writer->buffer, task->is_completed ? "<li class=\"done\">" : "<li>");
+        report_append_html_escaped(writer, task->text);
+        g_string_append(writer->buffer, "</li>\n");
+        report_flush_html(writer, FALSE);
+    } else {
+        gdouble top;
+
+        if (task->is_completed) {
+            cairo_set_source_rgb(writer->cr, 0.61, 0.64, 0.69);
+        } else {
+            cairo_set_source_rgb(writer->cr, 0.12, 0.16, 0.22);
+        }
+        top = report_pdf_text(writer, REPORT_FONT_TASK, task->text, 40, 3, 0);
+        // A checkbox beside the first line, drawn rather than taken from a font.
+        cairo_set_line_width(writer->cr, 0.8);
+        cairo_rectangle(writer->cr, REPORT_MARGIN + 26, top + 3, 8, 8);
+        if (task->is_completed) {
+            cairo_move_to(writer->cr, REPORT_MARGIN + 27.5, top + 7);
+            cairo_line_to(writer->cr, REPORT_MARGIN + 29.5, top + 9.5);
+            cairo_line_to(writer->cr, REPORT_MARGIN + 33, top + 4);
+        }
+        cairo_stroke(writer->cr);
+    }
+}
+
+static void report_group_end(ReportWriter *writer) {
+    if (writer->format == REPORT_FORMAT_HTML) {
+        g_string_append(writer->buffer, "</ul>\n");
+    }
+}
+
+/**
+ * @brief Opens a writer on a stream.
+ */
+static void report_writer_init(ReportWriter *writer, ReportFormat format, GOutputStream *stream,
+                               GCancellable *cancellable) {
+    static const gchar *const fonts[REPORT_N_FONTS] = { "Sans Bold 18", "Sans Bold 13", "Sans Bold 11", "Sans 10" };
+
+    memset(writer, 0, sizeof(*writer));
+    writer->format = format;
+    writer->stream = stream;
+    writer->cancellable = cancellable;
+    if (format == REPORT_FORMAT_HTML) {
+        writer->buffer = g_string_sized_new(REPORT_FLUSH_BYTES + 4096);
+        return;
+    }
+    writer->surface = cairo_pdf_surface_create_for_stream(report_write_pdf, writer, REPORT_PAGE_WIDTH,
+                                                          REPORT_PAGE_HEIGHT);
+    writer->cr = cairo_create(writer->surface);
+    // Layouts made here use this thread's own font map.
+    writer->layout = pango_cairo_create_layout(writer->cr);
+    pango_layout_set_wrap(writer->layout, PANGO_WRAP_WORD_CHAR);
+    pango_layout_set_ellipsize(writer->layout, PANGO_ELLIPSIZE_END);
+    pango_layout_set_height(writer->layout, -REPORT_MAX_TASK_LINES);
+    for (guint i = 0; i < REPORT_N_FONTS; i++) {
+        writer->fonts[i] = pango_font_description_from_string(fonts[i]);
+    }
+    writer->y = REPORT_MARGIN;
+    writer->page = 1;
+}
+
+/**
+ * @brief Writes whatever is left and frees the writer, but not its stream.
+ *
+ * @return FALSE, with @error set, if any write failed.
+ */
+static gboolean report_writer_finish(ReportWriter *writer, GError **error) {
+    if (writer->format == REPORT_FORMAT_HTML) {
+        g_string_append(writer->buffer, "</body></html>\n");
+        report_flush_html(writer, TRUE);
+        g_string_free(writer->buffer, TRUE);
+    } else {
+        report_pdf_next_page(writer);
+        g_object_unref(writer->layout);
+        cairo_destroy(writer->cr);
+        // Finishing writes the trailer, and the fonts, through report_write_pdf().
+        cairo_surface_finish(writer->surface);
+        if (!writer->error && cairo_surface_status(writer->surface) != CAIRO_STATUS_SUCCESS) {
+            g_set_error_literal(&writer->error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                                cairo_status_to_string(cairo_surface_status(writer->surface)));
+        }
+        cairo_surface_destroy(writer->surface);
+        for (guint i = 0; i < REPORT_N_FONTS; i++) {
+            pango_font_description_free(writer->fonts[i]);
+        }
+    }
+    if (writer->error) {
+        g_propagate_error(error, writer->error);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static gint report_compare_names(gconstpointer a, gconstpointer b) {
+    return strcmp(*(const gchar *const *)a, *(const gchar *const *)b);
+}
+
+/**
+ * @brief Sorts interned names, and works out the rank of each id.
+ *
+ * @param names The names, indexed by id. Sorted in place, so that
+ * afterwards they are indexed by rank.
+ * @param ids The name -> id table the names were interned with.
+ * @return A new array of guint32 ranks, indexed by id.
+ */
+static guint32 *report_rank_names(GPtrArray *names, GHashTable *ids) {
+    guint32 *ranks = g_new(guint32, MAX(names->len, 1));
+
+    g_ptr_array_sort(names, report_compare_names);
+    for (guint i = 0; i < names->len; i++) {
+        ranks[GPOINTER_TO_UINT(g_hash_table_lookup(ids, g_ptr_array_index(names, i)))] = i;
+    }
+    return ranks;
+}
+
+static guint32 report_intern(GPtrArray *names, GHashTable *ids, gchar *name) {
+    gpointer id;
+
+    if (g_hash_table_lookup_extended(ids, name, NULL, &id)) {
+        g_free(name);
+        return GPOINTER_TO_UINT(id);
+    }
+    g_hash_table_insert(ids, name, GUINT_TO_POINTER(names->len));
+    g_ptr_array_add(names, name);
+    return names->len - 1;
+}
+
+static gint report_compare_entries(gconstpointer a, gconstpointer b) {
+    const ReportEntry *x = a, *y = b;
+
+    if (x->project != y->project) {
+        return x->project < y->project ? -1 : 1;
+    }
+    if (x->tag != y->tag) {
+        return x->tag < y->tag ? -1 : 1;
+    }
+    return x->task < y->task ? -1 : x->task > y->task;
+}
+
+/**
+ * @brief Worker thread for on_export_report_action(). Groups the tasks and
+ * streams the report into the file.
+ */
+static void report_thread(GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable) {
+    ReportJob *job = task_data;
+    GArray *tasks = job->tasks;
+    // The arrays own the names; the tables only point at them.
+    GPtrArray *projects = g_ptr_array_new_with_free_func(g_free);
+    GPtrArray *tags = g_ptr_array_new_with_free_func(g_free);
+    GHashTable *project_ids = g_hash_table_new(g_str_hash, g_str_equal);
+    GHashTable *tag_ids = g_hash_table_new(g_str_hash, g_str_equal);
+    GArray *entries = g_array_sized_new(FALSE, FALSE, sizeof(ReportEntry), tasks->len);
+    GArray *counts = g_array_new(FALSE, TRUE, sizeof(guint) * 2);
+    guint none_counts[2] = { 0, 0 };
+    guint32 *project_ranks, *tag_ranks;
+    guint *project_counts;
+    guint done = 0;
+    GFileOutputStream *stream;
+    ReportWriter writer;
+    GError *error = NULL;
+    gboolean ok = FALSE;
+
+    // Projects and tags are interned and counted first, then ranked so that
+    // entries sort by integers alone. A project counts each of its tasks
+    // once; a tag group counts the tasks listed under it.
+    for (guint i = 0; i < tasks->len; i++) {
+        ReportTask *report_task = &g_array_index(tasks, ReportTask, i);
+        gchar *project = extract_project(report_task->text);
+        GHashTable *task_tags = extract_tags(report_task->text);
+        ReportEntry entry = { REPORT_NONE, REPORT_NONE, i };
+        guint *project_count = none_counts;
+        GHashTableIter iter;
+        gpointer tag;
+
+        if (project) {
+            entry.project = report_intern(projects, project_ids, project);
+            if (entry.project >= counts->len) {
+                g_array_set_size(counts, entry.project + 1);
+            }
+            project_count = (guint *)counts->data + entry.project * 2;
+        }
+        project_count[0] += report_task->is_completed;
+        project_count[1]++;
+        done += report_task->is_completed;
+
+        if (g_hash_table_size(task_tags) == 0) {
+            g_array_append_val(entries, entry);
+        }
+        g_hash_table_iter_init(&iter, task_tags);
+        while (g_hash_table_iter_next(&iter, &tag, NULL)) {
+            entry.tag = report_intern(tags, tag_ids, g_strdup(tag));
+            g_array_append_val(entries, entry);
+        }
+        g_hash_table_unref(task_tags);
+    }
+    project_ranks = report_rank_names(projects, project_ids);
+    tag_ranks = report_rank_names(tags, tag_ids);
+    g_hash_table_unref(project_ids);
+    g_hash_table_unref(tag_ids);
+    // Done and total per project rank, with "No project" last.
+    project_counts = g_new(guint, (projects->len + 1) * 2);
+    for (guint id = 0; id < projects->len; id++) {
+        memcpy(project_counts + project_ranks[id] * 2, (guint *)counts->data + id * 2, sizeof(guint) * 2);
+    }
+    memcpy(project_counts + projects->len * 2, none_counts, sizeof(none_counts));
+    g_array_unref(counts);
+    for (guint i = 0; i < entries->len; i++) {
+        ReportEntry *entry = &g_array_index(entries, ReportEntry, i);
+        if (entry->project != REPORT_NONE) {
+            entry->project = project_ranks[entry->project];
+        }
+        if (entry->tag != REPORT_NONE) {
+            entry->tag = tag_ranks[entry->tag];
+        }
+    }
+    g_free(project_ranks);
+    g_free(tag_ranks);
+    g_array_sort(entries, report_compare_entries);
+
+    stream = g_file_replace(job->file, NULL, FALSE, G_FILE_CREATE_NONE, cancellable, &error);
+    if (stream) {
+        report_writer_init(&writer, job->format, G_OUTPUT_STREAM(stream), cancellable);
+        report_begin(&writer, job->today, done, tasks->len);
+
+        for (guint i = 0; i < entries->len && !writer.error; ) {
+            ReportEntry first = g_array_index(entries, ReportEntry, i);
+            guint end = i, tag_done = 0;
+            gchar *name;
+
+            if (i == 0 || first.project != g_array_index(entries, ReportEntry, i - 1).project) {
+                guint rank = first.project == REPORT_NONE ? projects->len : first.project;
+                name = rank < projects->len ? g_strconcat("+", g_ptr_array_index(projects, rank), NULL)
+                                            : g_strdup("No project");
+                report_heading(&writer, 0, name, project_counts[rank * 2], project_counts[rank * 2 + 1]);
+                g_free(name);
+            }
+            while (end < entries->len && g_array_index(entries, ReportEntry, end).project == first.project &&
+                   g_array_index(entries, ReportEntry, end).tag == first.tag) {
+                tag_done += g_array_index(tasks, ReportTask, g_array_index(entries, ReportEntry, end).task).is_completed;
+                end++;
+            }
+            name = first.tag != REPORT_NONE ? g_strconcat("#", g_ptr_array_index(tags, first.tag), NULL)
+                                            : g_strdup("Untagged");
+            report_heading(&writer, 1, name, tag_done, end - i);
+            g_free(name);
+
+            for (; i < end && !writer.error; i++) {
+                report_task(&writer, &g_array_index(tasks, ReportTask, g_array_index(entries, ReportEntry, i).task));
+                if (i % REPORT_CANCEL_INTERVAL == 0) {
+                    g_cancellable_set_error_if_cancelled(cancellable, &writer.error);
+                }
+            }
+            report_group_end(&writer);
+        }
+
+        ok = report_writer_finish(&writer, &error);
+        if (ok) {
+            ok = g_output_stream_close(G_OUTPUT_STREAM(stream), cancellable, &error);
+        } else {
+            // Closing through a cancelled cancellable leaves any earlier file in place.
+            GCancellable *abandon = g_cancellable_new();
+            g_cancellable_cancel(abandon);
+            g_output_stream_close(G_OUTPUT_STREAM(stream), abandon, NULL);
+            g_object_unref(abandon);
+        }
+        g_object_unref(stream);
+    }
+
+    g_free(project_counts);
+    g_array_unref(entries);
+    g_ptr_array_unref(projects);
+    g_ptr_array_unref(tags);
+    if (ok) {
+        g_task_return_boolean(task, TRUE);
+    } else {
+        g_task_return_error(task, error);
+    }
+}
+
+/**
+ * @brief Completion callback for on_export_report_action(). Says where the
+ * report went, or why it could not be written.
+ */
+static void on_report_done(GObject *source_object, GAsyncResult *result, gpointer user_data) {
+    GtkWidget *window = GTK_WIDGET(source_object);
+    gchar *path = user_data;
+    GError *error = NULL;
+    GtkWidget *dialog;
+
+    if (!g_task_propagate_boolean(G_TASK(result), &error) && g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        // Cancelled, because the window closed or a newer report started.
+        g_error_free(error);
+        g_free(path);
+        return;
+    }
+    g_object_set_data(G_OBJECT(window), "report_cancellable", NULL);
+
+    dialog = gtk_message_dialog_new(GTK_WINDOW(window), GTK_DIALOG_DESTROY_WITH_PARENT,
+                                    error ? GTK_MESSAGE_ERROR : GTK_MESSAGE_INFO, GTK_BUTTONS_CLOSE,
+                                    error ? "Could not write the report" : "Report written");
+    gtk_message_dialog_format_secondary_text(GTK_MESSAGE_DIALOG(dialog), "%s", error ? error->message : path);
+    g_signal_connect(dialog, "response", G_CALLBACK(gtk_widget_destroy), NULL);
+    gtk_widget_show(dialog);
+    g_clear_error(&error);
+    g_free(path);
+}
+
+/**
+ * @brief Cancels the report being written for a window, if any.
+ *
+ * @param window The GtkApplicationWindow.
+ */
+static void report_cancel(GtkWidget *window) {
+    GCancellable *cancellable = g_object_get_data(G_OBJECT(window), "report_cancellable");
+
+    if (cancellable) {
+        g_cancellable_cancel(cancellable);
+        g_object_set_data(G_OBJECT(window), "report_cancellable", NULL);
+    }
+}
+
+/**
+ * @brief Action handler for "win.export-report". Asks for a file and writes
+ * a status report of every task into it on a worker thread: PDF if the
+ * name ends in ".pdf", HTML otherwise.
+ */
+static void on_export_report_action(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    GtkWidget *window = user_data;
+    TaskStore *store = g_object_get_data(G_OBJECT(window), "store");
+    const gchar *documents = g_get_user_special_dir(G_USER_DIRECTORY_DOCUMENTS);
+    GtkWidget *dialog;
+    GtkFileFilter *filter;
+
+    dialog = gtk_file_chooser_dialog_new("Export Report", GTK_WINDOW(window), GTK_FILE_CHOOSER_ACTION_SAVE,
+                                         "_Cancel", GTK_RESPONSE_CANCEL, "_Export", GTK_RESPONSE_ACCEPT, NULL);
+    gtk_file_chooser_set_do_overwrite_confirmation(GTK_FILE_CHOOSER(dialog), TRUE);
+    // Not the working directory, which is the store's.
+    gtk_file_chooser_set_current_folder(GTK_FILE_CHOOSER(dialog), documents ? documents : g_get_home_dir());
+    gtk_file_chooser_set_current_name(GTK_FILE_CHOOSER(dialog), "status-report.html");
+    filter = gtk_file_filter_new();
+    gtk_file_filter_set_name(filter, "HTML or PDF");
+    gtk_file_filter_add_pattern(filter, "*.html");
+    gtk_file_filter_add_pattern(filter, "*.pdf");
+    gtk_file_chooser_add_filter(GTK_FILE_CHOOSER(dialog), filter);
+
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+        ReportJob *job = g_new0(ReportJob, 1);
+        GCancellable *cancellable = g_cancellable_new();
+        gchar *name;
+
+        job->file = gtk_file_chooser_get_file(GTK_FILE_CHOOSER(dialog));
+        name = g_file_get_basename(job->file);
+        job->format = g_str_has_suffix(name, ".pdf") ? REPORT_FORMAT_PDF : REPORT_FORMAT_HTML;
+        g_free(name);
+        job->today = query_today();
+        job->tasks = report_snapshot_tasks(store);
+
+        report_cancel(window);
+        g_object_set_data_full(G_OBJECT(window), "report_cancellable", cancellable, g_object_unref);
+        GTask *task = g_task_new(window, cancellable, on_report_done, g_file_get_parse_name(job->file));
+        g_task_set_task_data(task, job, (GDestroyNotify)report_job_free);
+        g_task_run_in_thread(task, report_thread);
+        g_object_unref(task);
+    }
+    gtk_widget_destroy(dialog);
+}
+
+// --- Change Feed ---
+
+/*
+ * The change feed publishes every change to the store over a Unix-domain
+ * socket, one line per event:
+ *
+ *   SEQ add ID DONE STATUS TEXT      a task was added
+ *   SEQ update ID DONE STATUS TEXT   a task's text or status changed
+ *   SEQ remove ID                    a task was removed
+ *
+ * with the fields separated by tabs. A subscriber connects and sends the
+ * last sequence number it has seen, or 0, followed by a newline. It gets
+ * every event after that one that is still in the ring. If that is too far
+ * back, or from an earlier run, it gets "SEQ reset" instead, then an "add"
+ * line for every task as of SEQ, then "SEQ synced", and the events after
+ * SEQ from there on. A subscriber that disconnects before "synced" has to
+ * start over from 0.
+ *
+ * Sequence numbers start at the wall-clock time in microseconds, so they
+ * keep growing across restarts. Events are encoded once, on commit, into a
+ * ring shared by every subscriber. Each subscriber has a cursor into it and
+ * gets batches of up to FEED_BATCH_BYTES whenever its socket is writable,
+ * so a slow subscriber only falls behind, and is sent a reset when the ring
+ * has moved past it. The main loop never waits on a subscriber.
+ */
+
+#define FEED_SOCKET "tasks.sock"
+// Events kept for subscribers to catch up from. A commit that changes more
+// tasks than a quarter of this is published as a reset instead.
+#define FEED_RING_EVENTS 65536
+// Most bytes queued for a subscriber per write.
+#define FEED_BATCH_BYTES (64 * 1024)
+// Longest resume line a subscriber may send.
+#define FEED_MAX_REQUEST 64
+#define FEED_MAX_SUBSCRIBERS 64
+
+typedef struct _TaskFeed TaskFeed;
+
+/**
+ * @brief A connected subscriber.
+ */
+typedef struct {
+    TaskFeed *feed;
+    int fd;
+    guint source;
+    GIOCondition condition;  // What the source watches for.
+    GString *request;        // The resume line, until it is complete.
+    gboolean started;
+    guint64 cursor;          // Next event to send.
+    gboolean snapshotting;
+    guint64 snapshot_seq;    // The event the snapshot being sent is as of.
+    guint snapshot_id;       // Next task id to send in the snapshot.
+    GString *output;         // Batch being written.
+    gsize output_offset;
+} FeedSubscriber;
+
+struct _TaskFeed {
+    TaskStore *store;
+    int listen_fd;
+    guint listen_source;
+    GArray *stamps;          // TaskStamp per task, as last published.
+    gchar **ring;            // Encoded events by sequence number modulo FEED_RING_EVENTS; NULL for a reset.
+    guint64 first_seq;       // Oldest event in the ring.
+    guint64 next_seq;
+    GPtrArray *subscribers;
+};
+
+static gboolean on_feed_subscriber_io(gint fd, GIOCondition condition, gpointer user_data);
+
+static void feed_append_task(TaskFeed *feed, GString *out, guint64 seq, const gchar *op, const Task *task) {
+    g_string_append_printf(out, "%" G_GUINT64_FORMAT "\t%s\t%u\t%d\t%s\t%s\n", seq, op, task->id, task->is_completed,
+                           (const gchar *)g_ptr_array_index(feed->store->statuses, task->status), task->text);
+}
+
+/**
+ * @brief Adds an event to the ring, dropping the oldest if it is full.
+ *
+ * @param line The encoded event, which the ring takes, or NULL for a reset.
+ */
+static void feed_push(TaskFeed *feed, gchar *line) {
+    if (feed->next_seq - feed->first_seq == FEED_RING_EVENTS) {
+        g_free(feed->ring[feed->first_seq % FEED_RING_EVENTS]);
+        feed->first_seq++;
+    }
+    feed->ring[feed->next_seq % FEED_RING_EVENTS] = line;
+    feed->next_seq++;
+}
+
+static void feed_subscriber_watch(FeedSubscriber *subscriber, GIOCondition condition) {
+    if (condition != subscriber->condition) {
+        if (subscriber->source) {
+            g_source_remove(subscriber->source);
+        }
+        subscriber->condition = condition;
+        subscriber->source = g_unix_fd_add(subscriber->fd, condition, on_feed_subscriber_io, subscriber);
+    }
+}
+
+static void feed_subscriber_free(FeedSubscriber *subscriber) {
+    if (subscriber->source) {
+        g_source_remove(subscriber->source);
+    }
+    close(subscriber->fd);
+    g_string_free(subscriber->request, TRUE);
+    g_string_free(subscriber->output, TRUE);
+    g_free(subscriber);
+}
+
+/**
+ * @brief Queues the subscriber's next batch: snapshot lines while a
+ * snapshot is being sent, then events from the ring.
+ */
+static void feed_subscriber_fill(FeedSubscriber *subscriber) {
+    TaskFeed *feed = subscriber->feed;
+    TaskStore *store = feed->store;
+    GString *out = subscriber->output;
+
+    while (out->len < FEED_BATCH_BYTES) {
+        if (subscriber->snapshotting) {
+            guint position;
+            Task *task;
+
+            // Found by id, so tasks removed or added meanwhile are simply
+            // skipped or included, and their events follow the snapshot.
+            task_store_find(store, subscriber->snapshot_id, &position);
+            if (position == store->tasks->len) {
+                g_string_append_printf(out, "%" G_GUINT64_FORMAT "\tsynced\n", subscriber->snapshot_seq);
+                subscriber->snapshotting = FALSE;
+                subscriber->cursor = subscriber->snapshot_seq + 1;
+                continue;
+            }
+            task = task_store_get(store, position);
+            feed_append_task(feed, out, subscriber->snapshot_seq, "add", task);
+            subscriber->snapshot_id = task->id + 1;
+        } else if (subscriber->cursor < feed->first_seq ||
+                   (subscriber->cursor < feed->next_seq && !feed->ring[subscriber->cursor % FEED_RING_EVENTS])) {
+            subscriber->snapshotting = TRUE;
+            subscriber->snapshot_seq = feed->next_seq - 1;
+            subscriber->snapshot_id = 0;
+            g_string_append_printf(out, "%" G_GUINT64_FORMAT "\treset\n", subscriber->snapshot_seq);
+        } else if (subscriber->cursor < feed->next_seq) {
+            g_string_append(out, feed->ring[subscriber->cursor % FEED_RING_EVENTS]);
+            subscriber->cursor++;
+        } else {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Reads the resume line, and notices when the subscriber hangs up.
+ *
+ * @return FALSE if the subscriber is gone or sent something invalid.
+ */
+static gboolean feed_subscriber_read(FeedSubscriber *subscriber) {
+    gchar buffer[FEED_MAX_REQUEST];
+    gssize length = recv(subscriber->fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+    const gchar *newline;
+
+    if (length < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    if (length == 0) {
+        return FALSE;
+    }
+    if (subscriber->started) {
+        // Anything after the resume line is ignored.
+        return TRUE;
+    }
+    g_string_append_len(subscriber->request, buffer, length);
+    newline = memchr(subscriber->request->str, '\n', subscriber->request->len);
+    if (!newline) {
+        return subscriber->request->len < FEED_MAX_REQUEST;
+    }
+
+    guint64 seen = g_ascii_strtoull(subscriber->request->str, NULL, 10);
+    TaskFeed *feed = subscriber->feed;
+    subscriber->started = TRUE;
+    // Anything before the ring, or past its end, gets a snapshot.
+    subscriber->cursor = seen + 1 >= feed->first_seq && seen < feed->next_seq ? seen + 1 : 0;
+    return TRUE;
+}
+
+/**
+ * @brief Writes as much of the subscriber's batch as the socket takes.
+ *
+ * @return FALSE if the subscriber is gone.
+ */
+static gboolean feed_subscriber_write(FeedSubscriber *subscriber) {
+    gssize written;
+
+    if (subscriber->output_offset == subscriber->output->len) {
+        g_string_truncate(subscriber->output, 0);
+        subscriber->output_offset = 0;
+        feed_subscriber_fill(subscriber);
+        if (subscriber->output->len == 0) {
+            return TRUE;
+        }
+    }
+    written = send(subscriber->fd, subscriber->output->str + subscriber->output_offset,
+                   subscriber->output->len - subscriber->output_offset, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (written < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    subscriber->output_offset += written;
+    return TRUE;
+}
+
+/**
+ * @brief Whether the subscriber has anything left to send.
+ */
+static gboolean feed_subscriber_pending(FeedSubscriber *subscriber) {
+    return subscriber->started && (subscriber->output_offset < subscriber->output->len || subscriber->snapshotting ||
+                                   subscriber->cursor < subscriber->feed->next_seq);
+}
+
+/**
+ * @brief Main loop callback for a subscriber's socket. Writes one batch at
+ * most, so other sources get their turn between batches.
+ */
+static gboolean on_feed_subscriber_io(gint fd, GIOCondition condition, gpointer user_data) {
+    FeedSubscriber *subscriber = user_data;
+    gboolean alive = TRUE;
+
+    if (condition & (G_IO_IN | G_IO_HUP | G_IO_ERR)) {
+        alive = feed_subscriber_read(subscriber);
+    }
+    if (alive && (condition & G_IO_OUT)) {
+        alive = feed_subscriber_write(subscriber);
+    }
+    if (!alive) {
+        // This source goes away by returning G_SOURCE_REMOVE.
+        subscriber->source = 0;
+        g_ptr_array_remove_fast(subscriber->feed->subscribers, subscriber);
+        return G_SOURCE_REMOVE;
+    }
+    // Watching for writability only while there is something to write keeps
+    // an idle subscriber from waking the main loop. If this replaces the
+    // source, what is returned for the old one no longer matters.
+    feed_subscriber_watch(subscriber, G_IO_IN | (feed_subscriber_pending(subscriber) ? G_IO_OUT : 0));
+    return G_SOURCE_CONTINUE;
+}
+
+/**
+ * @brief Main loop callback for the listening socket.
+ */
+static gboolean on_feed_accept(gint fd, GIOCondition condition, gpointer user_data) {
+    TaskFeed *feed = user_data;
+    int client_fd = accept(fd, NULL, NULL);
+    FeedSubscriber *subscriber;
+
+    if (client_fd < 0) {
+        return G_SOURCE_CONTINUE;
+    }
+    if (feed->subscribers->len >= FEED_MAX_SUBSCRIBERS) {
+        close(client_fd);
+        return G_SOURCE_CONTINUE;
+    }
+    fcntl(client_fd, F_SETFL, fcntl(client_fd, F_GETFL) | O_NONBLOCK);
+    subscriber = g_new0(FeedSubscriber, 1);
+    subscriber->feed = feed;
+    subscriber->fd = client_fd;
+    subscriber->request = g_string_new(NULL);
+    subscriber->output = g_string_sized_new(FEED_BATCH_BYTES + 4096);
+    g_ptr_array_add(feed->subscribers, subscriber);
+    feed_subscriber_watch(subscriber, G_IO_IN);
+    return G_SOURCE_CONTINUE;
+}
+
+static void feed_publish_change(TaskChange change, guint id, const Task *task, gpointer user_data) {
+    TaskFeed *feed = user_data;
+    GString *line = g_string_new(NULL);
+
+    if (change == TASK_CHANGE_REMOVED) {
+        g_string_printf(line, "%" G_GUINT64_FORMAT "\tremove\t%u\n", feed->next_seq, id);
+    } else {
+        feed_append_task(feed, line, feed->next_seq, change == TASK_CHANGE_ADDED ? "add" : "update", task);
+    }
+    feed_push(feed, g_string_free(line, FALSE));
+}
+
+/**
+ * @brief Store listener for the feed. Publishes an event for each task the
+ * commit added, removed or changed.
+ */
+static void on_feed_store_changed(TaskStore *store, guint position, guint removed, guint added,
+                                  gpointer user_data) {
+    TaskFeed *feed = user_data;
+    // Too many events would push the whole ring out; subscribers resync instead.
+    gboolean reset = removed + added > FEED_RING_EVENTS / 4;
+
+    task_stamps_update(feed->stamps, store, position, removed, added, reset ? NULL : feed_publish_change, feed);
+    if (reset) {
+        feed_push(feed, NULL);
+    }
+
+    for (guint k = 0; k < feed->subscribers->len; k++) {
+        FeedSubscriber *subscriber = g_ptr_array_index(feed->subscribers, k);
+        if (subscriber->started) {
+            feed_subscriber_watch(subscriber, G_IO_IN | G_IO_OUT);
+        }
+    }
+}
+
+/**
+ * @brief Binds the feed's socket, unless another process is serving it.
+ *
+ * @return The listening socket, or -1.
+ */
+static int feed_listen(void) {
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    gboolean bound;
+
+    if (fd < 0) {
+        g_warning("Could not create the change feed socket: %s", g_strerror(errno));
+        return -1;
+    }
+    g_strlcpy(address.sun_path, FEED_SOCKET, sizeof(address.sun_path));
+    bound = bind(fd, (struct sockaddr *)&address, sizeof(address)) == 0;
+    if (!bound && errno == EADDRINUSE) {
+        // A socket left behind by a crash refuses connections; a live one
+        // belongs to a running instance and is left alone.
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        gboolean live = probe >= 0 && connect(probe, (struct sockaddr *)&address, sizeof(address)) == 0;
+        if (probe >= 0) {
+            close(probe);
+        }
+        if (live) {
+            close(fd);
+            return -1;
+        }
+        unlink(FEED_SOCKET);
+        bound = bind(fd, (struct sockaddr *)&address, sizeof(address)) == 0;
+    }
+    if (!bound || listen(fd, 16) < 0) {
+        g_warning("Could not serve the change feed on %s: %s", FEED_SOCKET, g_strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Starts publishing a store's changes on FEED_SOCKET.
+ *
+ * @param store The loaded task store.
+ * @return The feed, or NULL if the socket could not be served.
+ */
+static TaskFeed *task_feed_new(TaskStore *store) {
+    int fd = feed_listen();
+    TaskFeed *feed;
+
+    if (fd < 0) {
+        return NULL;
+    }
+    feed = g_new0(TaskFeed, 1);
+    feed->store = store;
+    feed->listen_fd = fd;
+    feed->listen_source = g_unix_fd_add(fd, G_IO_IN, on_feed_accept, feed);
+    feed->stamps = g_array_sized_new(FALSE, FALSE, sizeof(TaskStamp), store->tasks->len);
+    task_stamps_init(feed->stamps, store);
+    feed->ring = g_new0(gchar *, FEED_RING_EVENTS);
+    feed->first_seq = feed->next_seq = g_get_real_time();
+    feed->subscribers = g_ptr_array_new_with_free_func((GDestroyNotify)feed_subscriber_free);
+    task_store_add_listener(store, on_feed_store_changed, feed);
+    return feed;
+}
+
+static void task_feed_free(TaskFeed *feed) {
+    task_store_remove_listener(feed->store, feed);
+    g_ptr_array_unref(feed->subscribers);
+    g_source_remove(feed->listen_source);
+    close(feed->listen_fd);
+    unlink(FEED_SOCKET);
+    for (guint64 seq = feed->first_seq; seq < feed->next_seq; seq++) {
+        g_free(feed->ring[seq % FEED_RING_EVENTS]);
+    }
+    g_free(feed->ring);
+    g_array_free(feed->stamps, TRUE);
+    g_free(feed);
+}
+
+// --- Shared Snapshot ---
+
+/*
+ * Companion processes, such as a status bar widget or a command-line query,
+ * can read the tasks from SHARED_DIR/project-tracker-UID-WORKSPACE.tasks
+ * without parsing anything; see store_instance_name(). The store's writer
+ * keeps that file up to date on every commit. The file is meant to be
+ * mapped read-only and holds, in native byte order:
+ *
+ *   SharedHeader                   at offset 0
+ *   SharedString[TASK_STATUS_MAX]  status names, at statuses_offset
+ *   SharedTask[task_capacity]      tasks in store order, at tasks_offset
+ *   heap                           NUL-terminated strings, at heap_offset
+ *
+ * Strings are given as an offset into the heap and a length. The header's
+ * sequence number is a seqlock: it is odd while the app writes, and changes
+ * on every write. A reader reads it, waits for it to be even, reads what it
+ * needs in place and then checks that it has not changed, or starts over:
+ *
+ *   do {
+ *       while ((seq = atomic_load(&header->sequence)) & 1) {}
+ *       ... read the tasks ...
+ *   } while (atomic_load(&header->sequence) != seq);
+ *
+ * When the tasks outgrow the file, a bigger one is renamed into its place
+ * and the old one gets "superseded" set; readers then open the name again.
+ */
+
+#define SHARED_DIR "/dev/shm"
+#define SHARED_MAGIC 0x4D535450  // "PTSM"
+#define SHARED_LAYOUT_VERSION 1
+// Smallest task table and string heap a file is created with.
+#define SHARED_MIN_TASKS 1024
+#define SHARED_MIN_HEAP (256 * 1024)
+
+typedef struct {
+    guint32 offset;          // Into the heap.
+    guint32 length;          // In bytes, without the NUL.
+} SharedString;
+
+typedef struct {
+    guint32 magic;
+    guint32 layout_version;
+    guint32 sequence;        // Seqlock; odd while the app is writing.
+    guint32 superseded;      // Nonzero once a new file has replaced this one.
+    guint64 generation;      // Commits published since the app started.
+    gint64 published_us;     // Wall-clock time of the last publish.
+    guint32 pid;             // The app's process.
+    guint32 n_tasks;
+    guint32 n_completed;
+    guint32 n_statuses;
+    guint32 task_capacity;
+    guint32 heap_capacity;
+    guint32 heap_used;
+    guint32 statuses_offset;
+    guint32 tasks_offset;
+    guint32 heap_offset;
+} SharedHeader;
+
+typedef struct {
+    guint32 id;
+    guint32 revision;        // Changes whenever the text does.
+    SharedString text;
+    guint32 due;             // Julian day, 0 if none.
+    guint32 start;           // Julian day, 0 if none.
+    guint8 is_completed;
+    guint8 status;           // Index into the status names.
+    guint8 priority;
+    guint8 reserved;
+} SharedTask;
+
+typedef struct {
+    TaskStore *store;
+    gchar *path;
+    int fd;
+    gsize size;
+    SharedHeader *header;    // The start of the mapping.
+    SharedString *statuses;
+    SharedTask *tasks;
+    gchar *heap;             // Strings are never freed; a rebuild drops the garbage.
+} SharedSnapshot;
+
+/**
+ * @brief Copies a string into the heap.
+ *
+ * @return FALSE if the heap is full.
+ */
+static gboolean shared_heap_add(SharedSnapshot *snapshot, const gchar *text, SharedString *string) {
+    gsize length = strlen(text);
+
+    if (length + 1 > snapshot->header->heap_capacity - snapshot->header->heap_used) {
+        return FALSE;
+    }
+    string->offset = snapshot->header->heap_used;
+    string->length = length;
+    memcpy(snapshot->heap + string->offset, text, length + 1);
+    snapshot->header->heap_used += length + 1;
+    return TRUE;
+}
+
+static void shared_task_set(SharedTask *shared, const Task *task) {
+    shared->id = task->id;
+    shared->revision = task->revision;
+    shared->due = task->due;
+    shared->start = task->start;
+    shared->is_completed = task->is_completed;
+    shared->status = task->status;
+    shared->priority = task->priority;
+}
+
+/**
+ * @brief Writes the whole store to a new file, with room to grow, and
+ * renames it over the current one.
+ *
+ * @return FALSE if the file could not be written.
+ */
+static gboolean shared_snapshot_rebuild(SharedSnapshot *snapshot) {
+    TaskStore *store = snapshot->store;
+    gsize text_bytes = 0;
+    guint32 n_completed = 0;
+
+    for (guint i = 0; i < store->statuses->len; i++) {
+        text_bytes += strlen(g_ptr_array_index(store->statuses, i)) + 1;
+    }
+    for (guint i = 0; i < store->tasks->len; i++) {
+        text_bytes += strlen(task_store_get(store, i)->text) + 1;
+    }
+    // Twice what is needed now, so that most commits fit in place.
+    gsize task_capacity = MAX(SHARED_MIN_TASKS, 2 * (gsize)store->tasks->len);
+    gsize heap_capacity = MAX(SHARED_MIN_HEAP, 2 * text_bytes);
+    gsize tasks_offset = sizeof(SharedHeader) + TASK_STATUS_MAX * sizeof(SharedString);
+    gsize heap_offset = tasks_offset + task_capacity * sizeof(SharedTask);
+    gsize size = heap_offset + heap_capacity;
+
+    if (size > G_MAXUINT32) {
+        g_warning("Too many tasks to share in '%s'.", snapshot->path);
+        return FALSE;
+    }
+
+    gchar *tmp_path = g_strconcat(snapshot->path, ".tmp", NULL);
+    // Task texts are private to the user.
+    int fd = open(tmp_path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    guchar *map = MAP_FAILED;
+
+    if (fd >= 0 && ftruncate(fd, size) == 0) {
+        map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (map == MAP_FAILED) {
+        g_warning("Could not write '%s': %s", tmp_path, g_strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+            unlink(tmp_path);
+        }
+        g_free(tmp_path);
+        return FALSE;
+    }
+
+    SharedSnapshot next = *snapshot;
+    next.fd = fd;
+    next.size = size;
+    next.header = (SharedHeader *)map;
+    next.statuses = (SharedString *)(map + sizeof(SharedHeader));
+    next.tasks = (SharedTask *)(map + tasks_offset);
+    next.heap = (gchar *)map + heap_offset;
+
+    // ftruncate() zeroed the file, so the sequence starts out even.
+    SharedHeader *header = next.header;
+    header->magic = SHARED_MAGIC;
+    header->layout_version = SHARED_LAYOUT_VERSION;
+    header->generation = snapshot->header ? snapshot->header->generation : 0;
+    header->pid = getpid();
+    header->task_capacity = task_capacity;
+    header->heap_capacity = heap_capacity;
+    header->statuses_offset = sizeof(SharedHeader);
+    header->tasks_offset = tasks_offset;
+    header->heap_offset = heap_offset;
+    for (guint i = 0; i < store->statuses->len; i++) {
+        shared_heap_add(&next, g_ptr_array_index(store->statuses, i), &next.statuses[i]);
+    }
+    header->n_statuses = store->statuses->len;
+    for (guint i = 0; i < store->tasks->len; i++) {
+        Task *task = task_store_get(store, i);
+        shared_task_set(&next.tasks[i], task);
+        shared_heap_add(&next, task->text, &next.tasks[i].text);
+        n_completed += task->is_completed;
+    }
+    header->n_tasks = store->tasks->len;
+    header->n_completed = n_completed;
+    header->published_us = g_get_real_time();
+
+    if (rename(tmp_path, snapshot->path) != 0) {
+        g_warning("Could not write '%s': %s", snapshot->path, g_strerror(errno));
+        munmap(map, size);
+        close(fd);
+        unlink(tmp_path);
+        g_free(tmp_path);
+        return FALSE;
+    }
+    g_free(tmp_path);
+
+    if (snapshot->header) {
+        // Tell readers of the old file to open the new one.
+        g_atomic_int_inc(&snapshot->header->sequence);
+        snapshot->header->superseded = 1;
+        g_atomic_int_inc(&snapshot->header->sequence);
+        munmap(snapshot->header, snapshot->size);
+        close(snapshot->fd);
+    }
+    *snapshot = next;
+    return TRUE;
+}
+
+/**
+ * @brief Returns the heap bytes a commit needs in place: the texts of the
+ * tasks in the changed range that are new, or whose text changed. Pairs
+ * the tasks up the same way on_shared_store_changed() does.
+ */
+static gsize shared_commit_heap_bytes(SharedSnapshot *snapshot, TaskStore *store, guint position, guint removed,
+                                      guint added) {
+    const SharedTask *old = snapshot->tasks + position;
+    gsize bytes = 0;
+    guint i = 0;
+
+    for (guint j = 0; j < added; j++) {
+        Task *task = task_store_get(store, position + j);
+        while (i < removed && old[i].id < task->id) {
+            i++;
+        }
+        gboolean kept = i < removed && old[i].id == task->id;
+        if (!kept || old[i].revision != task->revision) {
+            bytes += strlen(task->text) + 1;
+        }
+        i += kept;
+    }
+    return bytes;
+}
+
+/**
+ * @brief Store listener that publishes a commit in place.
  *
- * After compiling, you can run the program with:
- * ./project_tracker
+ * The tasks after the changed range only move in the task table; their
+ * strings stay where they are in the heap. Tasks in the range whose text
+ * is unchanged keep their strings too, so toggles write no strings at all.
+ * When the commit would not fit in the table or heap, or the statuses have
+ * changed, the file is rebuilt instead, before anything is written in
+ * place, so readers never see a half-written generation.
  */
+static void on_shared_store_changed(TaskStore *store, guint position, guint removed, guint added,
+                                    gpointer user_data) {
+    SharedSnapshot *snapshot = user_data;
+    SharedHeader *header = snapshot->header;
+    guint old_length = header->n_tasks;
+    guint tail = old_length - position - removed;
 
-#include <gtk/gtk.h>
-#include <string.h>
+    if (header->n_statuses != store->statuses->len || store->tasks->len > header->task_capacity ||
+        shared_commit_heap_bytes(snapshot, store, position, removed, added) >
+            header->heap_capacity - header->heap_used) {
+        // Leaves out the garbage, too.
+        shared_snapshot_rebuild(snapshot);
+        return;
+    }
 
-// --- Function Prototypes for better organization ---
-GtkWidget *create_list_item(const gchar *text, gboolean is_completed);
-void save_tasks_to_file(GtkWidget *list_box);
-void load_tasks_from_file(GtkWidget *list_box);
-static void on_add_button_clicked(GtkWidget *widget, gpointer user_data);
-static void on_remove_button_clicked(GtkWidget *widget, gpointer user_data);
-static void on_check_button_toggled(GtkWidget *widget, gpointer user_data);
-static void on_window_destroy(GtkWidget *widget, gpointer user_data);
-static void activate(GtkApplication *app, gpointer user_data);
+    SharedTask *old = g_new(SharedTask, MAX(removed, 1));
+    memcpy(old, snapshot->tasks + position, removed * sizeof(SharedTask));
+
+    g_atomic_int_inc(&header->sequence);
+    memmove(snapshot->tasks + position + added, snapshot->tasks + position + removed, tail * sizeof(SharedTask));
+
+    // Both ranges are in id order, so one walk pairs up the tasks they share.
+    guint i = 0, j = 0;
+    while (i < removed || j < added) {
+        Task *task = j < added ? task_store_get(store, position + j) : NULL;
+        SharedTask *shared;
+
+        if (!task || (i < removed && old[i].id < task->id)) {
+            header->n_completed -= old[i].is_completed;
+            i++;
+            continue;
+        }
+        shared = &snapshot->tasks[position + j];
+        if (i < removed && old[i].id == task->id) {
+            header->n_completed -= old[i].is_completed;
+            shared->text = old[i].text;
+            if (old[i].revision != task->revision) {
+                shared_heap_add(snapshot, task->text, &shared->text);
+            }
+            i++;
+        } else {
+            shared_heap_add(snapshot, task->text, &shared->text);
+        }
+        shared_task_set(shared, task);
+        header->n_completed += task->is_completed;
+        j++;
+    }
+    header->n_tasks = store->tasks->len;
+    header->generation++;
+    header->published_us = g_get_real_time();
+    g_atomic_int_inc(&header->sequence);
+    g_free(old);
+}
 
 /**
- * @brief Creates a new list item for the to-do list.
- *
- * This function creates a GtkListBoxRow containing a horizontal box with
- * a GtkCheckButton and a GtkLabel. It also applies a CSS class to the label
- * if the task is completed.
+ * @brief Publishes the store in SHARED_DIR and keeps it up to date.
  *
- * @param text The text for the to-do item.
- * @param is_completed TRUE if the task is completed, FALSE otherwise.
- * @return A pointer to the newly created GtkWidget (GtkListBoxRow).
+ * @param store A pointer to the TaskStore.
+ * @return The snapshot, or NULL if it could not be written.
  */
-GtkWidget *create_list_item(const gchar *text, gboolean is_completed) {
-    GtkWidget *row = gtk_list_box_row_new();
-    GtkWidget *hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 15); // Increased spacing
-    GtkWidget *check_button = gtk_check_button_new();
-    GtkWidget *label = gtk_label_new(text);
+static SharedSnapshot *shared_snapshot_new(TaskStore *store) {
+    SharedSnapshot *snapshot = g_new0(SharedSnapshot, 1);
+    gchar *name = store_instance_name();
 
-    gtk_container_add(GTK_CONTAINER(row), hbox);
-    gtk_box_pack_start(GTK_BOX(hbox), check_button, FALSE, FALSE, 0);
-    gtk_box_pack_start(GTK_BOX(hbox), label, TRUE, TRUE, 0);
+    snapshot->store = store;
+    snapshot->fd = -1;
+    snapshot->path = g_strdup_printf("%s/project-tracker-%u-%s.tasks", SHARED_DIR, (guint)getuid(), name);
+    g_free(name);
+    if (!shared_snapshot_rebuild(snapshot)) {
+        g_free(snapshot->path);
+        g_free(snapshot);
+        return NULL;
+    }
+    task_store_add_listener(store, on_shared_store_changed, snapshot);
+    return snapshot;
+}
 
-    // Set the check button state and connect the signal
-    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(check_button), is_completed);
-    g_signal_connect(check_button, "toggled", G_CALLBACK(on_check_button_toggled), label);
+static void shared_snapshot_free(SharedSnapshot *snapshot) {
+    task_store_remove_listener(snapshot->store, snapshot);
+    unlink(snapshot->path);
+    // Readers that still have it mapped see that it is gone.
+    g_atomic_int_inc(&snapshot->header->sequence);
+    snapshot->header->superseded = 1;
+    g_atomic_int_inc(&snapshot->header->sequence);
+    munmap(snapshot->header, snapshot->size);
+    close(snapshot->fd);
+    g_free(snapshot->path);
+    g_free(snapshot);
+}
 
-    // Apply the "completed" CSS class if the task is done
-    if (is_completed) {
-        GtkStyleContext *context = gtk_widget_get_style_context(label);
-        gtk_style_context_add_class(context, "completed");
-    }
+// --- Service Mode ---
 
-    return row;
+/*
+ * Started with --gapplication-service, the instance that owns the store
+ * stays running after its last window closes, with the tasks, indexes,
+ * change feed and shared snapshot all kept current. Starting the app
+ * again then only opens a window over the loaded store. A while after the
+ * last window has gone, the memory its widgets used is handed back to the
+ * system. SIGTERM or SIGINT closes the windows, which saves the tasks,
+ * and stops the service.
+ */
+
+// Seconds without a window before a resident instance trims its memory.
+#define SERVICE_TRIM_DELAY 30
+
+/**
+ * @brief Returns the heap that closed windows freed to the system.
+ */
+static gboolean on_service_trim(gpointer user_data) {
+    GApplication *app = user_data;
+
+    g_object_set_data(G_OBJECT(app), "trim_source", NULL);
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+    g_debug("Trimmed memory after %d s without a window.", SERVICE_TRIM_DELAY);
+    return G_SOURCE_REMOVE;
 }
 
 /**
- * @brief Saves all tasks from the list box to a file.
- *
- * This function iterates through each row in the list box, extracts the task text
- * and completion status, and writes it to "tasks.txt".
- *
- * @param list_box A pointer to the GtkListBox widget.
+ * @brief Cancels a pending trim.
  */
-void save_tasks_to_file(GtkWidget *list_box) {
-    FILE *file = fopen("tasks.txt", "w");
-    if (!file) {
-        g_warning("Could not open file 'tasks.txt' for writing.");
-        return;
+static void service_cancel_trim(GApplication *app) {
+    guint source = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(app), "trim_source"));
+
+    if (source) {
+        g_source_remove(source);
+        g_object_set_data(G_OBJECT(app), "trim_source", NULL);
     }
+}
 
-    GtkListBoxRow *row = gtk_list_box_get_row_at_index(GTK_LIST_BOX(list_box), 0);
-    while (row) {
-        GtkWidget *hbox = gtk_bin_get_child(GTK_BIN(row));
-        GtkWidget *check_button = gtk_container_get_children(GTK_CONTAINER(hbox))->data;
-        GtkWidget *label = g_list_nth_data(gtk_container_get_children(GTK_CONTAINER(hbox)), 1);
+static void on_service_window_added(GtkApplication *app, GtkWindow *window, gpointer user_data) {
+    service_cancel_trim(G_APPLICATION(app));
+}
 
-        gboolean is_completed = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(check_button));
-        const gchar *text = gtk_label_get_text(GTK_LABEL(label));
+/**
+ * @brief Schedules a trim once the last window is gone.
+ */
+static void on_service_window_removed(GtkApplication *app, GtkWindow *window, gpointer user_data) {
+    if (gtk_application_get_windows(app) == NULL) {
+        service_cancel_trim(G_APPLICATION(app));
+        guint source = g_timeout_add_seconds(SERVICE_TRIM_DELAY, on_service_trim, app);
+        g_object_set_data(G_OBJECT(app), "trim_source", GUINT_TO_POINTER(source));
+    }
+}
 
-        fprintf(file, "%d;%s\n", is_completed, text);
+/**
+ * @brief Stops the service on SIGTERM or SIGINT. The windows are closed
+ * first, so each saves as it would when closed by hand.
+ */
+static gboolean on_service_stop(gpointer user_data) {
+    GtkApplication *app = user_data;
+    GList *windows;
 
-        row = gtk_list_box_get_row_at_index(GTK_LIST_BOX(list_box), gtk_list_box_row_get_index(row) + 1);
+    if (g_object_get_data(G_OBJECT(app), "service_stopping")) {
+        return G_SOURCE_REMOVE;
     }
+    g_object_set_data(G_OBJECT(app), "service_stopping", GINT_TO_POINTER(TRUE));
 
-    fclose(file);
+    windows = g_list_copy(gtk_application_get_windows(app));
+    for (GList *l = windows; l != NULL; l = l->next) {
+        gtk_widget_destroy(GTK_WIDGET(l->data));
+    }
+    g_list_free(windows);
+    service_cancel_trim(G_APPLICATION(app));
+    g_application_release(G_APPLICATION(app));
+    return G_SOURCE_REMOVE;
 }
 
 /**
- * @brief Loads tasks from a file and populates the list box.
+ * @brief Keeps the application running without windows until it is told
+ * to stop.
  *
- * This function reads "tasks.txt" line by line, parses the completion status and
- * task text, and adds a new item to the list box for each task.
+ * @param app A pointer to the GtkApplication instance.
+ */
+static void service_start(GtkApplication *app) {
+    g_application_hold(G_APPLICATION(app));
+    g_signal_connect(app, "window-added", G_CALLBACK(on_service_window_added), NULL);
+    g_signal_connect(app, "window-removed", G_CALLBACK(on_service_window_removed), NULL);
+    g_unix_signal_add(SIGTERM, on_service_stop, app);
+    g_unix_signal_add(SIGINT, on_service_stop, app);
+    g_print("Running as a service; start the app again to open a window.\n");
+}
+
+// --- Benchmark ---
+
+/*
+ * Started with --benchmark, the app opens the store, inverts every task
+ * twice, saves and exits without a window, printing how long each step
+ * took on one line. The backend, key and load threads come from the usual
+ * environment variables, so benchmark.sh can compare them on one list.
+ */
+
+/**
+ * @brief Runs the benchmark on the store and prints its timings.
  *
- * @param list_box A pointer to the GtkListBox widget.
+ * @param store A pointer to the TaskStore.
+ * @return The exit status of the program.
  */
-void load_tasks_from_file(GtkWidget *list_box) {
-    FILE *file = fopen("tasks.txt", "r");
-    if (!file) {
-        g_print("No 'tasks.txt' found. Starting with an empty list.\n");
-        return;
+static gint run_benchmark(TaskStore *store) {
+    gint64 start_time, load_us, edit_us, save_us;
+    const gchar *backend;
+    guint n_tasks;
+
+    store_enter_data_dir(store);
+    start_time = g_get_monotonic_time();
+    task_store_open(store);
+    load_us = g_get_monotonic_time() - start_time;
+    if (store->read_only) {
+        g_printerr("The tasks are open in another instance; not benchmarking.\n");
+        return EXIT_FAILURE;
     }
 
-    char line[1024];
-    while (fgets(line, sizeof(line), file) != NULL) {
-        gboolean is_completed = FALSE;
-        const gchar *text = NULL;
+    // Twice, so the tasks end up as they started and runs can be repeated.
+    start_time = g_get_monotonic_time();
+    task_store_invert_all(store);
+    task_store_invert_all(store);
+    edit_us = g_get_monotonic_time() - start_time;
 
-        // Parse the line format: "completion_status;task_text"
-        char *semicolon_pos = strchr(line, ';');
-        if (semicolon_pos) {
-            *semicolon_pos = '\0';
-            is_completed = (atoi(line) == 1);
-            text = semicolon_pos + 1;
-        } else {
-            text = line;
-        }
+    // Closing waits for the writer, so this counts everything reaching the disk.
+    start_time = g_get_monotonic_time();
+    if (store->backend->save) {
+        store->backend->save(store);
+    }
+    backend = store->backend->name;
+    n_tasks = store->tasks->len;
+    store->backend->close(store);
+    store->backend = NULL;
+    save_us = g_get_monotonic_time() - start_time;
 
-        // Remove the newline character
-        gchar *newline_pos = strchr(text, '\n');
-        if (newline_pos) {
-            *newline_pos = '\0';
-        }
+    g_print("backend=%s encrypted=%s tasks=%u load_us=%" G_GINT64_FORMAT " edit_us=%" G_GINT64_FORMAT
+            " save_us=%" G_GINT64_FORMAT "\n",
+            backend, g_getenv("PROJECT_TRACKER_KEY_FILE") ? "yes" : "no", n_tasks, load_us, edit_us, save_us);
+    return EXIT_SUCCESS;
+}
 
-        GtkWidget *list_item = create_list_item(text, is_completed);
-        gtk_container_add(GTK_CONTAINER(list_box), list_item);
+/**
+ * @brief Callback for "handle-local-options". Runs --benchmark instead of
+ * starting the app.
+ */
+static gint on_handle_local_options(GApplication *app, GVariantDict *options, gpointer user_data) {
+    if (g_variant_dict_contains(options, "benchmark")) {
+        return run_benchmark(user_data);
     }
-    gtk_widget_show_all(list_box);
-    fclose(file);
+    // Carry on starting the app.
+    return -1;
 }
 
+// --- Callbacks ---
+
 /**
  * @brief Callback function to add a new task to the list.
  *
  * This function is connected to a button click and an entry "activate" signal.
- * It reads the text from the entry, creates a new list item, adds it to the
- * GtkListBox, and then clears the entry field.
+ * It reads the text from the entry, appends a task to the store (which adds
+ * the row to the task list), and then clears the entry field. A text that
+ * looks like a duplicate is flagged instead the first time.
  *
  * @param widget A pointer to the GtkWidget that triggered the event.
  * @param user_data A pointer to the GtkApplicationWindow instance.
@@ -159,68 +11754,226 @@ void load_tasks_from_file(GtkWidget *list_box) {
 static void on_add_button_clicked(GtkWidget *widget, gpointer user_data) {
     GtkWidget *window = GTK_WIDGET(user_data);
     GtkWidget *entry = g_object_get_data(G_OBJECT(window), "entry");
-    GtkWidget *list_box = g_object_get_data(G_OBJECT(window), "list_box");
+    TaskStore *store = g_object_get_data(G_OBJECT(window), "store");
 
     const gchar *text = gtk_entry_get_text(GTK_ENTRY(entry));
     if (text && strlen(text) > 0) {
-        GtkWidget *list_item = create_list_item(text, FALSE);
-        gtk_container_add(GTK_CONTAINER(list_box), list_item);
-        gtk_widget_show_all(list_item);
+        if (duplicate_check_entry(window, text)) {
+            return;
+        }
+        task_store_append(store, text, FALSE);
         gtk_entry_set_text(GTK_ENTRY(entry), "");
-        save_tasks_to_file(list_box);
     }
 }
 
 /**
  * @brief Callback function to remove selected tasks from the list.
  *
- * This function iterates through all selected rows in the GtkListBox and
- * removes them.
+ * This function collects the positions of all selected tasks in the view,
+ * or in the board's columns while the board is shown, and removes them in
+ * one transaction.
  *
  * @param widget A pointer to the GtkWidget that triggered the event (the button).
  * @param user_data A pointer to the GtkApplicationWindow instance.
  */
 static void on_remove_button_clicked(GtkWidget *widget, gpointer user_data) {
     GtkWidget *window = GTK_WIDGET(user_data);
-    GtkWidget *list_box = g_object_get_data(G_OBJECT(window), "list_box");
+    TaskListView *view = g_object_get_data(G_OBJECT(window), "view");
+    TaskStore *store = g_object_get_data(G_OBJECT(window), "store");
+    GtkStack *stack = g_object_get_data(G_OBJECT(window), "stack");
+    guint n_positions;
+    guint *positions;
 
-    // Get a list of selected rows. GList is a singly-linked list.
-    GList *selected_rows = gtk_list_box_get_selected_rows(GTK_LIST_BOX(list_box));
-
-    if (selected_rows) {
-        GList *iter;
-        for (iter = selected_rows; iter != NULL; iter = g_list_next(iter)) {
-            GtkWidget *row = GTK_WIDGET(iter->data);
-            gtk_container_remove(GTK_CONTAINER(list_box), row);
-        }
-        g_list_free(selected_rows);
-        save_tasks_to_file(list_box);
+    if (g_strcmp0(gtk_stack_get_visible_child_name(stack), "board") == 0) {
+        positions = task_board_take_selected_positions(g_object_get_data(G_OBJECT(window), "board"), &n_positions);
+    } else {
+        positions = task_list_view_get_selected_positions(view, &n_positions);
+        g_hash_table_remove_all(view->selected);
     }
+    task_store_remove(store, positions, n_positions);
+    g_free(positions);
 }
 
 /**
  * @brief Callback function for the check button toggled event.
  *
- * This function adds or removes the "completed" CSS class from the task's label
- * to apply the strikethrough effect. It also saves the list to the file.
+ * This function records the new completion status in the store. The store
+ * notifies the view, which adds or removes the "completed" CSS class from
+ * the task's label to apply the strikethrough effect.
  *
  * @param widget A pointer to the GtkCheckButton that was toggled.
- * @param user_data A pointer to the GtkLabel widget associated with the task.
+ * @param user_data A pointer to the row containing the button.
  */
 static void on_check_button_toggled(GtkWidget *widget, gpointer user_data) {
-    GtkWidget *label = GTK_WIDGET(user_data);
-    GtkStyleContext *context = gtk_widget_get_style_context(label);
+    GtkWidget *row = GTK_WIDGET(user_data);
+    TaskListView *view = g_object_get_data(G_OBJECT(row), "view");
+    guint position = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(row), "position"));
 
-    if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget))) {
-        gtk_style_context_add_class(context, "completed");
-    } else {
-        gtk_style_context_remove_class(context, "completed");
+    if (view && position < view->store->tasks->len) {
+        task_store_set_completed(view->store, position, gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget)));
+    }
+}
+
+/**
+ * @brief Action handler for "win.select-all".
+ */
+static void on_select_all_action(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    task_list_view_select_all(g_object_get_data(G_OBJECT(user_data), "view"));
+}
+
+/**
+ * @brief Action handler for "win.complete-all".
+ */
+static void on_complete_all_action(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    task_store_complete_all(g_object_get_data(G_OBJECT(user_data), "store"));
+}
+
+/**
+ * @brief Action handler for "win.invert".
+ */
+static void on_invert_action(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    task_store_invert_all(g_object_get_data(G_OBJECT(user_data), "store"));
+}
+
+/**
+ * @brief Action handler for "win.delete-completed".
+ */
+static void on_delete_completed_action(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    task_store_delete_completed(g_object_get_data(G_OBJECT(user_data), "store"));
+}
+
+/**
+ * @brief Action handler for "win.find". Moves the focus to the filter bar.
+ */
+static void on_find_action(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    gtk_widget_grab_focus(g_object_get_data(G_OBJECT(user_data), "filter_entry"));
+}
+
+/**
+ * @brief Action handler for "win.go-to-task". Asks for a task number,
+ * counting the tasks the list shows from 1, and jumps to that task.
+ */
+static void on_go_to_task_action(GSimpleAction *action, GVariant *parameter, gpointer user_data) {
+    GtkWidget *window = user_data;
+    TaskListView *view = g_object_get_data(G_OBJECT(window), "view");
+    guint n_tasks = task_list_view_get_n_tasks(view);
+    GtkWidget *dialog;
+    GtkWidget *number_entry;
+    gchar *placeholder;
+
+    if (n_tasks == 0) {
+        gtk_widget_error_bell(window);
+        return;
+    }
+
+    dialog = gtk_dialog_new_with_buttons("Go to Task", GTK_WINDOW(window),
+                                         GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+                                         "_Cancel", GTK_RESPONSE_CANCEL, "_Go", GTK_RESPONSE_ACCEPT, NULL);
+    gtk_dialog_set_default_response(GTK_DIALOG(dialog), GTK_RESPONSE_ACCEPT);
+    number_entry = gtk_entry_new();
+    placeholder = g_strdup_printf("Task number, 1 to %u", n_tasks);
+    gtk_entry_set_placeholder_text(GTK_ENTRY(number_entry), placeholder);
+    gtk_entry_set_activates_default(GTK_ENTRY(number_entry), TRUE);
+    gtk_container_add(GTK_CONTAINER(gtk_dialog_get_content_area(GTK_DIALOG(dialog))), number_entry);
+    gtk_widget_show_all(dialog);
+    g_free(placeholder);
+
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+        gchar *text = g_strstrip(g_strdup(gtk_entry_get_text(GTK_ENTRY(number_entry))));
+        guint64 number;
+        // The list may have changed while the dialog was open.
+        if (g_ascii_string_to_unsigned(text + (*text == '#'), 10, 1, task_list_view_get_n_tasks(view),
+                                       &number, NULL)) {
+            gtk_stack_set_visible_child_name(GTK_STACK(g_object_get_data(G_OBJECT(window), "stack")), "list");
+            task_list_view_scroll_to(view, task_list_view_get_nth_task(view, number - 1));
+        } else {
+            gtk_widget_error_bell(window);
+        }
+        g_free(text);
+    }
+    gtk_widget_destroy(dialog);
+}
+
+/**
+ * @brief Callback for the filter bar's "search-changed" signal.
+ *
+ * A query that does not parse marks the bar as an error and leaves the
+ * previous filter in place.
+ *
+ * @param widget The GtkSearchEntry.
+ * @param user_data A pointer to the main window.
+ */
+static void on_filter_changed(GtkWidget *widget, gpointer user_data) {
+    TaskListView *view = g_object_get_data(G_OBJECT(user_data), "view");
+    GtkStyleContext *context = gtk_widget_get_style_context(widget);
+    const gchar *text = gtk_entry_get_text(GTK_ENTRY(widget));
+    GError *error = NULL;
+    Query *query = NULL;
+
+    if (view->filter ? g_strcmp0(text, view->filter->query->source) == 0 : *text == '\0') {
+        // Already shown, e.g. after switching to a saved view.
+        gtk_style_context_remove_class(context, "error");
+        gtk_widget_set_tooltip_text(widget, NULL);
+        return;
+    }
+    if (*text) {
+        query = query_compile(text, &error);
+        if (!query) {
+            gtk_style_context_add_class(context, "error");
+            gtk_widget_set_tooltip_text(widget, error->message);
+            g_error_free(error);
+            return;
+        }
     }
+    gtk_style_context_remove_class(context, "error");
+    gtk_widget_set_tooltip_text(widget, NULL);
+    task_list_view_set_filter(view, query ? query_result_new(view->store, query) : NULL, TRUE);
+    refresh_view_combo(user_data);
+}
+
+/**
+ * @brief Callback for the filter bar's "stop-search" signal (Escape).
+ */
+static void on_filter_stop(GtkWidget *widget, gpointer user_data) {
+    gtk_entry_set_text(GTK_ENTRY(widget), "");
+}
+
+/**
+ * @brief Callback for the "Group by" combo's "changed" signal. The entries
+ * are in TaskGroupBy order.
+ */
+static void on_group_by_changed(GtkComboBox *combo, gpointer user_data) {
+    TaskListView *view = g_object_get_data(G_OBJECT(user_data), "view");
+    gint active = gtk_combo_box_get_active(combo);
+
+    task_list_view_set_group_by(view, active > 0 ? (TaskGroupBy)active : TASK_GROUP_NONE);
+}
+
+/**
+ * @brief Shows how many of the store's tasks are done, read straight off
+ * the store's columns.
+ */
+static void progress_label_update(GtkWidget *label, TaskStore *store) {
+    gchar *text;
+
+    // "%'u" groups the digits the way the user's locale does.
+    text = g_strdup_printf("%'u of %'u done", store->columns.n_done, store->tasks->len);
+    gtk_label_set_text(GTK_LABEL(label), text);
+    g_free(text);
+}
+
+/**
+ * @brief Store listener that keeps the progress label current. The count
+ * is maintained by the commit itself, so this costs the same for one
+ * toggle as for any other edit.
+ */
+static void on_progress_store_changed(TaskStore *store, guint position, guint removed, guint added,
+                                      gpointer user_data) {
+    progress_label_update(GTK_WIDGET(user_data), store);
+}
 
-    // Since a change occurred, save the list
-    GtkWidget *row = gtk_widget_get_parent(gtk_widget_get_parent(widget));
-    GtkWidget *list_box = gtk_widget_get_parent(row);
-    save_tasks_to_file(list_box);
+static void on_progress_label_destroy(GtkWidget *widget, gpointer user_data) {
+    task_store_remove_listener(user_data, widget);
 }
 
 /**
@@ -229,30 +11982,23 @@ static void on_check_button_toggled(GtkWidget *widget, gpointer user_data) {
  * This is a good place to perform final data saving before the application exits.
  *
  * @param widget The GtkWindow that is being destroyed.
- * @param user_data A pointer to the GtkListBox.
+ * @param user_data A pointer to the TaskStore.
  */
 static void on_window_destroy(GtkWidget *widget, gpointer user_data) {
-    GtkWidget *list_box = GTK_WIDGET(user_data);
-    save_tasks_to_file(list_box);
+    TaskStore *store = user_data;
+    import_cancel(widget);
+    duplicate_report_cancel(widget);
+    report_cancel(widget);
+    if (store->backend->save && !store->read_only) {
+        store->backend->save(store);
+    }
 }
 
 /**
- * @brief The main application entry point.
- *
- * @param app A pointer to the GtkApplication instance.
- * @param data A pointer to any data passed to the callback (in this case, NULL).
+ * @brief Installs the stylesheet for every window of the process. Called
+ * once from startup, so opening a window does not parse it again.
  */
-static void activate(GtkApplication *app, gpointer data) {
-    GtkWidget *window;
-    GtkWidget *vbox;
-    GtkWidget *scroll_window;
-    GtkWidget *list_box;
-    GtkWidget *hbox_entry;
-    GtkWidget *entry;
-    GtkWidget *add_button;
-    GtkWidget *remove_button;
-
-    // --- Add CSS Styling ---
+static void load_stylesheet(void) {
     // The CSS is embedded directly in the C code for a self-contained example.
     const gchar *css =
         "window {"
@@ -274,6 +12020,9 @@ static void activate(GtkApplication *app, gpointer data) {
         "button:hover {"
         "  background-color: #2563eb;"
         "}"
+        "headerbar button {"
+        "  padding: 6px 12px;"
+        "}"
         "entry {"
         "  border-radius: 8px;"
         "  padding: 12px;"
@@ -282,17 +12031,52 @@ static void activate(GtkApplication *app, gpointer data) {
         "  background-color: #ffffff;"
         "  color: #1f2937;"
         "}"
-        "listbox {"
+        "entry.error {"
+        "  border-color: #ef4444;"
+        "}"
+        "entry.warning {"
+        "  border-color: #f59e0b;"
+        "}"
+        "label.duplicate-hint {"
+        "  font-size: 14px;"
+        "  color: #b45309;"
+        "}"
+        "label.progress {"
+        "  font-size: 14px;"
+        "  color: #4b5563;"
+        "}"
+        "label.board-column-title {"
+        "  font-weight: bold;"
+        "  color: #4b5563;"
+        "}"
+        "label.calendar-title {"
+        "  font-size: 18px;"
+        "  font-weight: bold;"
+        "  color: #1f2937;"
+        "}"
+        ".task-list {"
         "  background-color: #ffffff;"
         "  border-radius: 8px;"
         "  box-shadow: 0 2px 4px rgba(0, 0, 0, 0.05);"
         "}"
-        "listboxrow {"
+        ".task-row {"
         "  padding: 15px 12px;"
         "  border-bottom: 1px solid #e5e7eb;"
         "}"
-        "listboxrow:last-child {"
-        "  border-bottom: none;"
+        ".task-row.selected {"
+        "  background-color: #dbeafe;"
+        "}"
+        ".group-header {"
+        "  padding: 8px 12px;"
+        "  background-color: #eef2f7;"
+        "  border-bottom: 1px solid #e5e7eb;"
+        "}"
+        ".group-header label {"
+        "  font-weight: bold;"
+        "  color: #4b5563;"
+        "}"
+        ".task-row entry {"
+        "  padding: 0 8px;"
         "}"
         "label {"
         "  font-size: 18px;"
@@ -308,6 +12092,90 @@ static void activate(GtkApplication *app, gpointer data) {
     gtk_css_provider_load_from_data(provider, css, -1, NULL);
     gtk_style_context_add_provider_for_screen(gdk_screen_get_default(), GTK_STYLE_PROVIDER(provider), GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
     g_object_unref(provider);
+}
+
+/**
+ * @brief Callback for the application's "startup" signal.
+ *
+ * Loads the task list and the stylesheet once per process, before the
+ * first window is shown.
+ *
+ * @param app A pointer to the GtkApplication instance.
+ * @param user_data A pointer to the TaskStore.
+ */
+static void startup(GtkApplication *app, gpointer user_data) {
+    TaskStore *store = user_data;
+
+    // --- Load existing tasks ---
+    store_enter_data_dir(store);
+    task_store_open(store);
+    load_stylesheet();
+
+    // Saved views are shared by all windows and kept current from here on.
+    GPtrArray *views = g_ptr_array_new_with_free_func(saved_view_free);
+    load_saved_views(views, store);
+    g_object_set_data_full(G_OBJECT(app), "saved_views", views, (GDestroyNotify)g_ptr_array_unref);
+
+    // Built in the background; the entries suggest nothing until it is ready.
+    g_object_set_data(G_OBJECT(app), "completion_index", completion_index_new(store));
+    g_object_set_data(G_OBJECT(app), "duplicate_index", duplicate_index_new(store));
+    g_object_set_data_full(G_OBJECT(app), "span_index", span_index_new(store), (GDestroyNotify)span_index_free);
+    if (!store->read_only) {
+        // Companion processes get the tasks from the store's writer.
+        g_object_set_data_full(G_OBJECT(app), "feed", task_feed_new(store), (GDestroyNotify)task_feed_free);
+        g_object_set_data_full(G_OBJECT(app), "shared_snapshot", shared_snapshot_new(store),
+                               (GDestroyNotify)shared_snapshot_free);
+    }
+
+    static const gchar *select_all_accels[] = { "<Primary><Shift>a", NULL };
+    static const gchar *complete_all_accels[] = { "<Primary><Shift>Return", NULL };
+    static const gchar *invert_accels[] = { "<Primary>i", NULL };
+    static const gchar *delete_completed_accels[] = { "<Primary><Shift>Delete", NULL };
+    static const gchar *find_accels[] = { "<Primary>f", NULL };
+    static const gchar *go_to_task_accels[] = { "<Primary>g", NULL };
+    gtk_application_set_accels_for_action(app, "win.select-all", select_all_accels);
+    gtk_application_set_accels_for_action(app, "win.complete-all", complete_all_accels);
+    gtk_application_set_accels_for_action(app, "win.invert", invert_accels);
+    gtk_application_set_accels_for_action(app, "win.delete-completed", delete_completed_accels);
+    gtk_application_set_accels_for_action(app, "win.find", find_accels);
+    gtk_application_set_accels_for_action(app, "win.go-to-task", go_to_task_accels);
+
+    if (g_application_get_flags(G_APPLICATION(app)) & G_APPLICATION_IS_SERVICE) {
+        service_start(app);
+    }
+}
+
+/**
+ * @brief The main application entry point.
+ *
+ * @param app A pointer to the GtkApplication instance.
+ * @param data A pointer to the TaskStore shared by all windows.
+ */
+static void activate(GtkApplication *app, gpointer data) {
+    TaskStore *store = data;
+    GtkWidget *window;
+    GtkWidget *header_bar;
+    GtkWidget *menu_button;
+    GtkWidget *vbox;
+    GtkWidget *stack;
+    GtkWidget *stack_switcher;
+    GtkWidget *list_page;
+    GtkWidget *board_page;
+    TimelineView *timeline;
+    CalendarView *calendar;
+    GtkWidget *filter_entry;
+    GtkWidget *group_combo;
+    GtkWidget *view_combo;
+    TaskListView *view;
+    TaskBoard *board;
+    GtkWidget *hbox_entry;
+    GtkWidget *entry;
+    GtkEntryCompletion *completion;
+    GtkListStore *completion_model;
+    GtkWidget *add_button;
+    GtkWidget *duplicate_label;
+    GtkWidget *remove_button;
+    GtkWidget *progress_label;
 
     // --- UI Setup ---
     window = gtk_application_window_new(app);
@@ -316,16 +12184,118 @@ static void activate(GtkApplication *app, gpointer data) {
     // Removed the line below to prevent the runtime warning about a missing icon file.
     // gtk_window_set_icon_from_file(GTK_WINDOW(window), "todo_icon.png", NULL);
 
+    // --- Bulk Actions ---
+    // Each of these runs as a single store transaction.
+    static const GActionEntry win_entries[] = {
+        { "select-all", on_select_all_action, NULL, NULL, NULL },
+        { "complete-all", on_complete_all_action, NULL, NULL, NULL },
+        { "invert", on_invert_action, NULL, NULL, NULL },
+        { "delete-completed", on_delete_completed_action, NULL, NULL, NULL },
+        { "find", on_find_action, NULL, NULL, NULL },
+        { "go-to-task", on_go_to_task_action, NULL, NULL, NULL },
+        { "save-view", on_save_view_action, NULL, NULL, NULL },
+        { "delete-view", on_delete_view_action, NULL, NULL, NULL },
+        { "find-duplicates", on_find_duplicates_action, NULL, NULL, NULL },
+        { "add-status", on_add_status_action, NULL, NULL, NULL },
+        { "export-report", on_export_report_action, NULL, NULL, NULL },
+    };
+    g_action_map_add_action_entries(G_ACTION_MAP(window), win_entries, G_N_ELEMENTS(win_entries), window);
+
+    GMenu *menu = g_menu_new();
+    g_menu_append(menu, "Select All", "win.select-all");
+    g_menu_append(menu, "Complete All", "win.complete-all");
+    g_menu_append(menu, "Invert Completion", "win.invert");
+    g_menu_append(menu, "Delete Completed", "win.delete-completed");
+    g_menu_append(menu, "Go to Task...", "win.go-to-task");
+    g_menu_append(menu, "Save View...", "win.save-view");
+    g_menu_append(menu, "Delete View", "win.delete-view");
+    g_menu_append(menu, "Find Duplicates", "win.find-duplicates");
+    g_menu_append(menu, "Add Board Column...", "win.add-status");
+    g_menu_append(menu, "Export Report...", "win.export-report");
+
+    header_bar = gtk_header_bar_new();
+    gtk_header_bar_set_title(GTK_HEADER_BAR(header_bar), "Project Tracker");
+    if (g_strcmp0(store_workspace(), DEFAULT_WORKSPACE) != 0 || store->read_only) {
+        gchar *subtitle = g_strdup_printf("%s%s", store_workspace(), store->read_only ? " (read-only)" : "");
+        gtk_header_bar_set_subtitle(GTK_HEADER_BAR(header_bar), subtitle);
+        g_free(subtitle);
+    }
+    gtk_header_bar_set_show_close_button(GTK_HEADER_BAR(header_bar), TRUE);
+    gtk_window_set_titlebar(GTK_WINDOW(window), header_bar);
+
+    menu_button = gtk_menu_button_new();
+    gtk_menu_button_set_menu_model(GTK_MENU_BUTTON(menu_button), G_MENU_MODEL(menu));
+    gtk_header_bar_pack_end(GTK_HEADER_BAR(header_bar), menu_button);
+    g_object_unref(menu);
+
+    progress_label = gtk_label_new(NULL);
+    gtk_style_context_add_class(gtk_widget_get_style_context(progress_label), "progress");
+    gtk_header_bar_pack_end(GTK_HEADER_BAR(header_bar), progress_label);
+    progress_label_update(progress_label, store);
+    task_store_add_listener(store, on_progress_store_changed, progress_label);
+    g_signal_connect(progress_label, "destroy", G_CALLBACK(on_progress_label_destroy), store);
+
+    view_combo = gtk_combo_box_text_new();
+    gtk_widget_set_tooltip_text(view_combo, "Saved views");
+    gtk_header_bar_pack_start(GTK_HEADER_BAR(header_bar), view_combo);
+
     vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 15); // Increased spacing
     gtk_container_set_border_width(GTK_CONTAINER(vbox), 20); // Increased border width
     gtk_container_add(GTK_CONTAINER(window), vbox);
 
-    scroll_window = gtk_scrolled_window_new(NULL, NULL);
-    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scroll_window), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
-    gtk_box_pack_start(GTK_BOX(vbox), scroll_window, TRUE, TRUE, 0);
+    if (store->read_only) {
+        GtkWidget *info_bar = gtk_info_bar_new();
+        gint holder = store_lock_holder();
+        gchar *message = holder > 0 ? g_strdup_printf("These tasks are open in another Project Tracker (process %d). "
+                                                      "Changes made here are not saved.", holder)
+                                    : g_strdup("These tasks are open in another Project Tracker. "
+                                               "Changes made here are not saved.");
+        GtkWidget *info_label = gtk_label_new(message);
+        gtk_label_set_line_wrap(GTK_LABEL(info_label), TRUE);
+        gtk_info_bar_set_message_type(GTK_INFO_BAR(info_bar), GTK_MESSAGE_WARNING);
+        gtk_container_add(GTK_CONTAINER(gtk_info_bar_get_content_area(GTK_INFO_BAR(info_bar))), info_label);
+        gtk_box_pack_start(GTK_BOX(vbox), info_bar, FALSE, FALSE, 0);
+        g_free(message);
+    }
+
+    // The list, board, timeline and calendar are pages over the same store.
+    stack = gtk_stack_new();
+    gtk_box_pack_start(GTK_BOX(vbox), stack, TRUE, TRUE, 0);
+    stack_switcher = gtk_stack_switcher_new();
+    gtk_stack_switcher_set_stack(GTK_STACK_SWITCHER(stack_switcher), GTK_STACK(stack));
+    gtk_header_bar_set_custom_title(GTK_HEADER_BAR(header_bar), stack_switcher);
+
+    list_page = gtk_box_new(GTK_ORIENTATION_VERTICAL, 15);
+    gtk_stack_add_titled(GTK_STACK(stack), list_page, "list", "List");
+    board_page = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+    gtk_stack_add_titled(GTK_STACK(stack), board_page, "board", "Board");
+    timeline = timeline_view_new(g_object_get_data(G_OBJECT(app), "span_index"));
+    gtk_stack_add_titled(GTK_STACK(stack), timeline->area, "timeline", "Timeline");
+    calendar = calendar_view_new(g_object_get_data(G_OBJECT(app), "span_index"));
+    gtk_stack_add_titled(GTK_STACK(stack), calendar->widget, "calendar", "Calendar");
+
+    GtkWidget *hbox_filter = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
+    gtk_box_pack_start(GTK_BOX(list_page), hbox_filter, FALSE, FALSE, 0);
+
+    filter_entry = gtk_search_entry_new();
+    gtk_entry_set_placeholder_text(GTK_ENTRY(filter_entry), "Filter, e.g. !done and #infra and due<7d");
+    gtk_box_pack_start(GTK_BOX(hbox_filter), filter_entry, TRUE, TRUE, 0);
+
+    // In TaskGroupBy order.
+    group_combo = gtk_combo_box_text_new();
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(group_combo), "No Grouping");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(group_combo), "By Project");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(group_combo), "By Due Date");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(group_combo), "By Completion");
+    gtk_combo_box_set_active(GTK_COMBO_BOX(group_combo), TASK_GROUP_NONE);
+    gtk_widget_set_tooltip_text(group_combo, "Group tasks");
+    gtk_box_pack_start(GTK_BOX(hbox_filter), group_combo, FALSE, FALSE, 0);
 
-    list_box = gtk_list_box_new();
-    gtk_container_add(GTK_CONTAINER(scroll_window), list_box);
+    view = task_list_view_new(store, list_page);
+    gtk_drag_dest_set(view->layout, GTK_DEST_DEFAULT_ALL, NULL, 0, GDK_ACTION_COPY);
+    gtk_drag_dest_add_text_targets(view->layout);
+
+    board = task_board_new(store, board_page);
 
     hbox_entry = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
     gtk_box_pack_start(GTK_BOX(vbox), hbox_entry, FALSE, FALSE, 0);
@@ -334,24 +12304,61 @@ static void activate(GtkApplication *app, gpointer data) {
     gtk_entry_set_placeholder_text(GTK_ENTRY(entry), "Add a new task...");
     gtk_box_pack_start(GTK_BOX(hbox_entry), entry, TRUE, TRUE, 0);
 
+    // The completion's model only ever holds the current suggestions, filled
+    // from the shared index by on_entry_changed_complete(). That handler is
+    // connected before the completion so the model is ready when it looks.
+    completion = gtk_entry_completion_new();
+    completion_model = gtk_list_store_new(1, G_TYPE_STRING);
+    gtk_entry_completion_set_model(completion, GTK_TREE_MODEL(completion_model));
+    gtk_entry_completion_set_text_column(completion, 0);
+    gtk_entry_completion_set_match_func(completion, completion_match_all, NULL, NULL);
+    gtk_entry_completion_set_minimum_key_length(completion, 1);
+    g_signal_connect(entry, "changed", G_CALLBACK(on_entry_changed_complete), window);
+    g_signal_connect(completion, "match-selected", G_CALLBACK(on_completion_match_selected), NULL);
+    gtk_entry_set_completion(GTK_ENTRY(entry), completion);
+    g_object_unref(completion);
+
     add_button = gtk_button_new_with_label("Add");
     gtk_box_pack_start(GTK_BOX(hbox_entry), add_button, FALSE, FALSE, 0);
 
+    // Shown by duplicate_check_entry() when the entry's text looks familiar.
+    duplicate_label = gtk_label_new(NULL);
+    gtk_label_set_line_wrap(GTK_LABEL(duplicate_label), TRUE);
+    gtk_label_set_xalign(GTK_LABEL(duplicate_label), 0.0);
+    gtk_style_context_add_class(gtk_widget_get_style_context(duplicate_label), "duplicate-hint");
+    gtk_widget_set_no_show_all(duplicate_label, TRUE);
+    gtk_box_pack_start(GTK_BOX(vbox), duplicate_label, FALSE, FALSE, 0);
+
     remove_button = gtk_button_new_with_label("Remove Selected");
     gtk_box_pack_start(GTK_BOX(vbox), remove_button, FALSE, FALSE, 0);
 
     // Store pointers to the widgets so we can access them in callbacks.
     g_object_set_data(G_OBJECT(window), "entry", entry);
-    g_object_set_data(G_OBJECT(window), "list_box", list_box);
+    g_object_set_data(G_OBJECT(window), "view", view);
+    g_object_set_data(G_OBJECT(window), "stack", stack);
+    g_object_set_data(G_OBJECT(window), "board", board);
+    g_object_set_data(G_OBJECT(window), "filter_entry", filter_entry);
+    g_object_set_data(G_OBJECT(window), "view_combo", view_combo);
+    g_object_set_data(G_OBJECT(window), "completion_index", g_object_get_data(G_OBJECT(app), "completion_index"));
+    g_object_set_data_full(G_OBJECT(window), "completion_model", completion_model, g_object_unref);
+    g_object_set_data(G_OBJECT(window), "duplicate_index", g_object_get_data(G_OBJECT(app), "duplicate_index"));
+    g_object_set_data(G_OBJECT(window), "duplicate_label", duplicate_label);
+    refresh_view_combo(window);
+    g_object_set_data(G_OBJECT(window), "store", store);
 
     // Connect the signals to our callback functions.
     g_signal_connect(add_button, "clicked", G_CALLBACK(on_add_button_clicked), window);
     g_signal_connect(entry, "activate", G_CALLBACK(on_add_button_clicked), window);
+    g_signal_connect(entry, "paste-clipboard", G_CALLBACK(on_entry_paste_clipboard), window);
+    g_signal_connect(entry, "key-press-event", G_CALLBACK(on_entry_key_press), window);
+    g_signal_connect(entry, "changed", G_CALLBACK(on_entry_changed_duplicate), window);
+    g_signal_connect(filter_entry, "search-changed", G_CALLBACK(on_filter_changed), window);
+    g_signal_connect(filter_entry, "stop-search", G_CALLBACK(on_filter_stop), window);
+    g_signal_connect(group_combo, "changed", G_CALLBACK(on_group_by_changed), window);
+    g_signal_connect(view_combo, "changed", G_CALLBACK(on_view_combo_changed), window);
+    g_signal_connect(view->layout, "drag-data-received", G_CALLBACK(on_list_drag_data_received), window);
     g_signal_connect(remove_button, "clicked", G_CALLBACK(on_remove_button_clicked), window);
-    g_signal_connect(window, "destroy", G_CALLBACK(on_window_destroy), list_box);
-
-    // --- Load existing tasks from file ---
-    load_tasks_from_file(list_box);
+    g_signal_connect(window, "destroy", G_CALLBACK(on_window_destroy), store);
 
     gtk_widget_show_all(window);
 }
@@ -365,14 +12372,26 @@ static void activate(GtkApplication *app, gpointer data) {
  */
 int main(int argc, char **argv) {
     GtkApplication *app;
+    TaskStore *store;
+    gchar *app_id;
     int status;
 
-    app = gtk_application_new("org.gtk.todo_list", G_APPLICATION_DEFAULT_FLAGS);
-    g_signal_connect(app, "activate", G_CALLBACK(activate), NULL);
+    store = task_store_new();
+    app_id = store_application_id();
+    app = gtk_application_new(app_id, G_APPLICATION_DEFAULT_FLAGS);
+    g_free(app_id);
+    g_application_add_main_option(G_APPLICATION(app), "benchmark", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE,
+                                  "Time loading, editing and saving the tasks, then exit", NULL);
+    g_signal_connect(app, "handle-local-options", G_CALLBACK(on_handle_local_options), store);
+    g_signal_connect(app, "startup", G_CALLBACK(startup), store);
+    g_signal_connect(app, "activate", G_CALLBACK(activate), store);
     status = g_application_run(G_APPLICATION(app), argc, argv);
     g_object_unref(app);
 
+    // Only the primary instance opens the store.
+    if (store->backend) {
+        store->backend->close(store);
+    }
+
     return status;
 }
-
-